@@ -7,45 +7,58 @@
 //******************************************************************************
 
 #include <algorithms/arithmetic.hpp>
+#include <array>
+#include <async.hpp>
+#include <batch.hpp>
+#include <bigfloat.hpp>
 #include <benchmark/benchmark.h>
 #include <bigint.hpp>
+#include <combinatorics.hpp>
+#include <fixed_integer.hpp>
 #include <functional>
 #include <gmpxx.h>
 #include <iostream>
+#include <multimod.hpp>
+#include <prime.hpp>
 #include <random>
+#include <random.hpp>
+#include <rational.hpp>
+#include <roots.hpp>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__)
+    #include <x86intrin.h>
+#endif
+
+// different numbers in every run
+static xenonis::xoshiro256x4 ran_engine(std::random_device{}());
 
 template <typename T> auto gen_ran_nums(std::size_t size)
 {
-    std::random_device ran_device;
-    std::default_random_engine ran_engine(ran_device());
-    std::uniform_int_distribution<T> ran_dist(0, std::numeric_limits<T>::max());
     std::vector<T> ret(size);
-
     for (auto& e : ret)
-        e = ran_dist(ran_engine);
+        e = static_cast<T>(ran_engine());
 
     return ret;
 }
 
-auto gen_ran_hex_str(std::size_t size)
+// a uniformly distributed number in [0, 2^bits), the limbs are filled directly instead of parsing a string. The
+// multi-threaded benchmarks pass an engine per thread, ran_engine must not be shared between threads.
+template <class Bigint = xenonis::bigint64>
+auto gen_ran_bigint(std::size_t bits, xenonis::xoshiro256x4& engine = ran_engine)
 {
-    std::string ret(size, '\0');
-
-    std::random_device ran_device;
-    std::default_random_engine ran_engine(ran_device());
-    std::uniform_int_distribution<char> ran_dist(0, 15);
-
-    auto conv = [](char c) -> char {
-        if (c < 10)
-            return c + 48;
-        else
-            return c + 87;
-    };
-
-    for (auto& c : ret)
-        c = conv(ran_dist(ran_engine));
+    return xenonis::random_bits<Bigint>(bits, engine);
+}
 
+// the same number for GMP, the limbs are copied
+static mpz_class to_mpz(const xenonis::bigint64& n)
+{
+    mpz_class ret;
+    mpz_import(ret.get_mpz_t(), n.data().size(), -1, sizeof(std::uint64_t), 0, 0, n.data().data());
+    if (n.is_negative())
+        ret = -ret;
     return ret;
 }
 
@@ -96,11 +109,11 @@ static void fibonacci_offset_args(benchmark::internal::Benchmark* bench)
     return;
 }
 
-static void p2_gen(std::function<void(int, std::size_t)> f)
+static void p2_gen(std::function<void(int, std::size_t)> f, int max = (8 << 18))
 {
     std::set<int> values;
     int n{16};
-    while (n < (8 << 18)) {
+    while (n < max) {
         n *= 2;
         values.insert(n - n / 4);
         values.insert(n);
@@ -118,18 +131,32 @@ static void p2_args(benchmark::internal::Benchmark* bench)
     return;
 }
 
-std::vector<std::pair<std::string, std::string>> add_data;
-std::vector<std::pair<std::string, std::string>> mul_data;
+// the square root uses the quadratic schoolbook division, so only smaller sizes are benchmarked
+static void p2_small_args(benchmark::internal::Benchmark* bench)
+{
+    p2_gen([&bench](int n, std::size_t i) { bench->Args({n, static_cast<long>(i)}); }, 8 << 13);
+    return;
+}
+
+// short sizes (which hit the jump table of the add / sub kernels) and powers of two
+static void kernel_args(benchmark::internal::Benchmark* bench)
+{
+    for (int n : {1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 64, 256, 1024, 4096})
+        bench->Arg(n);
+}
+
+std::vector<std::pair<xenonis::bigint64, xenonis::bigint64>> add_data;
+std::vector<std::pair<xenonis::bigint64, xenonis::bigint64>> mul_data;
 
 void init()
 {
     fibonacci_offset_gen([](int n, std::size_t) {
-        add_data.push_back(
-            std::make_pair(gen_ran_hex_str(static_cast<std::size_t>(n)), gen_ran_hex_str(static_cast<std::size_t>(n))));
+        add_data.emplace_back(gen_ran_bigint(static_cast<std::size_t>(n) * 4),
+                              gen_ran_bigint(static_cast<std::size_t>(n) * 4));
     });
     p2_gen([](int n, std::size_t) {
-        mul_data.push_back(
-            std::make_pair(gen_ran_hex_str(static_cast<std::size_t>(n)), gen_ran_hex_str(static_cast<std::size_t>(n))));
+        mul_data.emplace_back(gen_ran_bigint(static_cast<std::size_t>(n) * 4),
+                              gen_ran_bigint(static_cast<std::size_t>(n) * 4));
     });
 }
 
@@ -161,8 +188,8 @@ static void BM_add_gmp(benchmark::State& state)
 {
     state.SetComplexityN(state.range(0));
 
-    mpz_class mp_a(add_data.operator[](static_cast<std::size_t>(state.range(1))).first, 16);
-    mpz_class mp_b(add_data.operator[](static_cast<std::size_t>(state.range(1))).second, 16);
+    const auto mp_a{to_mpz(add_data.operator[](static_cast<std::size_t>(state.range(1))).first)};
+    const auto mp_b{to_mpz(add_data.operator[](static_cast<std::size_t>(state.range(1))).second)};
 
     mpz_t c;
     mpz_init(c);
@@ -183,6 +210,204 @@ static void BM_add_gmp(benchmark::State& state)
 }
 BENCHMARK(BM_add_gmp)->Apply(fibonacci_offset_args)->Complexity(benchmark::oN);
 
+// runs op(a, b, c) on state.range(0) limbs, cycles_per_limb is measured using the time stamp counter (if available)
+template <typename Value, class Op> static void kernel_bench(benchmark::State& state, Op op)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_ran_nums<Value>(size)};
+    const auto b{gen_ran_nums<Value>(size)};
+    std::vector<Value> c(size);
+
+#if defined(__x86_64__)
+    const auto start{__rdtsc()};
+#endif
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(op(a.data(), b.data(), b.data() + size, c.data()));
+        benchmark::ClobberMemory();
+    }
+#if defined(__x86_64__)
+    const auto cycles{static_cast<double>(__rdtsc() - start)};
+    state.counters["cycles_per_limb"] = cycles / static_cast<double>(state.iterations() * size);
+#endif
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size));
+}
+
+template <typename Value> static void BM_kernel_add(benchmark::State& state)
+{
+    kernel_bench<Value>(state, [](auto a, auto b_first, auto b_last, auto c) {
+        return xenonis::algorithms::add(a, b_first, b_last, c);
+    });
+}
+BENCHMARK_TEMPLATE(BM_kernel_add, std::uint64_t)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_kernel_add, std::uint32_t)->Apply(kernel_args);
+
+template <typename Value> static void BM_kernel_sub(benchmark::State& state)
+{
+    kernel_bench<Value>(state, [](auto a, auto b_first, auto b_last, auto c) {
+        return xenonis::algorithms::sub(a, b_first, b_last, c);
+    });
+}
+BENCHMARK_TEMPLATE(BM_kernel_sub, std::uint64_t)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_kernel_sub, std::uint32_t)->Apply(kernel_args);
+
+template <typename Value> static void BM_kernel_sub_from(benchmark::State& state)
+{
+    kernel_bench<Value>(state, [](auto, auto b_first, auto b_last, auto c) {
+        return xenonis::algorithms::sub_from(c, b_first, b_last);
+    });
+}
+BENCHMARK_TEMPLATE(BM_kernel_sub_from, std::uint64_t)->Apply(kernel_args);
+BENCHMARK_TEMPLATE(BM_kernel_sub_from, std::uint32_t)->Apply(kernel_args);
+
+// the operands only differ in the lowest limb, the whole number is scanned
+static void BM_compare(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64)};
+    const auto b{a + 1};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a.compare(b));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * a.data().size() * 2 * 8));
+}
+BENCHMARK(BM_compare)->RangeMultiplier(4)->Range(4, 1 << 14);
+
+static void BM_compare_gmp(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64)};
+    const auto mp_a{to_mpz(a)};
+    const auto mp_b{to_mpz(a + 1)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(cmp(mp_a, mp_b));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * a.data().size() * 2 * 8));
+}
+BENCHMARK(BM_compare_gmp)->RangeMultiplier(4)->Range(4, 1 << 14);
+
+static void BM_hash(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::hash<xenonis::bigint64>{}(a));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * a.data().size() * 8));
+}
+BENCHMARK(BM_hash)->RangeMultiplier(4)->Range(1, 1 << 14);
+
+// the workaround without std::hash<bigint>: the hex string is hashed
+static void BM_hash_string(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64)};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::hash<std::string>{}(a.to_string()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * a.data().size() * 8));
+}
+BENCHMARK(BM_hash_string)->RangeMultiplier(4)->Range(1, 1 << 14);
+
+// std::allocator which counts the allocations
+template <typename T> struct counting_allocator : std::allocator<T> {
+    static inline std::size_t allocations{0};
+
+    counting_allocator() = default;
+    template <typename U> counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        ++allocations;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+using counting_bigint64 =
+    xenonis::internal::bigint<std::uint64_t,
+                              xenonis::internal::bigint_data<std::uint64_t, counting_allocator<std::uint64_t>>>;
+
+// op(acc, x) with operands of state.range(0) limbs, allocations is the number of allocations per iteration
+template <class Op> static void accumulate_bench(benchmark::State& state, bool negative, Op op)
+{
+    const auto x{gen_ran_bigint<counting_bigint64>(static_cast<std::size_t>(state.range(0)) * 64)};
+    counting_bigint64 acc(negative ? -x : x);
+
+    counting_allocator<std::uint64_t>::allocations = 0;
+    for (auto _ : state) {
+        op(acc, x);
+        benchmark::DoNotOptimize(acc);
+    }
+    const auto allocations{static_cast<double>(counting_allocator<std::uint64_t>::allocations)};
+    state.counters["allocations"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_add_assign(benchmark::State& state)
+{
+    accumulate_bench(state, false, [](auto& acc, const auto& x) { acc += x; });
+}
+BENCHMARK(BM_add_assign)->RangeMultiplier(4)->Range(1, 1 << 12);
+
+static void BM_sub_assign(benchmark::State& state)
+{
+    accumulate_bench(state, true, [](auto& acc, const auto& x) { acc -= x; });
+}
+BENCHMARK(BM_sub_assign)->RangeMultiplier(4)->Range(1, 1 << 12);
+
+// acc and x have the same number of limbs in every step
+static void BM_add_sub_assign(benchmark::State& state)
+{
+    accumulate_bench(state, false, [](auto& acc, const auto& x) {
+        acc += x;
+        acc -= x;
+    });
+}
+BENCHMARK(BM_add_sub_assign)->RangeMultiplier(4)->Range(1, 1 << 12);
+
+static void BM_add_assign_gmp(benchmark::State& state)
+{
+    const auto x{to_mpz(gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64))};
+    mpz_class acc(x);
+
+    for (auto _ : state) {
+        acc += x;
+        benchmark::DoNotOptimize(acc);
+    }
+}
+BENCHMARK(BM_add_assign_gmp)->RangeMultiplier(4)->Range(1, 1 << 12);
+
+// acc += a * b with a and b of state.range(0) limbs, like in a dot product
+template <class Op> static void addmul_bench(benchmark::State& state, Op op)
+{
+    const auto n{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_ran_bigint<counting_bigint64>(n * 64)}, b{gen_ran_bigint<counting_bigint64>(n * 64)};
+    auto acc{gen_ran_bigint<counting_bigint64>(n * 128 + 64)};
+
+    counting_allocator<std::uint64_t>::allocations = 0;
+    for (auto _ : state) {
+        op(acc, a, b);
+        benchmark::DoNotOptimize(acc);
+    }
+    const auto allocations{static_cast<double>(counting_allocator<std::uint64_t>::allocations)};
+    state.counters["allocations"] = benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_addmul(benchmark::State& state)
+{
+    addmul_bench(state, [](auto& acc, const auto& a, const auto& b) { acc.addmul(a, b); });
+}
+BENCHMARK(BM_addmul)->RangeMultiplier(4)->Range(1, 1 << 10);
+
+static void BM_addmul_operator(benchmark::State& state)
+{
+    addmul_bench(state, [](auto& acc, const auto& a, const auto& b) { acc += a * b; });
+}
+BENCHMARK(BM_addmul_operator)->RangeMultiplier(4)->Range(1, 1 << 10);
+
+static void BM_addmul_gmp(benchmark::State& state)
+{
+    const auto n{static_cast<std::size_t>(state.range(0))};
+    const auto a{to_mpz(gen_ran_bigint(n * 64))}, b{to_mpz(gen_ran_bigint(n * 64))};
+    auto acc{to_mpz(gen_ran_bigint(n * 128 + 64))};
+
+    for (auto _ : state) {
+        mpz_addmul(acc.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        benchmark::DoNotOptimize(acc);
+    }
+}
+BENCHMARK(BM_addmul_gmp)->RangeMultiplier(4)->Range(1, 1 << 10);
+
 static void BM_mul(benchmark::State& state)
 {
     state.SetComplexityN(state.range(0));
@@ -253,12 +478,69 @@ static void BM_mul_naive(benchmark::State& state)
 }
 BENCHMARK(BM_mul_naive)->Apply(p2_args)->Complexity();
 
+// the token is checked on every level of the recursion, compare with BM_mul_karatsuba
+static void BM_mul_cancellable(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    const auto& a{mul_data.operator[](static_cast<std::size_t>(state.range(1))).first};
+    const auto& b{mul_data.operator[](static_cast<std::size_t>(state.range(1))).second};
+    const xenonis::cancellation_token token;
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(xenonis::cancellable_mul(a, b, token));
+
+    state.counters["in"] = state.range(0);
+}
+BENCHMARK(BM_mul_cancellable)->Apply(p2_args)->Complexity();
+
+// the low and the high half of the product, compare with BM_mul_karatsuba
+static void BM_mullo(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    xenonis::bigint64 b_a(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first);
+    xenonis::bigint64 b_b(mul_data.operator[](static_cast<std::size_t>(state.range(1))).second);
+
+    auto a{b_a.data()};
+    auto b{b_b.data()};
+    decltype(a) c;
+
+    for (auto _ : state) {
+        c = xenonis::algorithms::mullo<decltype(a)>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), a.size());
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["in"] = state.range(0);
+}
+BENCHMARK(BM_mullo)->Apply(p2_args)->Complexity();
+
+static void BM_mulhi(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    xenonis::bigint64 b_a(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first);
+    xenonis::bigint64 b_b(mul_data.operator[](static_cast<std::size_t>(state.range(1))).second);
+
+    auto a{b_a.data()};
+    auto b{b_b.data()};
+    decltype(a) c;
+
+    for (auto _ : state) {
+        c = xenonis::algorithms::mulhi<decltype(a)>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), a.size());
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["in"] = state.range(0);
+}
+BENCHMARK(BM_mulhi)->Apply(p2_args)->Complexity();
+
 static void BM_mul_gmp(benchmark::State& state)
 {
     state.SetComplexityN(state.range(0));
 
-    mpz_class mp_a(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first, 16);
-    mpz_class mp_b(mul_data.operator[](static_cast<std::size_t>(state.range(1))).second, 16);
+    const auto mp_a{to_mpz(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first)};
+    const auto mp_b{to_mpz(mul_data.operator[](static_cast<std::size_t>(state.range(1))).second)};
 
     mpz_t c;
     mpz_init(c);
@@ -278,6 +560,858 @@ static void BM_mul_gmp(benchmark::State& state)
 }
 BENCHMARK(BM_mul_gmp)->Apply(p2_args)->Complexity();
 
+// a *= a uses the squaring kernel, compare with BM_mul
+static void BM_sqr(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    const xenonis::bigint64 b_a(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first);
+    xenonis::bigint64 b_c;
+
+    for (auto _ : state) {
+        b_c = b_a;
+        b_c *= b_c;
+        benchmark::DoNotOptimize(b_c);
+    }
+
+    state.counters["in"] = state.range(0);
+}
+BENCHMARK(BM_sqr)->Apply(p2_args)->Complexity();
+
+static void BM_sqr_gmp(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    const auto mp_a{to_mpz(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first)};
+    mpz_class mp_c;
+
+    for (auto _ : state) {
+        mpz_mul(mp_c.get_mpz_t(), mp_a.get_mpz_t(), mp_a.get_mpz_t());
+        benchmark::DoNotOptimize(mp_c);
+    }
+
+    state.counters["in"] = state.range(0);
+}
+BENCHMARK(BM_sqr_gmp)->Apply(p2_args)->Complexity();
+
+// 10^state.range(0)
+static void BM_pow(benchmark::State& state)
+{
+    const xenonis::bigint64 ten(10);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ten.pow(static_cast<std::uint64_t>(state.range(0))));
+
+    state.counters["exp"] = state.range(0);
+}
+BENCHMARK(BM_pow)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMicrosecond);
+
+// 10^state.range(0) by repeated multiplication
+static void BM_pow_loop(benchmark::State& state)
+{
+    const xenonis::bigint64 ten(10);
+
+    for (auto _ : state) {
+        xenonis::bigint64 r(1);
+        for (std::int64_t i{0}; i < state.range(0); ++i)
+            r *= ten;
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.counters["exp"] = state.range(0);
+}
+BENCHMARK(BM_pow_loop)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_pow_gmp(benchmark::State& state)
+{
+    mpz_class r;
+
+    for (auto _ : state) {
+        mpz_ui_pow_ui(r.get_mpz_t(), 10, static_cast<unsigned long>(state.range(0)));
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.counters["exp"] = state.range(0);
+}
+BENCHMARK(BM_pow_gmp)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMicrosecond);
+
+static void BM_sqrtrem(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    xenonis::bigint64 b_a(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first);
+
+    std::pair<xenonis::bigint64, xenonis::bigint64> b_c;
+
+    for (auto _ : state) {
+        b_c = xenonis::sqrtrem(b_a);
+        benchmark::DoNotOptimize(b_c);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["in_bytes"] = benchmark::Counter(b_a.size(), benchmark::Counter::kDefaults);
+    state.counters["res_bytes"] = benchmark::Counter(b_c.first.size(), benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_sqrtrem)->Apply(p2_small_args)->Complexity();
+
+static void BM_sqrtrem_gmp(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    const auto mp_a{to_mpz(mul_data.operator[](static_cast<std::size_t>(state.range(1))).first)};
+
+    mpz_t s;
+    mpz_t r;
+    mpz_init(s);
+    mpz_init(r);
+
+    for (auto _ : state) {
+        mpz_sqrtrem(s, r, mp_a.get_mpz_t());
+        benchmark::DoNotOptimize(s);
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["in_bytes"] = benchmark::Counter(mpz_size(mp_a.get_mpz_t()) * sizeof(mp_limb_t),
+                                                    benchmark::Counter::kDefaults);
+    state.counters["res_bytes"] = benchmark::Counter(mpz_size(s) * sizeof(mp_limb_t), benchmark::Counter::kDefaults);
+
+    mpz_clear(s);
+    mpz_clear(r);
+}
+BENCHMARK(BM_sqrtrem_gmp)->Apply(p2_small_args)->Complexity();
+
+static void BM_factorial(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    xenonis::bigint64 b_c;
+
+    for (auto _ : state) {
+        b_c = xenonis::factorial<xenonis::bigint64>(static_cast<std::uint64_t>(state.range(0)),
+                                                    static_cast<unsigned>(state.range(1)));
+        benchmark::DoNotOptimize(b_c);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["threads"] = state.range(1);
+    state.counters["res_bytes"] = benchmark::Counter(b_c.size(), benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_factorial)->RangeMultiplier(10)->Ranges({{10, 1000000}, {1, 1}})->Complexity();
+BENCHMARK(BM_factorial)->RangeMultiplier(10)->Ranges({{100000, 1000000}, {4, 4}})->UseRealTime();
+
+static void BM_factorial_gmp(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    mpz_t c;
+    mpz_init(c);
+
+    for (auto _ : state) {
+        mpz_fac_ui(c, static_cast<unsigned long>(state.range(0)));
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["res_bytes"] = benchmark::Counter(mpz_size(c) * sizeof(mp_limb_t), benchmark::Counter::kDefaults);
+
+    mpz_clear(c);
+}
+BENCHMARK(BM_factorial_gmp)->RangeMultiplier(10)->Range(10, 1000000)->Complexity();
+
+static void BM_binomial(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    xenonis::bigint64 b_c;
+
+    for (auto _ : state) {
+        b_c = xenonis::binomial<xenonis::bigint64>(static_cast<std::uint64_t>(state.range(0)),
+                                                   static_cast<std::uint64_t>(state.range(0) / 2));
+        benchmark::DoNotOptimize(b_c);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["res_bytes"] = benchmark::Counter(b_c.size(), benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_binomial)->RangeMultiplier(10)->Range(10, 1000000)->Complexity();
+
+static void BM_binomial_gmp(benchmark::State& state)
+{
+    state.SetComplexityN(state.range(0));
+
+    mpz_t c;
+    mpz_init(c);
+
+    for (auto _ : state) {
+        mpz_bin_uiui(c, static_cast<unsigned long>(state.range(0)), static_cast<unsigned long>(state.range(0) / 2));
+        benchmark::DoNotOptimize(c);
+    }
+
+    state.counters["in"] = state.range(0);
+    state.counters["res_bytes"] = benchmark::Counter(mpz_size(c) * sizeof(mp_limb_t), benchmark::Counter::kDefaults);
+
+    mpz_clear(c);
+}
+BENCHMARK(BM_binomial_gmp)->RangeMultiplier(10)->Range(10, 1000000)->Complexity();
+
+// random odd numbers of the given number of bits, the most significant bit is set, the same seed gives the same numbers
+static std::vector<xenonis::bigint64> gen_odd_bigints(std::size_t count, std::size_t bits, std::uint64_t seed)
+{
+    xenonis::xoshiro256x4 engine(seed);
+    const auto top{xenonis::bigint64(1) << (bits - 1)};
+
+    std::vector<xenonis::bigint64> ret;
+    for (std::size_t i{0}; i < count; ++i) {
+        auto n{xenonis::random_bits(bits, engine)};
+        n |= top;
+        n |= xenonis::bigint64(1);
+        ret.push_back(std::move(n));
+    }
+    return ret;
+}
+
+// a^(m - 1) mod m with an odd m of state.range(0) bits, like in a Fermat or Miller-Rabin test
+static void BM_powmod(benchmark::State& state)
+{
+    const auto nums{gen_odd_bigints(2, static_cast<std::size_t>(state.range(0)), 1)};
+    const auto& m{nums[0]};
+    const auto a{nums[1] % m};
+    const auto e{m - xenonis::bigint64(1)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a.powmod(e, m));
+
+    state.counters["bits"] = state.range(0);
+}
+BENCHMARK(BM_powmod)->RangeMultiplier(2)->Range(256, 4096)->Unit(benchmark::kMicrosecond);
+
+static void BM_powmod_gmp(benchmark::State& state)
+{
+    const auto nums{gen_odd_bigints(2, static_cast<std::size_t>(state.range(0)), 1)};
+    const auto m{to_mpz(nums[0])};
+    const mpz_class a{to_mpz(nums[1]) % m};
+    const mpz_class e{m - 1};
+    mpz_class r;
+
+    for (auto _ : state) {
+        mpz_powm(r.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), m.get_mpz_t());
+        benchmark::DoNotOptimize(r);
+    }
+
+    state.counters["bits"] = state.range(0);
+}
+BENCHMARK(BM_powmod_gmp)->RangeMultiplier(2)->Range(256, 4096)->Unit(benchmark::kMicrosecond);
+
+// generates a 2048-bit prime per iteration, the time per prime depends heavily on the distance to the next prime, so
+// every run uses the same starting points
+static void BM_next_prime_2048(benchmark::State& state)
+{
+    const auto nums{gen_odd_bigints(static_cast<std::size_t>(state.max_iterations), 2048, 2)};
+    std::size_t i{0};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(xenonis::next_prime(nums[i++]));
+}
+BENCHMARK(BM_next_prime_2048)->Iterations(16)->Unit(benchmark::kMillisecond);
+
+static void BM_next_prime_2048_gmp(benchmark::State& state)
+{
+    const auto nums{gen_odd_bigints(static_cast<std::size_t>(state.max_iterations), 2048, 2)};
+    std::size_t i{0};
+    mpz_class p;
+
+    for (auto _ : state) {
+        mpz_nextprime(p.get_mpz_t(), to_mpz(nums[i++]).get_mpz_t());
+        benchmark::DoNotOptimize(p);
+    }
+}
+BENCHMARK(BM_next_prime_2048_gmp)->Iterations(16)->Unit(benchmark::kMillisecond);
+
+// many independent numbers of 256 and 512 bits
+static void batch_args(benchmark::internal::Benchmark* bench)
+{
+    for (const long limbs : {4, 8})
+        bench->Args({limbs, 1 << 16});
+}
+
+static auto gen_ran_batch(std::size_t count, std::size_t limbs)
+{
+    xenonis::batch<std::uint64_t> ret(count, limbs);
+    const auto nums{gen_ran_nums<std::uint64_t>(count * limbs)};
+    for (std::size_t j{0}; j < count; ++j)
+        for (std::size_t i{0}; i < limbs; ++i)
+            ret.limb(j, i) = nums[j * limbs + i];
+    return ret;
+}
+
+template <class Op> static void batch_bench(benchmark::State& state, Op op)
+{
+    const auto limbs{static_cast<std::size_t>(state.range(0))};
+    const auto count{static_cast<std::size_t>(state.range(1))};
+    auto a{gen_ran_batch(count, limbs)};
+    const auto b{gen_ran_batch(count, limbs)};
+
+    for (auto _ : state) {
+        op(a, b);
+        benchmark::DoNotOptimize(a);
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["limbs"] = state.range(0);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+// the same numbers as bigints, to compare the batch against a loop over std::vector<bigint>
+template <class Op> static void vector_bench(benchmark::State& state, Op op)
+{
+    const auto limbs{static_cast<std::size_t>(state.range(0))};
+    const auto count{static_cast<std::size_t>(state.range(1))};
+    const auto b_a{gen_ran_batch(count, limbs)};
+    const auto b_b{gen_ran_batch(count, limbs)};
+    std::vector<xenonis::bigint64> a, b;
+    for (std::size_t j{0}; j < count; ++j) {
+        a.push_back(b_a.get(j));
+        b.push_back(b_b.get(j));
+    }
+
+    for (auto _ : state) {
+        for (std::size_t j{0}; j < count; ++j)
+            op(a[j], b[j]);
+        benchmark::DoNotOptimize(a);
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["limbs"] = state.range(0);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+}
+
+static void BM_batch_add(benchmark::State& state)
+{
+    batch_bench(state, [](auto& a, const auto& b) { a += b; });
+}
+BENCHMARK(BM_batch_add)->Apply(batch_args);
+
+static void BM_batch_add_vector(benchmark::State& state)
+{
+    vector_bench(state, [](auto& a, const auto& b) { a += b; });
+}
+BENCHMARK(BM_batch_add_vector)->Apply(batch_args);
+
+static void BM_batch_sub(benchmark::State& state)
+{
+    batch_bench(state, [](auto& a, const auto& b) { a -= b; });
+}
+BENCHMARK(BM_batch_sub)->Apply(batch_args);
+
+static void BM_batch_sub_vector(benchmark::State& state)
+{
+    vector_bench(state, [](auto& a, const auto& b) { a -= b; });
+}
+BENCHMARK(BM_batch_sub_vector)->Apply(batch_args);
+
+static void BM_batch_mul(benchmark::State& state)
+{
+    batch_bench(state, [](auto& a, const auto& b) { a *= b; });
+}
+BENCHMARK(BM_batch_mul)->Apply(batch_args);
+
+static void BM_batch_mul_vector(benchmark::State& state)
+{
+    // the bigint product is not truncated, so the operands are not modified to keep the sizes constant
+    xenonis::bigint64 c;
+    vector_bench(state, [&c](const auto& a, const auto& b) {
+        c = a * b;
+        benchmark::DoNotOptimize(c);
+    });
+}
+BENCHMARK(BM_batch_mul_vector)->Apply(batch_args);
+
+static void BM_batch_compare(benchmark::State& state)
+{
+    std::vector<int> c;
+    batch_bench(state, [&c](const auto& a, const auto& b) {
+        c = compare(a, b);
+        benchmark::DoNotOptimize(c);
+    });
+}
+BENCHMARK(BM_batch_compare)->Apply(batch_args);
+
+static void BM_batch_compare_vector(benchmark::State& state)
+{
+    bool c;
+    vector_bench(state, [&c](const auto& a, const auto& b) {
+        c = a < b;
+        benchmark::DoNotOptimize(c);
+    });
+}
+BENCHMARK(BM_batch_compare_vector)->Apply(batch_args);
+
+// residue-wise products over state.range(0) primes of 63 bits, the product of the moduli has about 63 * state.range(0)
+// bits
+static void BM_multimod_mul(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const xenonis::multimod_basis<xenonis::bigint64> basis(count);
+    xenonis::multimod<xenonis::bigint64> a(gen_ran_bigint(count * 31), basis);
+    const xenonis::multimod<xenonis::bigint64> b(gen_ran_bigint(count * 31), basis);
+
+    for (auto _ : state) {
+        a *= b;
+        benchmark::DoNotOptimize(a);
+    }
+    state.counters["moduli"] = state.range(0);
+}
+BENCHMARK(BM_multimod_mul)->RangeMultiplier(4)->Range(16, 1024);
+
+// the same product without the residues, the operands have half the size of the product of the moduli
+static void BM_multimod_mul_bigint(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_ran_bigint(count * 31)}, b{gen_ran_bigint(count * 31)};
+    xenonis::bigint64 c;
+
+    for (auto _ : state) {
+        c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["moduli"] = state.range(0);
+}
+BENCHMARK(BM_multimod_mul_bigint)->RangeMultiplier(4)->Range(16, 1024);
+
+// conversion of a number of the size of the product of the moduli using the remainder tree
+static void BM_multimod_from_bigint(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const xenonis::multimod_basis<xenonis::bigint64> basis(count);
+    const auto n{gen_ran_bigint(count * 63)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(xenonis::multimod<xenonis::bigint64>(n, basis));
+    state.counters["moduli"] = state.range(0);
+}
+BENCHMARK(BM_multimod_from_bigint)->RangeMultiplier(4)->Range(16, 1024);
+
+// reconstruction using the Chinese remainder theorem evaluated in the product tree
+static void BM_multimod_to_bigint(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const xenonis::multimod_basis<xenonis::bigint64> basis(count);
+    const xenonis::multimod<xenonis::bigint64> n(gen_ran_bigint(count * 63), basis);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(n.to_bigint());
+    state.counters["moduli"] = state.range(0);
+}
+BENCHMARK(BM_multimod_to_bigint)->RangeMultiplier(4)->Range(16, 1024);
+
+// two random numbers of state.range(0) bits
+static void BM_gcd(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)))};
+    const auto b{gen_ran_bigint(static_cast<std::size_t>(state.range(0)))};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(xenonis::gcd(a, b));
+    state.counters["bits"] = state.range(0);
+}
+BENCHMARK(BM_gcd)->RangeMultiplier(4)->Range(128, 32768)->Unit(benchmark::kMicrosecond);
+
+static void BM_gcd_gmp(benchmark::State& state)
+{
+    const auto a{to_mpz(gen_ran_bigint(static_cast<std::size_t>(state.range(0))))};
+    const auto b{to_mpz(gen_ran_bigint(static_cast<std::size_t>(state.range(0))))};
+    mpz_class g;
+
+    for (auto _ : state) {
+        mpz_gcd(g.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        benchmark::DoNotOptimize(g);
+    }
+    state.counters["bits"] = state.range(0);
+}
+BENCHMARK(BM_gcd_gmp)->RangeMultiplier(4)->Range(128, 32768)->Unit(benchmark::kMicrosecond);
+
+// 1 + 1/2 + ... + 1/state.range(0), the denominators share many factors
+template <class Rational> static void BM_rational_harmonic(benchmark::State& state)
+{
+    const auto n{static_cast<std::uint64_t>(state.range(0))};
+
+    for (auto _ : state) {
+        Rational sum;
+        for (std::uint64_t k{1}; k <= n; ++k)
+            sum += Rational(xenonis::bigint(1), xenonis::bigint(k));
+        benchmark::DoNotOptimize(sum.canonicalize());
+    }
+    state.counters["n"] = state.range(0);
+}
+BENCHMARK_TEMPLATE(BM_rational_harmonic, xenonis::rational)
+    ->RangeMultiplier(4)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_rational_harmonic, xenonis::lazy_rational)
+    ->RangeMultiplier(4)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_rational_harmonic_gmp(benchmark::State& state)
+{
+    const auto n{static_cast<unsigned long>(state.range(0))};
+
+    for (auto _ : state) {
+        mpq_class sum;
+        for (unsigned long k{1}; k <= n; ++k)
+            sum += mpq_class(1, k);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["n"] = state.range(0);
+}
+BENCHMARK(BM_rational_harmonic_gmp)->RangeMultiplier(4)->Range(64, 4096)->Unit(benchmark::kMicrosecond);
+
+// evaluates the continued fraction [1; 2, ..., 7, 1, 2, ...] with state.range(0) terms from the back, x = a + 1 / x,
+// all intermediate fractions are canonical, so the eager mode needs no gcd either
+template <class Rational> static void BM_rational_continued_fraction(benchmark::State& state)
+{
+    const auto n{static_cast<std::uint64_t>(state.range(0))};
+
+    for (auto _ : state) {
+        Rational x(xenonis::bigint(n % 7 + 1));
+        for (auto k{n}; k-- > 0;)
+            x = Rational(xenonis::bigint(k % 7 + 1)) + Rational(1) / x;
+        benchmark::DoNotOptimize(x.canonicalize());
+    }
+    state.counters["n"] = state.range(0);
+}
+BENCHMARK_TEMPLATE(BM_rational_continued_fraction, xenonis::rational)
+    ->RangeMultiplier(4)
+    ->Range(64, 16384)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_rational_continued_fraction, xenonis::lazy_rational)
+    ->RangeMultiplier(4)
+    ->Range(64, 16384)
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_rational_continued_fraction_gmp(benchmark::State& state)
+{
+    const auto n{static_cast<unsigned long>(state.range(0))};
+
+    for (auto _ : state) {
+        mpq_class x(n % 7 + 1);
+        for (auto k{n}; k-- > 0;)
+            x = mpq_class(k % 7 + 1) + 1 / x;
+        benchmark::DoNotOptimize(x);
+    }
+    state.counters["n"] = state.range(0);
+}
+BENCHMARK(BM_rational_continued_fraction_gmp)->RangeMultiplier(4)->Range(64, 16384)->Unit(benchmark::kMicrosecond);
+
+// a random number in [0.5, 1) with all bits of the precision set
+static xenonis::bigfloat ran_bigfloat(std::size_t precision)
+{
+    auto mantissa{gen_ran_bigint<xenonis::bigint>(precision - 1)};
+    mantissa |= (xenonis::bigint(1) << (precision - 1)) | xenonis::bigint(1);
+    return xenonis::bigfloat(mantissa, -static_cast<std::int64_t>(precision), precision);
+}
+
+static mpf_class to_mpf(const xenonis::bigfloat& x)
+{
+    mpf_class ret(to_mpz(x.mantissa()), x.precision());
+    if (x.exponent() >= 0)
+        mpf_mul_2exp(ret.get_mpf_t(), ret.get_mpf_t(), static_cast<mp_bitcnt_t>(x.exponent()));
+    else
+        mpf_div_2exp(ret.get_mpf_t(), ret.get_mpf_t(), static_cast<mp_bitcnt_t>(-x.exponent()));
+    return ret;
+}
+
+template <class Op> static void bigfloat_bench(benchmark::State& state, Op op)
+{
+    const auto precision{static_cast<std::size_t>(state.range(0))};
+    const auto a{ran_bigfloat(precision)};
+    const auto b{ran_bigfloat(precision)};
+
+    for (auto _ : state) {
+        auto c{op(a, b)};
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["bits"] = state.range(0);
+}
+
+template <class Op> static void bigfloat_bench_gmp(benchmark::State& state, Op op)
+{
+    const auto precision{static_cast<std::size_t>(state.range(0))};
+    const auto a{to_mpf(ran_bigfloat(precision))};
+    const auto b{to_mpf(ran_bigfloat(precision))};
+    mpf_class c(0, precision);
+
+    for (auto _ : state) {
+        op(c.get_mpf_t(), a.get_mpf_t(), b.get_mpf_t());
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters["bits"] = state.range(0);
+}
+
+static void BM_bigfloat_mul(benchmark::State& state)
+{
+    bigfloat_bench(state, [](const auto& a, const auto& b) { return a * b; });
+}
+BENCHMARK(BM_bigfloat_mul)->RangeMultiplier(4)->Range(256, 262144);
+
+// the full product of the mantissas, which the short product of BM_bigfloat_mul avoids
+static void BM_bigfloat_mul_full(benchmark::State& state)
+{
+    bigfloat_bench(state, [](const auto& a, const auto& b) { return a.mantissa() * b.mantissa(); });
+}
+BENCHMARK(BM_bigfloat_mul_full)->RangeMultiplier(4)->Range(256, 262144);
+
+static void BM_bigfloat_mul_gmp(benchmark::State& state) { bigfloat_bench_gmp(state, mpf_mul); }
+BENCHMARK(BM_bigfloat_mul_gmp)->RangeMultiplier(4)->Range(256, 262144);
+
+static void BM_bigfloat_div(benchmark::State& state)
+{
+    bigfloat_bench(state, [](const auto& a, const auto& b) { return a / b; });
+}
+BENCHMARK(BM_bigfloat_div)->RangeMultiplier(4)->Range(256, 65536);
+
+static void BM_bigfloat_div_gmp(benchmark::State& state) { bigfloat_bench_gmp(state, mpf_div); }
+BENCHMARK(BM_bigfloat_div_gmp)->RangeMultiplier(4)->Range(256, 65536);
+
+static void BM_bigfloat_sqrt(benchmark::State& state)
+{
+    bigfloat_bench(state, [](const auto& a, const auto&) { return sqrt(a); });
+}
+BENCHMARK(BM_bigfloat_sqrt)->RangeMultiplier(4)->Range(256, 65536);
+
+static void BM_bigfloat_sqrt_gmp(benchmark::State& state)
+{
+    bigfloat_bench_gmp(state, [](mpf_ptr c, mpf_srcptr a, mpf_srcptr) { mpf_sqrt(c, a); });
+}
+BENCHMARK(BM_bigfloat_sqrt_gmp)->RangeMultiplier(4)->Range(256, 65536);
+
+static void BM_bigfloat_to_string(benchmark::State& state)
+{
+    const auto a{ran_bigfloat(static_cast<std::size_t>(state.range(0)))};
+
+    for (auto _ : state) {
+        auto str{a.to_string()};
+        benchmark::DoNotOptimize(str);
+    }
+    state.counters["bits"] = state.range(0);
+}
+BENCHMARK(BM_bigfloat_to_string)->RangeMultiplier(4)->Range(256, 16384);
+
+template <std::size_t Bits> static void BM_fixed_add(benchmark::State& state)
+{
+    xenonis::fixed_uint<Bits> a(gen_ran_bigint(Bits)), b(gen_ran_bigint(Bits));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        a += b;
+    }
+    benchmark::DoNotOptimize(a);
+}
+BENCHMARK_TEMPLATE(BM_fixed_add, 128);
+BENCHMARK_TEMPLATE(BM_fixed_add, 256);
+BENCHMARK_TEMPLATE(BM_fixed_add, 512);
+BENCHMARK_TEMPLATE(BM_fixed_add, 1024);
+
+template <std::size_t Bits> static void BM_fixed_add_bigint(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(Bits)}, b{gen_ran_bigint(Bits)};
+    xenonis::bigint64 c;
+
+    for (auto _ : state) {
+        c = a + b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK_TEMPLATE(BM_fixed_add_bigint, 128);
+BENCHMARK_TEMPLATE(BM_fixed_add_bigint, 256);
+BENCHMARK_TEMPLATE(BM_fixed_add_bigint, 512);
+BENCHMARK_TEMPLATE(BM_fixed_add_bigint, 1024);
+
+template <std::size_t Bits> static void BM_fixed_mul(benchmark::State& state)
+{
+    xenonis::fixed_uint<Bits> a(gen_ran_bigint(Bits));
+    xenonis::fixed_uint<Bits> b(gen_ran_bigint(Bits));
+    xenonis::fixed_uint<Bits> c;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK_TEMPLATE(BM_fixed_mul, 128);
+BENCHMARK_TEMPLATE(BM_fixed_mul, 256);
+BENCHMARK_TEMPLATE(BM_fixed_mul, 512);
+BENCHMARK_TEMPLATE(BM_fixed_mul, 1024);
+
+// the bigint calculates the full product
+template <std::size_t Bits> static void BM_fixed_mul_bigint(benchmark::State& state)
+{
+    const auto a{gen_ran_bigint(Bits)}, b{gen_ran_bigint(Bits)};
+    xenonis::bigint64 c;
+
+    for (auto _ : state) {
+        c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK_TEMPLATE(BM_fixed_mul_bigint, 128);
+BENCHMARK_TEMPLATE(BM_fixed_mul_bigint, 256);
+BENCHMARK_TEMPLATE(BM_fixed_mul_bigint, 512);
+BENCHMARK_TEMPLATE(BM_fixed_mul_bigint, 1024);
+
+// creates state.range(0) numbers with state.range(1) limbs each, bytes_per_number is the size of the object and of its
+// limbs (without the overhead of the heap)
+static void BM_footprint(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const auto init{gen_ran_bigint(static_cast<std::size_t>(state.range(1)) * 64)};
+    std::size_t bytes{0};
+
+    for (auto _ : state) {
+        std::vector<xenonis::bigint64> nums(count, init);
+        bytes = 0;
+        for (const auto& e : nums)
+            bytes += sizeof(e) + e.data().capacity() * sizeof(std::uint64_t);
+        benchmark::DoNotOptimize(nums.data());
+    }
+    state.counters["sizeof"] = sizeof(xenonis::bigint64);
+    state.counters["bytes_per_number"] = static_cast<double>(bytes) / static_cast<double>(count);
+}
+BENCHMARK(BM_footprint)->Ranges({{1 << 20, 1 << 20}, {1, 4}})->Unit(benchmark::kMillisecond);
+
+static void BM_footprint_gmp(benchmark::State& state)
+{
+    const auto count{static_cast<std::size_t>(state.range(0))};
+    const auto init{to_mpz(gen_ran_bigint(static_cast<std::size_t>(state.range(1)) * 64))};
+    std::size_t bytes{0};
+
+    for (auto _ : state) {
+        std::vector<mpz_class> nums(count, init);
+        bytes = 0;
+        for (const auto& e : nums)
+            bytes += sizeof(e) + static_cast<std::size_t>(e.get_mpz_t()->_mp_alloc) * sizeof(mp_limb_t);
+        benchmark::DoNotOptimize(nums.data());
+    }
+    state.counters["sizeof"] = sizeof(mpz_class);
+    state.counters["bytes_per_number"] = static_cast<double>(bytes) / static_cast<double>(count);
+}
+BENCHMARK(BM_footprint_gmp)->Ranges({{1 << 20, 1 << 20}, {1, 4}})->Unit(benchmark::kMillisecond);
+
+// allocator which keeps the freed blocks in thread-local free lists (one per power of two), so that the threads do not
+// share the heap after the first allocations, the blocks are freed when the thread exits
+template <typename T> struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+    template <typename U> pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    struct free_lists : std::array<std::vector<T*>, 64> {
+        ~free_lists()
+        {
+            for (std::size_t i{0}; i < this->size(); ++i)
+                for (auto* p : (*this)[i])
+                    ::operator delete(p);
+        }
+    };
+
+    static free_lists& local()
+    {
+        thread_local free_lists lists;
+        return lists;
+    }
+
+    // the index of the smallest power of two >= n
+    static std::size_t size_class(std::size_t n)
+    {
+        std::size_t i{0};
+        while ((std::size_t{1} << i) < n)
+            ++i;
+        return i;
+    }
+
+    T* allocate(std::size_t n)
+    {
+        const auto i{size_class(n)};
+        auto& list{local()[i]};
+        if (list.empty())
+            return static_cast<T*>(::operator new(sizeof(T) << i));
+
+        auto* p{list.back()};
+        list.pop_back();
+        return p;
+    }
+
+    void deallocate(T* p, std::size_t n) { local()[size_class(n)].push_back(p); }
+
+    bool operator==(const pool_allocator&) const noexcept { return true; }
+    bool operator!=(const pool_allocator&) const noexcept { return false; }
+};
+
+using pool_bigint64 =
+    xenonis::internal::bigint<std::uint64_t,
+                              xenonis::internal::bigint_data<std::uint64_t, pool_allocator<std::uint64_t>>>;
+
+// 1, 2, 4, ... threads up to the number of cores, the operands have state.range(0) limbs
+static void thread_args(benchmark::internal::Benchmark* bench)
+{
+    const auto cores{static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+    bench->RangeMultiplier(16)->Range(4, 1 << 10)->UseRealTime();
+    for (int threads{1}; threads < cores; threads *= 2)
+        bench->Threads(threads);
+    bench->Threads(cores);
+}
+
+// every thread parses two numbers, multiplies and adds them and converts the result back to a string, like a service
+// which calculates with numbers it receives as text, items_per_second is the throughput of all threads
+template <class Bigint> static void mixed_threads_bench(benchmark::State& state)
+{
+    // the setup runs on every thread
+    xenonis::xoshiro256x4 engine(static_cast<std::uint64_t>(state.thread_index()));
+    const auto str_a{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64, engine).to_string()};
+    const auto str_b{gen_ran_bigint(static_cast<std::size_t>(state.range(0)) * 64, engine).to_string()};
+
+    for (auto _ : state) {
+        const Bigint a(str_a);
+        const Bigint b(str_b);
+        auto c{a * b};
+        c += a;
+        benchmark::DoNotOptimize(c.to_string());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_threads_mixed(benchmark::State& state) { mixed_threads_bench<xenonis::bigint64>(state); }
+BENCHMARK(BM_threads_mixed)->Apply(thread_args);
+
+static void BM_threads_mixed_pool(benchmark::State& state) { mixed_threads_bench<pool_bigint64>(state); }
+BENCHMARK(BM_threads_mixed_pool)->Apply(thread_args);
+
+// many short-lived temporaries: the copies and the results of + and - are allocated and freed in every iteration
+template <class Bigint> static void alloc_threads_bench(benchmark::State& state)
+{
+    // the setup runs on every thread
+    xenonis::xoshiro256x4 engine(static_cast<std::uint64_t>(state.thread_index()));
+    const auto a{gen_ran_bigint<Bigint>(static_cast<std::size_t>(state.range(0)) * 64, engine)};
+    const auto b{gen_ran_bigint<Bigint>(static_cast<std::size_t>(state.range(0)) * 64, engine)};
+
+    for (auto _ : state) {
+        Bigint c(a);
+        c = (c + b) - (a - b);
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_threads_alloc(benchmark::State& state) { alloc_threads_bench<xenonis::bigint64>(state); }
+BENCHMARK(BM_threads_alloc)->Apply(thread_args);
+
+static void BM_threads_alloc_pool(benchmark::State& state) { alloc_threads_bench<pool_bigint64>(state); }
+BENCHMARK(BM_threads_alloc_pool)->Apply(thread_args);
+
 int main(int argc, char** argv)
 {
     ::benchmark::Initialize(&argc, argv);
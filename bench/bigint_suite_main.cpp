@@ -0,0 +1,321 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file bigint_suite_main.cpp
+ *  Benchmarks every operation of bigint for all limb types over size sweeps and unbalanced operands. The operands are
+ *  generated from fixed seeds, so that the results of different commits are comparable, e.g. using
+ *  bigint_suite --benchmark_out=suite.json --benchmark_out_format=json (see the bigint_suite_json target).
+ */
+
+#include <benchmark/benchmark.h>
+#include <bigint.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <random.hpp>
+#include <string>
+#include <utility>
+
+template <typename Value> using bigint_t = xenonis::internal::bigint<Value, xenonis::internal::bigint_data<Value>>;
+
+// returns a positive hex string of exactly limbs limbs, the same seed gives the same string on every run
+template <typename Value> static std::string gen_hex_str(std::size_t limbs, std::uint64_t seed)
+{
+    std::mt19937_64 engine(seed);
+    std::uniform_int_distribution<int> dist(0, 15);
+    constexpr char digits[]{"0123456789abcdef"};
+
+    std::string ret(limbs * sizeof(Value) * 2, '\0');
+    for (auto& c : ret)
+        c = digits[dist(engine)];
+    ret.front() = digits[1 + dist(engine) % 15]; // the most significant limb is not zero
+
+    return ret;
+}
+
+// returns a positive number of exactly limbs limbs, the same seed gives the same number on every run
+template <typename Value> static bigint_t<Value> gen_bigint(std::size_t limbs, std::uint64_t seed)
+{
+    xenonis::xoshiro256x4 engine(seed);
+    const auto bits{limbs * std::numeric_limits<Value>::digits};
+
+    auto ret{xenonis::random_bits<bigint_t<Value>>(bits, engine)};
+    ret |= bigint_t<Value>(1) << (bits - 1); // the most significant limb is not zero
+    return ret;
+}
+
+// sets the counters which are common to all benchmarks of this suite, size is the number of limbs of the result
+template <typename Value> static void set_counters(benchmark::State& state, std::size_t size)
+{
+    state.SetComplexityN(static_cast<std::int64_t>(size));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * size * sizeof(Value)));
+    state.counters["bits"] = static_cast<double>(size * std::numeric_limits<Value>::digits);
+}
+
+// the linear operations: 1 to 2^22 limbs
+static void linear_args(benchmark::internal::Benchmark* bench)
+{
+    bench->RangeMultiplier(4)->Range(1, 1 << 22)->Complexity(benchmark::oN);
+}
+
+// the multiplication (O(n^log2(3))): 1 to 2^16 limbs
+static void mul_args(benchmark::internal::Benchmark* bench)
+{
+    bench->RangeMultiplier(4)->Range(1, 1 << 16)->Complexity();
+}
+
+// the schoolbook division (O(n^2)): 2n by n limbs, n from 1 to 2^13
+static void div_args(benchmark::internal::Benchmark* bench)
+{
+    bench->RangeMultiplier(4)->Range(1, 1 << 13)->Complexity(benchmark::oNSquared);
+}
+
+// unbalanced operands: the first operand has n limbs, the second n/512 to n/2 (at least 1) limbs
+static void unbalanced_args(benchmark::internal::Benchmark* bench)
+{
+    for (long n : {1 << 8, 1 << 12, 1 << 16})
+        for (long m : {1L, n / 512, n / 64, n / 8, n / 2})
+            if (m >= 1)
+                bench->Args({n, m});
+}
+
+// the construction from machine integers does not depend on a size
+static void no_args(benchmark::internal::Benchmark*) {}
+
+// registers the benchmark for all limb types
+#if defined(XENONIS_USE_UINT128)
+    #define XENONIS_SUITE(name, args)                                                                                  \
+        BENCHMARK_TEMPLATE(name, std::uint8_t)->Apply(args);                                                           \
+        BENCHMARK_TEMPLATE(name, std::uint16_t)->Apply(args);                                                          \
+        BENCHMARK_TEMPLATE(name, std::uint32_t)->Apply(args);                                                          \
+        BENCHMARK_TEMPLATE(name, std::uint64_t)->Apply(args)
+#else
+    #define XENONIS_SUITE(name, args)                                                                                  \
+        BENCHMARK_TEMPLATE(name, std::uint8_t)->Apply(args);                                                           \
+        BENCHMARK_TEMPLATE(name, std::uint16_t)->Apply(args);                                                          \
+        BENCHMARK_TEMPLATE(name, std::uint32_t)->Apply(args)
+#endif
+
+template <typename Value> static void BM_add(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+    const auto b{gen_bigint<Value>(size, 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a + b);
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_add, linear_args);
+
+template <typename Value> static void BM_sub(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+    const auto b{gen_bigint<Value>(size, 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a - b);
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_sub, linear_args);
+
+// the operands differ only in the least significant limb, all limbs are compared
+template <typename Value> static void BM_compare(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+    const auto b{a + 1};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a < b);
+        benchmark::DoNotOptimize(a == b);
+    }
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_compare, linear_args);
+
+template <typename Value> static void BM_to_string(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a.to_string());
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_to_string, linear_args);
+
+template <typename Value> static void BM_from_string(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto str{gen_hex_str<Value>(size, 1)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(bigint_t<Value>(str));
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_from_string, linear_args);
+
+template <typename Value> static void BM_copy(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+
+    for (auto _ : state) {
+        bigint_t<Value> b(a);
+        benchmark::DoNotOptimize(b);
+    }
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_copy, linear_args);
+
+// moves the number forth and back, should not depend on the size
+template <typename Value> static void BM_move(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    auto a{gen_bigint<Value>(size, 1)};
+
+    for (auto _ : state) {
+        bigint_t<Value> b(std::move(a));
+        benchmark::DoNotOptimize(b);
+        a = std::move(b);
+    }
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_move, linear_args);
+
+// the carry stops in the least significant limb in most cases
+template <typename Value> static void BM_increment(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    auto a{gen_bigint<Value>(size, 1)};
+
+    for (auto _ : state) {
+        ++a;
+        benchmark::DoNotOptimize(a);
+    }
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_increment, linear_args);
+
+// 2^n - 1: the carry and the borrow propagate through all limbs
+template <typename Value> static void BM_increment_carry(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    auto a{(bigint_t<Value>(1) << (size * std::numeric_limits<Value>::digits)) - 1};
+
+    for (auto _ : state) {
+        ++a;
+        --a;
+        benchmark::DoNotOptimize(a);
+    }
+
+    set_counters<Value>(state, size);
+}
+XENONIS_SUITE(BM_increment_carry, linear_args);
+
+template <typename Value, typename T> static void construct_bench(benchmark::State& state)
+{
+    std::mt19937_64 engine(1);
+    std::uniform_int_distribution<T> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    const auto n{dist(engine)};
+
+    for (auto _ : state) {
+        bigint_t<Value> a(n);
+        benchmark::DoNotOptimize(a);
+    }
+
+    set_counters<Value>(state, (sizeof(T) + sizeof(Value) - 1) / sizeof(Value));
+}
+
+template <typename Value> static void BM_construct_uint64(benchmark::State& state)
+{
+    construct_bench<Value, std::uint64_t>(state);
+}
+XENONIS_SUITE(BM_construct_uint64, no_args);
+
+template <typename Value> static void BM_construct_int64(benchmark::State& state)
+{
+    construct_bench<Value, std::int64_t>(state);
+}
+XENONIS_SUITE(BM_construct_int64, no_args);
+
+template <typename Value> static void BM_mul(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(size, 1)};
+    const auto b{gen_bigint<Value>(size, 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a * b);
+
+    set_counters<Value>(state, 2 * size);
+}
+XENONIS_SUITE(BM_mul, mul_args);
+
+template <typename Value> static void BM_div(benchmark::State& state)
+{
+    const auto size{static_cast<std::size_t>(state.range(0))};
+    const auto a{gen_bigint<Value>(2 * size, 1)};
+    const auto b{gen_bigint<Value>(size, 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a / b);
+
+    set_counters<Value>(state, 2 * size);
+}
+XENONIS_SUITE(BM_div, div_args);
+
+template <typename Value> static void BM_add_unbalanced(benchmark::State& state)
+{
+    const auto a{gen_bigint<Value>(static_cast<std::size_t>(state.range(0)), 1)};
+    const auto b{gen_bigint<Value>(static_cast<std::size_t>(state.range(1)), 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a + b);
+
+    set_counters<Value>(state, static_cast<std::size_t>(state.range(0)));
+}
+XENONIS_SUITE(BM_add_unbalanced, unbalanced_args);
+
+template <typename Value> static void BM_mul_unbalanced(benchmark::State& state)
+{
+    const auto a{gen_bigint<Value>(static_cast<std::size_t>(state.range(0)), 1)};
+    const auto b{gen_bigint<Value>(static_cast<std::size_t>(state.range(1)), 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a * b);
+
+    set_counters<Value>(state, static_cast<std::size_t>(state.range(0) + state.range(1)));
+}
+XENONIS_SUITE(BM_mul_unbalanced, unbalanced_args);
+
+template <typename Value> static void BM_div_unbalanced(benchmark::State& state)
+{
+    const auto a{gen_bigint<Value>(static_cast<std::size_t>(state.range(0)), 1)};
+    const auto b{gen_bigint<Value>(static_cast<std::size_t>(state.range(1)), 2)};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(a / b);
+
+    set_counters<Value>(state, static_cast<std::size_t>(state.range(0)));
+}
+XENONIS_SUITE(BM_div_unbalanced, unbalanced_args);
+
+BENCHMARK_MAIN();
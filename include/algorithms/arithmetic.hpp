@@ -13,6 +13,8 @@
 #pragma once
 
 #include "../integer_traits.hpp"
+#include "../stats.hpp"
+#include "bitwise.hpp"
 #include "compare.hpp"
 #include "util.hpp"
 //#include <tbb/task_group.h> // Intel Thread Building Blocks library for parallelization, may be used in the future
@@ -24,7 +26,9 @@
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <type_traits>
+#include <utility>
 
 namespace xenonis::algorithms {
     /*!
@@ -37,11 +41,7 @@ namespace xenonis::algorithms {
      *  \returns carry
      */
     template <class InIter, class OutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        inline bool
-        add(InIter a_first, InIter b_first, InIter b_last, OutIter c_first);
+    XENONIS_CONSTEXPR_ASM inline bool add(InIter a_first, InIter b_first, InIter b_last, OutIter c_first);
 
     /*!
      *  Subtracts b from a and writes the result to c. Requires a.size() >= b.size() and c.size() >= a.size(). c must
@@ -53,11 +53,7 @@ namespace xenonis::algorithms {
      *  \returns carry
      */
     template <class InIter, class OutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        inline bool
-        sub(InIter a_first, InIter b_first, InIter b_last, OutIter c_first);
+    XENONIS_CONSTEXPR_ASM inline bool sub(InIter a_first, InIter b_first, InIter b_last, OutIter c_first);
 
     /*!
      *  Subtracts b from a and writes the result to a. Requires a.size() >= b.size().
@@ -67,11 +63,7 @@ namespace xenonis::algorithms {
      *  \returns carry
      */
     template <class InIter, class InOutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        inline bool
-        sub_from(InOutIter a_first, InIter b_first, InIter b_last);
+    XENONIS_CONSTEXPR_ASM inline bool sub_from(InOutIter a_first, InIter b_first, InIter b_last);
 
     /*!
      *  Increments a by 1.
@@ -95,6 +87,46 @@ namespace xenonis::algorithms {
      */
     template <typename Value> constexpr inline std::array<Value, 2> base_mul(Value a, Value b);
 
+    /*!
+     *  Adds a, b and the carry of a previous addition.
+     *  \details Branch free, so that loops over independent numbers can be vectorised by the compiler.
+     *  \param carry the incoming carry (0 or 1), is set to the outgoing carry
+     *  \returns the sum
+     */
+    template <typename Value> constexpr inline Value add_carry(Value a, Value b, Value& carry) noexcept;
+
+    /*!
+     *  Subtracts b and the borrow of a previous subtraction from a.
+     *  \details Branch free, so that loops over independent numbers can be vectorised by the compiler.
+     *  \param borrow the incoming borrow (0 or 1), is set to the outgoing borrow
+     *  \returns the difference
+     */
+    template <typename Value> constexpr inline Value sub_borrow(Value a, Value b, Value& borrow) noexcept;
+
+    /*!
+     *  Multiplies a with the limb b and adds the product to out, out has to have the size of a. It is possible that a
+     *  is out.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b the limb
+     *  \param out_first iterator pointing to the first element of out.
+     *  \returns the most significant limb of the result, which does not fit into out
+     */
+    template <class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM inline Value addmul_1(InIter a_first, InIter a_last, Value b, OutIter out_first);
+
+    /*!
+     *  Multiplies a with the limb b and subtracts the product from out, out has to have the size of a. It is possible
+     *  that a is out.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b the limb
+     *  \param out_first iterator pointing to the first element of out.
+     *  \returns the borrow, which has to be subtracted from the limb following out
+     */
+    template <class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM inline Value submul_1(InIter a_first, InIter a_last, Value b, OutIter out_first);
+
     /*!
      *  Multiplies a with b and returns the result.
      *  \details Uses the naive method to multiply. Complexity: O(n^2)
@@ -105,11 +137,7 @@ namespace xenonis::algorithms {
      *  \returns the result
      */
     template <class OutContainer, class InIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        OutContainer
-        naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last);
+    XENONIS_CONSTEXPR_ASM OutContainer naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last);
 
     /*!
      *  Multiplies a with b and writes the result to out.
@@ -123,11 +151,37 @@ namespace xenonis::algorithms {
      *  \param the size of a
      */
     template <class OutIter, class InIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        void
-        naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last, OutIter out_first);
+    XENONIS_CONSTEXPR_ASM void naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                         OutIter out_first);
+
+    /*!
+     *  Calculates the n most significant limbs of the product of a and b, up to a small error.
+     *  \details Only the partial products a[i] * b[j] with i + j >= a_size + b_size - n - 1 are calculated, the
+     *  omitted ones sum to less than min(a_size, b_size) units of the least significant limb of the result. For
+     *  n == a_size == b_size these are about half of the partial products of naive_mul. Complexity: O(n^2)
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \param n the number of limbs of the result, at most a_size + b_size
+     *  \returns h with 0 <= floor(a * b / base^(a_size + b_size - n)) - h <= min(a_size, b_size)
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer naive_mulhi(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                                   std::size_t n);
+
+    /*!
+     *  The operands of karatsuba_mul with at most this number of limbs are multiplied using naive_mul. The value is
+     *  measured by bigint_tune on the host (see XENONIS_KARATSUBA_THRESHOLD in bigint_config.hpp).
+     */
+    constexpr std::size_t karatsuba_threshold{XENONIS_KARATSUBA_THRESHOLD};
+
+    namespace internal {
+        // the default poll of karatsuba_mul
+        struct no_poll {
+            constexpr void operator()(std::size_t) const noexcept {}
+        };
+    } // namespace internal
 
     /*!
      *  Multiplies a with b and returns the result.
@@ -139,241 +193,297 @@ namespace xenonis::algorithms {
      *  \param b_last iterator pointing to the last element of b.
      *  \returns the result
      */
-    template <class OutContainer, class InIter, std::size_t threshold = 1024>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        OutContainer
-        karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last);
+    template <class OutContainer, class InIter, std::size_t threshold = karatsuba_threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last);
+
+    /*!
+     *  Multiplies a with b like karatsuba_mul above and calls poll on every level of the recursion.
+     *  \param poll called with the size of the larger operand on every level of the recursion above the threshold,
+     *  it may throw to abort the multiplication (see cancellable_mul in async.hpp)
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter, std::size_t threshold, class Poll>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                                     Poll poll);
 
-    template <typename Value, class InContainer, class OutContainer = InContainer>
-    OutContainer div(const InContainer& a, const InContainer& b);
+    /*!
+     *  Calculates the n least significant limbs of the product of a and b, (a * b) mod base^n, and writes them to out.
+     *  \details Only the partial products a[i] * b[j] with i + j < n are calculated. Complexity: O(n^2)
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \param n the number of limbs of the result
+     *  \param out_first iterator pointing to the first element of out, which has n limbs and must not overlap a or b.
+     */
+    template <class OutIter, class InIter>
+    XENONIS_CONSTEXPR_ASM void naive_mullo(InIter a_first, InIter a_last, InIter b_first, InIter b_last, std::size_t n,
+                                           OutIter out_first);
 
-    template <class InIter, class OutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
+    /*!
+     *  Calculates (a * b) mod base^n and returns it.
+     *  \details Mulders' short product: the low k = 0.7 * n limbs of a and b are multiplied using karatsuba_mul, the
+     *  cross products of the high and the low limbs only contribute their n - k least significant limbs, which are
+     *  calculated recursively. This takes about 80% of the time of karatsuba_mul, below the threshold naive_mullo is
+     *  used.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \param n the number of limbs of the result
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter, std::size_t threshold = karatsuba_threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer mullo(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                             std::size_t n);
+
+    /*!
+     *  Calculates the n most significant limbs of the product of a and b, up to a small error.
+     *  \details Operands with more than n limbs are truncated to their n most significant limbs, which changes the
+     *  result by less than one. Operands of about n limbs above the threshold are extended to n limbs and multiplied
+     *  using Mulders' short product: the high k = 0.7 * n limbs are multiplied using karatsuba_mul and the n - k most
+     *  significant limbs of the cross products are calculated recursively. Other operands above the threshold are
+     *  multiplied using karatsuba_mul, the ones below using naive_mulhi.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \param n the number of limbs of the result
+     *  \returns h with 0 <= floor(a * b / base^(a_size + b_size - n)) - h <= 2 * n + 2
+     */
+    template <class OutContainer, class InIter, std::size_t threshold = karatsuba_threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer mulhi(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                             std::size_t n);
+
+    /*!
+     *  Squares a and writes the result to out, which has twice the size of a and must not overlap a.
+     *  \details Every product a[i] * a[j] with i != j is calculated once and doubled, so only about half of the limb
+     *  products of naive_mul are required. Complexity: O(n^2)
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param out_first iterator pointing to the first element of out.
+     */
+    template <class OutIter, class InIter>
+    XENONIS_CONSTEXPR_ASM void naive_sqr(InIter a_first, InIter a_last, OutIter out_first);
+
+    /*!
+     *  Squares a and returns the result.
+     *  \details Like karatsuba_mul, but the three products of the halves are squares: (h * base^k + l)^2 = h^2 *
+     *  base^2k + ((h + l)^2 - h^2 - l^2) * base^k + l^2. The recursion ends with naive_sqr.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter, std::size_t threshold = karatsuba_threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_sqr(InIter a_first, InIter a_last);
+
+    /*!
+     *  Calculates a^exp and returns the result. Requires a to be normalized and exp > 0.
+     *  \details Left-to-right binary exponentiation: the result is squared for every bit of exp and multiplied by a
+     *  for every set bit. The intermediate results alternate between two buffers which are allocated once for the size
+     *  of the result, so the steps below the Karatsuba threshold do not allocate.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer pow(InIter a_first, InIter a_last, std::uint64_t exp);
+
+    /*!
+     *  Divides a by b and returns the quotient and the remainder.
+     *  \details Uses the schoolbook division (Knuth, TAOCP Vol. 2, 4.3.1, Algorithm D). Complexity: O(n*m). Requires b
+     *  to be non-zero and b.back() != 0.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \returns the pair (quotient, remainder)
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR std::pair<OutContainer, OutContainer> divmod(InIter a_first, InIter a_last, InIter b_first,
+                                                                   InIter b_last);
+
+#if defined(XENONIS_INLINE_ASM_AMD64)
+    namespace internal {
+// one limb of the carry chain: c[disp] = a[disp] op b[disp] op carry
+#define XENONIS_CARRY_CHAIN_STEP(n, op, reg, disp)                                                                     \
+    "%=" #n ":\n\t"                                                                                                    \
+    "mov " disp "(%[a]), " reg "\n\t" op " " disp "(%[b]), " reg "\n\t"                                                \
+    "mov " reg ", " disp "(%[c])\n\t"
+
+// an 8 times unrolled carry chain, the first (partial) block is entered using the jump table at label 9, the loop
+// counter is decremented by dec, which does not change CF
+#define XENONIS_CARRY_CHAIN(op, reg, d1, d2, d3, d4, d5, d6, d7, block)                                               \
+    "sub %[offset], %[a]\n\t"                                                                                          \
+    "sub %[offset], %[b]\n\t"                                                                                          \
+    "sub %[offset], %[c]\n\t"                                                                                          \
+    "lea %=9f(%%rip), %%r8\n\t"                                                                                        \
+    "movslq (%%r8, %[entry], 4), %%r9\n\t"                                                                             \
+    "lea (%%r8, %%r9), %%r9\n\t"                                                                                       \
+    "clc\n\t"                                                                                                          \
+    "jmp *%%r9\n\t"                                                                                                    \
+    XENONIS_CARRY_CHAIN_STEP(0, op, reg, "0")                                                                          \
+    XENONIS_CARRY_CHAIN_STEP(1, op, reg, d1)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(2, op, reg, d2)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(3, op, reg, d3)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(4, op, reg, d4)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(5, op, reg, d5)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(6, op, reg, d6)                                                                           \
+    XENONIS_CARRY_CHAIN_STEP(7, op, reg, d7)                                                                           \
+    "lea " block "(%[a]), %[a]\n\t"                                                                                    \
+    "lea " block "(%[b]), %[b]\n\t"                                                                                    \
+    "lea " block "(%[c]), %[c]\n\t"                                                                                    \
+    "dec %[blocks]\n\t"                                                                                                \
+    "jnz %=0b\n\t"                                                                                                     \
+    "jmp %=8f\n\t"                                                                                                     \
+    ".p2align 2\n"                                                                                                     \
+    "%=9:\n\t"                                                                                                         \
+    ".long %=0b - %=9b, %=1b - %=9b, %=2b - %=9b, %=3b - %=9b\n\t"                                                     \
+    ".long %=4b - %=9b, %=5b - %=9b, %=6b - %=9b, %=7b - %=9b\n"                                                       \
+    "%=8:\n\t"                                                                                                         \
+    "adc $0, %[carry]\n\t"
+
+        /*!
+         *  Calculates c = a + b (Sub == false) or c = a - b (Sub == true) for 32-bit and 64-bit limbs using adc / sbb.
+         *  \details The loop is unrolled 8 times. The size % 8 limbs of the first block are handled by jumping into
+         *  the unrolled loop using a jump table, after moving the pointers back, so that the remaining blocks are
+         *  complete and there is no separate tail loop. c may be a or b.
+         *  \returns the carry or borrow
+         */
+        template <bool Sub, class InIter, class OutIter>
+        inline bool carry_chain(InIter a_first, InIter b_first, InIter b_last, OutIter c_first)
+        {
+            using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+            static_assert(sizeof(value_type) == 4 || sizeof(value_type) == 8);
+
+            const auto size{static_cast<std::uint64_t>(std::distance(b_first, b_last))};
+            if (size == 0)
+                return false;
+
+            const auto* a{&*a_first};
+            const auto* b{&*b_first};
+            auto* c{&*c_first};
+            const std::uint64_t entry{(0 - size) % 8};
+            const std::uint64_t offset{entry * sizeof(value_type)};
+            std::uint64_t blocks{(size + 7) / 8};
+            std::uint64_t carry{0};
+
+            // volatile: the result is written through the memory clobber, without it the statement is removed if the
+            // caller ignores the carry
+            if constexpr (sizeof(value_type) == 8 && Sub) {
+                asm volatile(XENONIS_CARRY_CHAIN("sbb", "%%r10", "8", "16", "24", "32", "40", "48", "56", "64")
+                    : [a] "+r"(a), [b] "+r"(b), [c] "+r"(c), [blocks] "+r"(blocks), [carry] "+r"(carry)
+                    : [entry] "r"(entry), [offset] "r"(offset)
+                    : "r8", "r9", "r10", "cc", "memory");
+            } else if constexpr (sizeof(value_type) == 8) {
+                asm volatile(XENONIS_CARRY_CHAIN("adc", "%%r10", "8", "16", "24", "32", "40", "48", "56", "64")
+                    : [a] "+r"(a), [b] "+r"(b), [c] "+r"(c), [blocks] "+r"(blocks), [carry] "+r"(carry)
+                    : [entry] "r"(entry), [offset] "r"(offset)
+                    : "r8", "r9", "r10", "cc", "memory");
+            } else if constexpr (Sub) {
+                asm volatile(XENONIS_CARRY_CHAIN("sbb", "%%r10d", "4", "8", "12", "16", "20", "24", "28", "32")
+                    : [a] "+r"(a), [b] "+r"(b), [c] "+r"(c), [blocks] "+r"(blocks), [carry] "+r"(carry)
+                    : [entry] "r"(entry), [offset] "r"(offset)
+                    : "r8", "r9", "r10", "cc", "memory");
+            } else {
+                asm volatile(XENONIS_CARRY_CHAIN("adc", "%%r10d", "4", "8", "12", "16", "20", "24", "28", "32")
+                    : [a] "+r"(a), [b] "+r"(b), [c] "+r"(c), [blocks] "+r"(blocks), [carry] "+r"(carry)
+                    : [entry] "r"(entry), [offset] "r"(offset)
+                    : "r8", "r9", "r10", "cc", "memory");
+            }
+            return carry;
+        }
+#undef XENONIS_CARRY_CHAIN
+#undef XENONIS_CARRY_CHAIN_STEP
+    } // namespace internal
 #endif
-        bool inline add(InIter a_first, InIter b_first, InIter b_last, OutIter c_first)
+
+    template <class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM inline bool add(InIter a_first, InIter b_first, InIter b_last, OutIter c_first)
     {
         using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        XENONIS_STATS_KERNEL(add, std::distance(b_first, b_last));
 #if defined(XENONIS_INLINE_ASM_AMD64)
-        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
-            std::uint64_t carry{0}, size{static_cast<std::uint64_t>(std::distance(b_first, b_last))};
-            // asm(R"(
-            // xor %%rsi, %%rsi
-            // movq %[max], %%rbx
-            // subq %[size], %%rbx
-            // addq $1, %%rbx
-            //%=1:
-            // movq (%[a], %%rsi, 8), %%rax
-            // adcq (%[b], %%rsi, 8), %%rax
-            // movq %%rax, (%[c], %%rsi, 8)
-            // inc %%rsi
-            // inc %%rbx
-            // jno %=1b
-            // adcq $0, %[carry]
-            //)"
-            //: [ c ] "+r"(c_first), [ carry ] "+r"(carry) // DO NOT USE = constraint when using pointer
-            //: [ a ] "r"(a_first), [ b ] "r"(b_first), [ size ] "r"(size),
-            //[ max ] "r"(std::numeric_limits<std::int64_t>::max())
-            //: "rax", "rbx", "rcx", "rsi", "memory");
-
-            // same in Intel syntax:
-            // asm (R"(
-            // xor rsi, rsi
-            // mov rbx, %[max]
-            // sub rbx, %[size]
-            // add rbx, 1
-            //%=1:
-            // mov rax, QWORD PTR [%[a]+rsi*8]
-            // adc rax, QWORD PTR [%[b]+rsi*8]
-            // mov QWORD PTR [%[c]+rsi*8], rax
-            // inc rsi
-            // inc rbx
-            // jno %=1b
-            // adc %[carry], 0
-            //)"
-            //: [ c ] "+r"(c_first), [carry] "+r" (carry) // DO NOT USE = constraint when using pointer
-            //: [ a ] "r" (a_first), [ b ] "r" (b_first), [ size ] "r" (size),  [ max ] "r"
-            //(std::numeric_limits<std::int64_t>::max()) : "rax", "rbx", "rcx", "rsi", "memory");*/
-            asm(R"(
-                xor %%r8, %%r8
-                movq $4, %%r9
-                movq %[size], %%rax # rax = size
-                cmp $4, %%rax
-                jge %=1f
-                xor %%rdx, %%rdx    # clear registers
-                movq %%rax, %%rdx
-                jmp %=3f
-            %=1:
-                xor %%rdx, %%rdx
-                div %%r9
-            %=2:
-                movq (%[a], %%r8, 8), %%r10
-                movq 8(%[a], %%r8, 8), %%r11
-                movq 16(%[a], %%r8, 8), %%r12
-                movq 24(%[a], %%r8, 8), %%r13
-                adcx (%[b], %%r8, 8), %%r10
-                adcx 8(%[b], %%r8, 8), %%r11
-                adcx 16(%[b], %%r8, 8), %%r12
-                adcx 24(%[b], %%r8, 8), %%r13
-                movq %%r10, (%[c], %%r8, 8)
-                movq %%r11, 8(%[c], %%r8, 8)
-                movq %%r12, 16(%[c], %%r8, 8)
-                movq %%r13, 24(%[c], %%r8, 8)
-                adox %%r9, %%r8
-                dec %%rax
-                jnz %=2b
-
-                inc %%rdx           # do not change the state of the CF
-                dec %%rdx
-                jz %=4f
-            %=3:
-                movq (%[a], %%r8, 8), %%r10
-                adcq (%[b], %%r8, 8), %%r10
-                movq %%r10, (%[c], %%r8, 8)
-                inc %%r8
-                dec %%rdx
-                jnz %=3b
-            %=4:
-                adcq $0, %[carry]
-            )"
-                : [c] "+r"(c_first), [carry] "+r"(carry) // DO NOT USE = constraint when using pointer
-                : [a] "r"(a_first), [b] "r"(b_first), [size] "rm"(size)
-                : "rax", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "memory");
-            return carry;
-        } else {
+        if constexpr (std::is_same_v<value_type, std::uint64_t> || std::is_same_v<value_type, std::uint32_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED())
+                return internal::carry_chain<false>(a_first, b_first, b_last, c_first);
+        }
 #elif defined(__clang__) // for different architectures than x86
+        // the builtins are not usable in constant expressions on all compiler versions
+        if (!XENONIS_IS_CONSTANT_EVALUATED()) {
 #if __has_builtin(__builtin_addcll)
-        if constexpr (std::is_same_v<value_type, unsigned long long>) {
-            unsigned long long carry_in{0}, carry_out{0};
-            for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
-                *c_first = __builtin_addcll(*a_first, *b_first, carry_in, &carry_out);
-                carry_in = carry_out;
+            if constexpr (std::is_same_v<value_type, unsigned long long>) {
+                unsigned long long carry_in{0}, carry_out{0};
+                for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
+                    *c_first = __builtin_addcll(*a_first, *b_first, carry_in, &carry_out);
+                    carry_in = carry_out;
+                }
+                return carry_in;
             }
-            return carry_in;
-        }
 #endif
 #if __has_builtin(__builtin_addcl)
-        if constexpr (std::is_same_v<value_type, unsigned long>) {
-            unsigned long carry_in{0}, carry_out{0};
-            for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
-                *c_first = __builtin_addcl(*a_first, *b_first, carry_in, &carry_out);
-                carry_in = carry_out;
+            if constexpr (std::is_same_v<value_type, unsigned long>) {
+                unsigned long carry_in{0}, carry_out{0};
+                for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
+                    *c_first = __builtin_addcl(*a_first, *b_first, carry_in, &carry_out);
+                    carry_in = carry_out;
+                }
+                return carry_in;
             }
-            return carry_in;
-        }
 #endif
 #if __has_builtin(__builtin_addc)
-        if constexpr (std::is_same_v<value_type, unsigned int>) {
-            unsigned int carry_in{0}, carry_out{0};
-            for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
-                *c_first = __builtin_addc(*a_first, *b_first, carry_in, &carry_out);
-                carry_in = carry_out;
+            if constexpr (std::is_same_v<value_type, unsigned int>) {
+                unsigned int carry_in{0}, carry_out{0};
+                for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
+                    *c_first = __builtin_addc(*a_first, *b_first, carry_in, &carry_out);
+                    carry_in = carry_out;
+                }
+                return carry_in;
             }
-            return carry_in;
-        }
-#endif
 #endif
-            // portable
-            bool carry{false};
-            for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
-                *c_first = *a_first + *b_first + carry;
-                carry = carry ? *c_first <= *b_first : *c_first < *b_first;
-            }
-            return carry;
-#if defined(XENONIS_INLINE_ASM_AMD64)
         }
 #endif
+        // portable
+        value_type carry{0};
+        for (; b_first != b_last; ++a_first, ++b_first, ++c_first)
+            *c_first = add_carry<value_type>(*a_first, *b_first, carry);
+        return carry;
     }
 
     template <class InIter, class OutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        inline bool
-        sub(InIter a_first, InIter b_first, InIter b_last, OutIter c_first)
+    XENONIS_CONSTEXPR_ASM inline bool sub(InIter a_first, InIter b_first, InIter b_last, OutIter c_first)
     {
-#if defined(XENONIS_INLINE_ASM_AMD64)
         using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
-
-        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
-            std::uint64_t carry{0};
-            auto size{static_cast<std::uint64_t>(std::distance(b_first, b_last))};
-            asm(R"(
-            xor %%rsi, %%rsi
-            movq %[max], %%rbx
-            subq %[size], %%rbx
-            addq $1, %%rbx
-            %=1:
-            movq (%[a], %%rsi, 8), %%rax
-            sbbq (%[b], %%rsi, 8), %%rax
-            movq %%rax, (%[c], %%rsi, 8)
-            inc %%rsi
-            inc %%rbx
-            jno %=1b
-            sbbq $0, %[carry]
-            )"
-                : [c] "+r"(c_first), [carry] "+r"(carry) // DO NOT USE = constraint when using pointer
-                : [a] "r"(a_first), [b] "r"(b_first), [size] "r"(size),
-                  [max] "r"(std::numeric_limits<std::int64_t>::max())
-                : "rax", "rbx", "rcx", "rsi", "memory");
-            return carry;
-        } else {
-#endif
-            bool carry{false};
-            for (; b_first != b_last; ++a_first, ++b_first, ++c_first) {
-                *c_first = *a_first - *b_first - carry;
-                carry = carry ? *c_first >= *a_first : *c_first > *a_first;
-            }
-            return carry;
+        XENONIS_STATS_KERNEL(sub, std::distance(b_first, b_last));
 #if defined(XENONIS_INLINE_ASM_AMD64)
+        if constexpr (std::is_same_v<value_type, std::uint64_t> || std::is_same_v<value_type, std::uint32_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED())
+                return internal::carry_chain<true>(a_first, b_first, b_last, c_first);
         }
 #endif
+        value_type borrow{0};
+        for (; b_first != b_last; ++a_first, ++b_first, ++c_first)
+            *c_first = sub_borrow<value_type>(*a_first, *b_first, borrow);
+        return borrow;
     }
 
     template <class InIter, class InOutIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        inline bool
-        sub_from(InOutIter a_first, InIter b_first, InIter b_last)
+    XENONIS_CONSTEXPR_ASM inline bool sub_from(InOutIter a_first, InIter b_first, InIter b_last)
     {
-#if defined(XENONIS_INLINE_ASM_AMD64)
         using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
-
-        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
-            std::uint64_t carry{0}, size{static_cast<std::uint64_t>(std::distance(b_first, b_last))};
-            asm(R"(
-            xor %%rsi, %%rsi
-            movq %[max], %%rbx
-            subq %[size], %%rbx
-            addq $1, %%rbx
-            %=1:
-            movq (%[a], %%rsi, 8), %%rax
-            sbbq (%[b], %%rsi, 8), %%rax
-            movq %%rax, (%[a], %%rsi, 8)
-            inc %%rsi
-            inc %%rbx
-            jno %=1b
-            sbbq $0, %[carry]
-            )"
-                : [a] "+r"(a_first), [carry] "+r"(carry) // DO NOT USE = constraint when using pointer
-                : [b] "r"(b_first), [size] "r"(size), [max] "r"(std::numeric_limits<std::int64_t>::max())
-                : "rax", "rbx", "rcx", "rsi", "memory");
-            return carry;
-        } else {
-#endif
-            bool carry{false};
-            for (; b_first != b_last; ++a_first, ++b_first) {
-                auto tmp = *a_first;
-                *a_first -= *b_first + carry;
-                carry = carry ? *a_first >= tmp : *a_first > tmp;
-            }
-            return carry;
+        XENONIS_STATS_KERNEL(sub_from, std::distance(b_first, b_last));
 #if defined(XENONIS_INLINE_ASM_AMD64)
+        if constexpr (std::is_same_v<value_type, std::uint64_t> || std::is_same_v<value_type, std::uint32_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED()) {
+                const InIter a{a_first};
+                return internal::carry_chain<true>(a, b_first, b_last, a_first);
+            }
         }
 #endif
+        value_type borrow{0};
+        for (; b_first != b_last; ++a_first, ++b_first)
+            *a_first = sub_borrow<value_type>(*a_first, *b_first, borrow);
+        return borrow;
     }
 
     template <class InIter> constexpr inline bool increment(InIter a_first, InIter a_last)
@@ -392,279 +502,225 @@ namespace xenonis::algorithms {
         return true;
     }
 
+    template <typename Value> constexpr inline Value add_carry(Value a, Value b, Value& carry) noexcept
+    {
+        const auto sum{static_cast<Value>(a + b)};
+        const auto ret{static_cast<Value>(sum + carry)};
+        carry = static_cast<Value>((sum < a) | (ret < sum));
+        return ret;
+    }
+
+    template <typename Value> constexpr inline Value sub_borrow(Value a, Value b, Value& borrow) noexcept
+    {
+        const auto diff{static_cast<Value>(a - b)};
+        const auto ret{static_cast<Value>(diff - borrow)};
+        borrow = static_cast<Value>((a < b) | (diff < borrow));
+        return ret;
+    }
+
     template <typename Value> constexpr inline std::array<Value, 2> base_mul(Value a, Value b)
     {
         using doubled = typename traits::uinteger<Value>::doubled;
         using halved = typename traits::uinteger<Value>::halved;
 
         if constexpr (std::is_same_v<doubled, void>) {
-            halved res[4]{{0}}; // do not forget to initialize with 0
-            auto* a_halved{reinterpret_cast<halved*>(&a)};
-            auto* b_halved{reinterpret_cast<halved*>(&b)};
-            naive_mul(a_halved, a_halved + 2, b_halved, b_halved + 2, res, res + 4);
-
-            std::array<Value, 2> ret{{0, 0}};
-            std::memcpy(ret.data(), res, sizeof(Value) * 2);
-            return ret;
+            // schoolbook multiplication of the halves
+            constexpr unsigned half{std::numeric_limits<halved>::digits};
+            constexpr Value mask{std::numeric_limits<halved>::max()};
+            const auto a_low{static_cast<Value>(a & mask)}, a_high{static_cast<Value>(a >> half)};
+            const auto b_low{static_cast<Value>(b & mask)}, b_high{static_cast<Value>(b >> half)};
+
+            const auto low_low{static_cast<Value>(a_low * b_low)};
+            const auto low_high{static_cast<Value>(a_low * b_high)};
+            const auto high_low{static_cast<Value>(a_high * b_low)};
+            const auto high_high{static_cast<Value>(a_high * b_high)};
+
+            // cannot overflow: < 3 * 2^half
+            const auto mid{static_cast<Value>((low_low >> half) + (low_high & mask) + (high_low & mask))};
+            return {{static_cast<Value>((mid << half) | (low_low & mask)),
+                     static_cast<Value>(high_high + (low_high >> half) + (high_low >> half) + (mid >> half))}};
         } else {
-            doubled res{static_cast<doubled>(a) * b};
-            std::array<Value, 2> ret{{0, 0}};
-            std::memcpy(ret.data(), &res, sizeof(doubled));
-            return ret;
+            constexpr unsigned bits{std::numeric_limits<Value>::digits};
+            const auto res{static_cast<doubled>(static_cast<doubled>(a) * b)};
+            return {{static_cast<Value>(res), static_cast<Value>(res >> bits)}};
         }
     }
 
-    template <class OutIter, class InIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        void
-        naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last, OutIter out_first)
+    template <class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM inline Value addmul_1(InIter a_first, InIter a_last, Value b, OutIter out_first)
     {
-        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        XENONIS_STATS_KERNEL(addmul_1, std::distance(a_first, a_last));
 #if defined(XENONIS_INLINE_ASM_AMD64)
-        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
-            const auto a_size{std::distance(a_first, a_last)};
-
-            if (a_size % 2 == 0) {
-                for (; b_first != b_last; ++b_first, ++out_first) {
-                    if (*b_first == 0)
-                        continue;
-
-                    asm(R"(
-                                xor %%rax, %%rax
-                                xor %%rcx, %%rcx
-                                mov $1, %%rsi
-                                mov %[digit], %%rdx
-
-                                mulx (%[in]), %%r8, %%r9
-                                adcx (%[out]), %%r8
-                                mov %%r8, (%[out])
-
-                                setc %%al
-                                movzx %%al, %%rax
-                                cmp %%rsi, %[size]
-                                jng %=2f
-
-                            %=1:
-                                mulx (%[in],%%rsi,8), %%r10, %%r11
-                                adcx %%rax, %%r9
-                                adcx (%[out],%%rsi,8), %%r9
-                                adox %%rcx, %%r9
-                                adox %%r10, %%r9
-                                mov %%r9, (%[out],%%rsi,8)
-
-                                mulx 8(%[in],%%rsi,8), %%r8, %%r9
-                                adcx 8(%[out],%%rsi,8), %%r11
-                                adox %%r8, %%r11
-                                mov %%r11, 8(%[out],%%rsi,8)
-
-                                setc %%al
-                                movzx %%al, %%rax
-                                seto %%cl
-                                movzx %%cl, %%rcx
-                                add $2, %%rsi
-                                cmp %%rsi, %[size]
-                                jg %=1b
-
-                            %=2:
-                                mulx (%[in],%%rsi,8), %%r10, %%r11
-                                adcx %%rax, %%r9
-                                adcx (%[out],%%rsi,8), %%r9
-                                adox %%rcx, %%r9
-                                adox %%r10, %%r9
-                                mov %%r9, (%[out],%%rsi,8)
-
-                                mov $0, %%rax
-                                adcx 8(%[out],%%rsi,8), %%r11
-                                adox %%rax, %%r11
-                                mov %%r11, 8(%[out],%%rsi,8)
-                        )"
-                        : [out] "+r"(out_first)
-                        : [in] "r"(a_first), [digit] "rm"(*b_first), [size] "r"(a_size - 1)
-                        : "rax", "rcx", "rdx", "rsi", "r8", "r9", "r10", "r11", "memory");
-
-                    // same in Intel syntax:
-                    // asm (R"(
-                    // xor rax, rax
-                    // xor rcx, rcx
-                    // mov rsi, 1
-                    // mov rdx, %[digit]
-                    //
-                    // mulx r9, r8, QWORD PTR [%[in]]
-                    // adcx r8, QWORD PTR [%[out]]
-                    // mov QWORD PTR [%[out]], r8
-                    //
-                    // setc al
-                    // movzx rax, al
-                    // cmp %[size], rsi
-                    // jng %=2f
-                    //
-                    //%=1:
-                    // mulx r11, r10, QWORD PTR [%[in]+rsi*8]
-                    // adcx r9, rax
-                    // adcx r9, QWORD PTR [%[out]+rsi*8]
-                    // adox r9, rcx
-                    // adox r9, r10
-                    // mov QWORD PTR [%[out]+rsi*8], r9
-                    //
-                    // mulx r9, r8, QWORD PTR 8[%[in]+rsi*8]
-                    // adcx r11, QWORD PTR 8[%[out]+rsi*8]
-                    // adox r11, r8
-                    // mov QWORD PTR 8[%[out]+rsi*8], r11
-                    //
-                    // setc al
-                    // movzx rax, al
-                    // seto cl
-                    // movzx rcx, cl
-                    // add rsi, 2
-                    // cmp %[size], rsi
-                    // jg %=1b
-                    //
-                    //%=2:
-                    // mulx r11, r10, QWORD PTR [%[in]+rsi*8]
-                    // adcx r9, rax
-                    // adcx r9, QWORD PTR [%[out]+rsi*8]
-                    // adox r9, rcx
-                    // adox r9, r10
-                    // mov QWORD PTR [%[out]+rsi*8], r9
-                    //
-                    // mov rax, 0
-                    // adcx r11, QWORD PTR 8[%[out]+rsi*8]
-                    // adox r11, rax
-                    // mov QWORD PTR 8[%[out]+rsi*8], r11
-                    //)"
-                    //: [out] "+r" (out_first)
-                    //: [in] "r" (a_first), [digit] "rm" (digit), [size] "r" (a_size - 1)
-                    //: "rax", "rcx", "rdx", "rsi", "r8", "r9", "r10", "r11", "memory"
-                    //);
-                }
-            } else {
-                for (; b_first != b_last; ++b_first, ++out_first) {
-                    if (*b_first == 0)
-                        continue;
-
-                    asm(R"(
-                                xor %%rax, %%rax
-                                xor %%rcx, %%rcx
-                                mov $1, %%rsi
-                                mov %[digit], %%rdx
-
-                                mulx (%[in]), %%r8, %%r9
-                                adcx (%[out]), %%r8
-                                mov %%r8, (%[out])
-
-                                setc %%al
-                                movzx %%al, %%rax
-                                cmp %%rsi, %[size]
-                                jng %=2f
-
-                            %=1:
-                                mulx (%[in],%%rsi,8), %%r10, %%r11
-                                adcx %%rax, %%r9
-                                adcx (%[out],%%rsi,8), %%r9
-                                adox %%rcx, %%r9
-                                adox %%r10, %%r9
-                                mov %%r9, (%[out],%%rsi,8)
-
-                                mulx 8(%[in],%%rsi,8), %%r8, %%r9
-                                adcx 8(%[out],%%rsi,8), %%r11
-                                adox %%r8, %%r11
-                                mov %%r11, 8(%[out],%%rsi,8)
-
-                                setc %%al
-                                movzx %%al, %%rax
-                                seto %%cl
-                                movzx %%cl, %%rcx
-                                add $2, %%rsi
-                                cmp %%rsi, %[size]
-                                jg %=1b
-
-                            %=2:
-                                adcx (%[out],%%rsi,8), %%r9
-                                adcx %%rax, %%r9
-                                adox %%rcx, %%r9
-                                mov %%r9, (%[out],%%rsi,8)
-                        )"
-                        : [out] "+r"(out_first)
-                        : [in] "r"(a_first), [digit] "rm"(*b_first), [size] "r"(a_size)
-                        : "rax", "rcx", "rdx", "rsi", "r8", "r9", "r10", "r11", "memory");
-
-                    // same in Intel syntax:
-                    // asm (R"(
-                    // xor rax, rax
-                    // xor rcx, rcx
-                    // mov rsi, 1
-                    // mov rdx, %[digit]
-                    //
-                    // mulx r9, r8, QWORD PTR [%[in]]
-                    // adcx r8, QWORD PTR [%[out]]
-                    // mov QWORD PTR [%[out]], r8
-                    //
-                    // setc al
-                    // movzx rax, al
-                    // cmp %[size], rsi
-                    // jng %=2f
-                    //
-                    //%=1:
-                    // mulx r11, r10, QWORD PTR [%[in]+rsi*8]
-                    // adcx r9, rax
-                    // adcx r9, QWORD PTR [%[out]+rsi*8]
-                    // adox r9, rcx
-                    // adox r9, r10
-                    // mov QWORD PTR [%[out]+rsi*8], r9
-                    //
-                    // mulx r9, r8, QWORD PTR 8[%[in]+rsi*8]
-                    // adcx r11, QWORD PTR 8[%[out]+rsi*8]
-                    // adox r11, r8
-                    // mov QWORD PTR 8[%[out]+rsi*8], r11
-                    //
-                    // setc al
-                    // movzx rax, al
-                    // seto cl
-                    // movzx rcx, cl
-                    // add rsi, 2
-                    // cmp %[size], rsi
-                    // jg %=1b
-                    //
-                    //%=2:
-                    // adcx r9, QWORD PTR [%[out]+rsi*8]
-                    // adcx r9, rax
-                    // adox r9, rcx
-                    // mov QWORD PTR [%[out]+rsi*8], r9
-                    //)"
-                    //: [out] "+r" (out_first)
-                    //: [in] "r" (a_first), [digit] "rm" (digit), [size] "r" (a_size)
-                    //: "rax", "rcx", "rdx", "rbx", "rsi", "r8", "r9", "r10", "r11", "memory"
-                    //);
-                }
+        if constexpr (std::is_same_v<Value, std::uint64_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED()) {
+                auto size{static_cast<std::uint64_t>(std::distance(a_first, a_last))};
+                const auto* a{&*a_first};
+                auto* out{&*out_first};
+                std::uint64_t carry, blocks{size / 4};
+                size %= 4;
+                // the high limb of the product is added to the next low limb using the OF chain (adox), the low limb
+                // is added to out using the CF chain (adcx), the loop counters do not change the flags (jrcxz), the
+                // remaining size % 4 limbs are processed first, then blocks of 4 limbs
+                asm volatile(R"(
+                    mov %[b], %%rdx
+                    xor %[carry], %[carry]  # clears CF and OF
+                %=1:
+                    jrcxz %=2f
+                    mulx (%[a]), %%r10, %%r11
+                    adox %[carry], %%r10
+                    adcx (%[out]), %%r10
+                    mov %%r10, (%[out])
+                    mov %%r11, %[carry]
+                    lea 8(%[a]), %[a]
+                    lea 8(%[out]), %[out]
+                    lea -1(%%rcx), %%rcx
+                    jmp %=1b
+                %=2:
+                    mov %[blocks], %%rcx
+                %=3:
+                    jrcxz %=4f
+                    mulx (%[a]), %%r10, %%r11
+                    adox %[carry], %%r10
+                    adcx (%[out]), %%r10
+                    mov %%r10, (%[out])
+                    mulx 8(%[a]), %%r10, %[carry]
+                    adox %%r11, %%r10
+                    adcx 8(%[out]), %%r10
+                    mov %%r10, 8(%[out])
+                    mulx 16(%[a]), %%r10, %%r11
+                    adox %[carry], %%r10
+                    adcx 16(%[out]), %%r10
+                    mov %%r10, 16(%[out])
+                    mulx 24(%[a]), %%r10, %[carry]
+                    adox %%r11, %%r10
+                    adcx 24(%[out]), %%r10
+                    mov %%r10, 24(%[out])
+                    lea 32(%[a]), %[a]
+                    lea 32(%[out]), %[out]
+                    lea -1(%%rcx), %%rcx
+                    jmp %=3b
+                %=4:
+                    mov $0, %%r10
+                    adox %%r10, %[carry]
+                    adcx %%r10, %[carry]
+                )"
+                    : [a] "+r"(a), [out] "+r"(out), [size] "+c"(size), [carry] "=&r"(carry)
+                    : [b] "rm"(b), [blocks] "rm"(blocks)
+                    : "rdx", "r10", "r11", "cc", "memory");
+                return carry;
             }
-        } else {
+        }
 #endif
-            std::array<value_type, 2> n{};
-            value_type carry{};
-
-            for (; b_first != b_last; ++b_first, ++out_first) {
-                const auto digit = *b_first;
-                if (digit == 0)
-                    continue;
-                auto in_first{a_first};
-                auto ret_first{out_first};
-                carry = 0;
-
-                while (in_first != a_last) {
-                    n = base_mul(*(in_first++), digit);
-
-                    *ret_first += n[0];
-                    carry += carry ? *(ret_first++) <= n[0] : *(ret_first++) < n[0];
+        Value carry{0};
+        for (; a_first != a_last; ++a_first, ++out_first) {
+            // out[i] + a[i] * b + carry < base^2, so the high limb never overflows
+            auto n{base_mul(static_cast<Value>(*a_first), b)};
+            n[0] = static_cast<Value>(n[0] + carry);
+            n[1] = static_cast<Value>(n[1] + (n[0] < carry));
+            *out_first = static_cast<Value>(*out_first + n[0]);
+            carry = static_cast<Value>(n[1] + (*out_first < n[0]));
+        }
+        return carry;
+    }
 
-                    *ret_first += n[1] + carry;
-                    carry = carry ? *ret_first <= n[1] : *ret_first < n[1];
-                }
-            }
+    template <class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM inline Value submul_1(InIter a_first, InIter a_last, Value b, OutIter out_first)
+    {
+        XENONIS_STATS_KERNEL(submul_1, std::distance(a_first, a_last));
 #if defined(XENONIS_INLINE_ASM_AMD64)
+        if constexpr (std::is_same_v<Value, std::uint64_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED()) {
+                auto size{static_cast<std::uint64_t>(std::distance(a_first, a_last))};
+                const auto* a{&*a_first};
+                auto* out{&*out_first};
+                std::uint64_t borrow, blocks{size / 4};
+                size %= 4;
+                // like addmul_1, but out - x is calculated as out + ~x + 1 using the CF chain, which starts at 1, so
+                // that sbb (which would change OF) is not required
+                asm volatile(R"(
+                    mov %[b], %%rdx
+                    xor %[borrow], %[borrow]    # clears CF and OF
+                    stc
+                %=1:
+                    jrcxz %=2f
+                    mulx (%[a]), %%r10, %%r11
+                    adox %[borrow], %%r10
+                    not %%r10
+                    adcx (%[out]), %%r10
+                    mov %%r10, (%[out])
+                    mov %%r11, %[borrow]
+                    lea 8(%[a]), %[a]
+                    lea 8(%[out]), %[out]
+                    lea -1(%%rcx), %%rcx
+                    jmp %=1b
+                %=2:
+                    mov %[blocks], %%rcx
+                %=3:
+                    jrcxz %=4f
+                    mulx (%[a]), %%r10, %%r11
+                    adox %[borrow], %%r10
+                    not %%r10
+                    adcx (%[out]), %%r10
+                    mov %%r10, (%[out])
+                    mulx 8(%[a]), %%r10, %[borrow]
+                    adox %%r11, %%r10
+                    not %%r10
+                    adcx 8(%[out]), %%r10
+                    mov %%r10, 8(%[out])
+                    mulx 16(%[a]), %%r10, %%r11
+                    adox %[borrow], %%r10
+                    not %%r10
+                    adcx 16(%[out]), %%r10
+                    mov %%r10, 16(%[out])
+                    mulx 24(%[a]), %%r10, %[borrow]
+                    adox %%r11, %%r10
+                    not %%r10
+                    adcx 24(%[out]), %%r10
+                    mov %%r10, 24(%[out])
+                    lea 32(%[a]), %[a]
+                    lea 32(%[out]), %[out]
+                    lea -1(%%rcx), %%rcx
+                    jmp %=3b
+                %=4:
+                    mov $0, %%r10
+                    adox %%r10, %[borrow]
+                    cmc                         # the borrow of the subtraction is !CF
+                    adc %%r10, %[borrow]
+                )"
+                    : [a] "+r"(a), [out] "+r"(out), [size] "+c"(size), [borrow] "=&r"(borrow)
+                    : [b] "rm"(b), [blocks] "rm"(blocks)
+                    : "rdx", "r10", "r11", "cc", "memory");
+                return borrow;
+            }
         }
 #endif
+        Value borrow{0};
+        for (; a_first != a_last; ++a_first, ++out_first) {
+            auto n{base_mul(static_cast<Value>(*a_first), b)};
+            n[0] = static_cast<Value>(n[0] + borrow);
+            n[1] = static_cast<Value>(n[1] + (n[0] < borrow));
+            const auto out{*out_first};
+            *out_first = static_cast<Value>(out - n[0]);
+            borrow = static_cast<Value>(n[1] + (out < n[0]));
+        }
+        return borrow;
+    }
+
+    template <class OutIter, class InIter>
+    XENONIS_CONSTEXPR_ASM void naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                         OutIter out_first)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        XENONIS_STATS_KERNEL(naive_mul, std::max(std::distance(a_first, a_last), std::distance(b_first, b_last)));
+        const auto a_size{std::distance(a_first, a_last)};
+
+        // one row per limb of b, the limb following a row is not touched by the rows before
+        for (; b_first != b_last; ++b_first, ++out_first) {
+            const value_type digit{*b_first};
+            if (digit == 0)
+                continue;
+            out_first[a_size] = addmul_1(a_first, a_last, digit, out_first);
+        }
     }
 
     // simple but inefficient implementation of the naive multiplication in AMD64 assembly
@@ -705,11 +761,7 @@ namespace xenonis::algorithms {
     //}
 
     template <class OutContainer, class InIter>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        OutContainer
-        naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last)
+    XENONIS_CONSTEXPR_ASM OutContainer naive_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last)
     {
         const auto a_size{std::distance(a_first, a_last)};
         const auto b_size{std::distance(b_first, b_last)};
@@ -722,217 +774,678 @@ namespace xenonis::algorithms {
         return ret;
     }
 
-    template <class OutContainer, class InIter, std::size_t threshold>
-#if !defined(XENONIS_INLINE_ASM_AMD64)
-    constexpr
-#endif
-        OutContainer
-        karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last)
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer naive_mulhi(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                                   std::size_t n)
     {
         const auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
         const auto b_size{static_cast<std::size_t>(std::distance(b_first, b_last))};
+        XENONIS_STATS_KERNEL(naive_mulhi, n);
+
+        if (n >= a_size + b_size)
+            return naive_mul<OutContainer>(a_first, a_last, b_first, b_last);
+
+        // tmp holds the limbs from the guard limb first on, it absorbs the carries of the omitted partial products
+        // of the diagonal below
+        const auto first{a_size + b_size - n - 1};
+        OutContainer tmp(n + 1, 0);
+        for (std::size_t j{0}; j < b_size; ++j) {
+            const auto i{first > j ? first - j : 0};
+            if (i >= a_size)
+                continue;
+            // the limb following the row is not touched by the rows before
+            tmp[a_size + j - first] = addmul_1(a_first + i, a_last, b_first[j], tmp.begin() + (i + j - first));
+        }
+
+        OutContainer ret(n);
+        std::copy(tmp.cbegin() + 1, tmp.cend(), ret.begin());
+        remove_zeros(ret);
+        return ret;
+    }
 
-        // TODO: test different thresholds for when to use the naive multiplication
-        if (a_size <= threshold || b_size <= threshold) {
-            if (a_size < b_size) {
-                return naive_mul<OutContainer>(b_first, b_last, a_first, a_last);
+    namespace internal {
+        // the recursion of karatsuba_mul: the product has exactly a_size + b_size limbs and is not normalized (the most
+        // significant limbs may be zero), the lengths of the intermediate products are bounded using their values
+        // instead of scanning them. mullo, mulhi and the Montgomery reduction rely on the length.
+        template <class OutContainer, class InIter, std::size_t threshold, class Poll = no_poll>
+        XENONIS_CONSTEXPR_ASM OutContainer karatsuba_mul_unnormalized(InIter a_first, InIter a_last, InIter b_first,
+                                                                      InIter b_last, Poll poll = {})
+        {
+            const auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+            const auto b_size{static_cast<std::size_t>(std::distance(b_first, b_last))};
+            XENONIS_STATS_KERNEL(karatsuba_mul, std::max(a_size, b_size));
+
+            const auto mul = [&poll](InIter x_first, InIter x_last, InIter y_first, InIter y_last) {
+                return karatsuba_mul_unnormalized<OutContainer, InIter, threshold>(x_first, x_last, y_first, y_last,
+                                                                                   poll);
+            };
+            // the products of the parts of a and b are extended by zero limbs to the length of the product
+            const auto full = [a_size, b_size](OutContainer product) {
+                product.resize(a_size + b_size, 0);
+                return product;
+            };
+
+            // the threshold is measured on the host by bigint_tune, see bigint_tuning.hpp
+            if (a_size <= threshold || b_size <= threshold) {
+                OutContainer ret(a_size + b_size, 0);
+                if (a_size < b_size)
+                    naive_mul(b_first, b_last, a_first, a_last, ret.begin());
+                else
+                    naive_mul(a_first, a_last, b_first, b_last, ret.begin());
+                return ret;
+            }
+            poll(std::max(a_size, b_size));
+
+            auto max_size{std::max(a_size, b_size)};
+            if (max_size % 2 == 1)
+                ++max_size;
+            const auto limb_size{max_size / 2};
+
+            InIter a_l_first{a_first};
+            InIter a_l_last;
+            InIter b_l_first{b_first};
+            InIter b_l_last;
+            InIter a_h_first;
+            InIter a_h_last;
+            InIter b_h_first;
+            InIter b_h_last;
+
+            bool a_h_zero{false};
+            bool b_h_zero{false};
+
+            // std::size_t a_h_size;
+            // std::size_t b_h_size;
+
+            if (limb_size > a_size) {
+                a_l_last = a_last;
+                a_h_zero = true;
+                // a_h_size = 0;
+                a_h_first = nullptr;
+                a_h_last = nullptr;
             } else {
-                return naive_mul<OutContainer>(a_first, a_last, b_first, b_last);
+                a_l_last = a_first + limb_size; // maybe - 1
+                a_h_first = a_first + limb_size;
+                a_h_last = a_last;
+                a_h_zero = is_zero(a_h_first, a_h_last);
+                // a_h_size = std::distance(a_h_first, a_h_last);
             }
-        }
 
-        auto max_size{std::max(a_size, b_size)};
-        if (max_size % 2 == 1)
-            ++max_size;
-        const auto limb_size{max_size / 2};
-
-        InIter a_l_first{a_first};
-        InIter a_l_last;
-        InIter b_l_first{b_first};
-        InIter b_l_last;
-        InIter a_h_first;
-        InIter a_h_last;
-        InIter b_h_first;
-        InIter b_h_last;
-
-        bool a_h_zero{false};
-        bool b_h_zero{false};
-
-        // std::size_t a_h_size;
-        // std::size_t b_h_size;
-
-        if (limb_size > a_size) {
-            a_l_last = a_last;
-            a_h_zero = true;
-            // a_h_size = 0;
-            a_h_first = nullptr;
-            a_h_last = nullptr;
-        } else {
-            a_l_last = a_first + limb_size; // maybe - 1
-            a_h_first = a_first + limb_size;
-            a_h_last = a_last;
-            a_h_zero = is_zero(a_h_first, a_h_last);
-            // a_h_size = std::distance(a_h_first, a_h_last);
-        }
+            if (limb_size > b_size) {
+                b_l_last = b_last;
+                b_h_zero = true;
+                // b_h_size = 0;
+                b_h_first = nullptr;
+                b_h_last = nullptr;
+            } else {
+                b_l_last = b_first + limb_size; // maybe - 1
+                b_h_first = b_first + limb_size;
+                b_h_last = b_last;
+                b_h_zero = is_zero(b_h_first, b_h_last);
+                // b_h_size = std::distance(b_h_first, b_h_last);
+            }
 
-        if (limb_size > b_size) {
-            b_l_last = b_last;
-            b_h_zero = true;
-            // b_h_size = 0;
-            b_h_first = nullptr;
-            b_h_last = nullptr;
-        } else {
-            b_l_last = b_first + limb_size; // maybe - 1
-            b_h_first = b_first + limb_size;
-            b_h_last = b_last;
-            b_h_zero = is_zero(b_h_first, b_h_last);
-            // b_h_size = std::distance(b_h_first, b_h_last);
-        }
+            bool a_l_zero{is_zero(a_l_first, a_l_last)};
+            bool b_l_zero{is_zero(b_l_first, b_l_last)};
+
+            if ((a_h_zero && a_l_zero) || (b_h_zero && b_l_zero)) {
+                XENONIS_STATS_EVENT(karatsuba_zero);
+                return OutContainer(a_size + b_size, 0);
+            }
 
-        bool a_l_zero{is_zero(a_first, a_last)};
-        bool b_l_zero{is_zero(b_l_first, b_l_last)};
+            if (a_h_zero) { // a_l_zero is false
+                XENONIS_STATS_EVENT(karatsuba_a_h_zero);
+                if (b_h_zero)
+                    return full(mul(a_l_first, a_l_last, b_l_first, b_l_last));
 
-        if (a_h_zero && a_l_zero)
-            return OutContainer(1, 0);
+                if (b_l_zero) // b_h_zero is false
+                    return full(
+                        lshift<OutContainer, OutContainer>(mul(a_l_first, a_l_last, b_h_first, b_h_last), limb_size));
 
-        if (b_h_zero && b_l_zero)
-            return OutContainer(1, 0);
+                auto x{mul(b_h_first, b_h_last, a_l_first, a_l_last)};
+                auto y{mul(a_l_first, a_l_last, b_l_first, b_l_last)};
 
-        if (a_h_zero) { // a_l_zero is false
-            if (b_h_zero)
-                return karatsuba_mul<OutContainer>(a_l_first, a_l_last, b_l_first, b_l_last);
+                OutContainer ret(a_size + b_size, 0);
 
-            if (b_l_zero) // b_h_zero is false
-                return lshift<OutContainer, OutContainer>(
-                    karatsuba_mul<OutContainer>(a_l_first, a_l_last, b_h_first, b_h_last), limb_size);
+                std::copy(x.begin(), x.end(), ret.begin() + limb_size);
 
-            auto x{karatsuba_mul<OutContainer>(b_h_first, b_h_last, a_l_first, a_l_last)};
-            auto y{karatsuba_mul<OutContainer>(a_l_first, a_l_last, b_l_first, b_l_last)};
+                if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
+                    algorithms::increment(ret.begin() + y.size(), ret.end());
 
+                return ret;
+            }
+
+            if (b_h_zero) { // b_l_zero is false
+                XENONIS_STATS_EVENT(karatsuba_b_h_zero);
+                if (a_h_zero)
+                    return full(mul(b_l_first, b_l_last, a_l_first, a_l_last));
+
+                if (a_l_zero) // a_h_zero is false
+                    return full(
+                        lshift<OutContainer, OutContainer>(mul(b_l_first, b_l_last, a_h_first, a_h_last), limb_size));
+
+                auto x{mul(a_h_first, a_h_last, b_l_first, b_l_last)};
+                auto y{mul(b_l_first, b_l_last, a_l_first, a_l_last)};
+
+                OutContainer ret(a_size + b_size, 0);
+
+                std::copy(x.begin(), x.end(), ret.begin() + limb_size);
+
+                if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
+                    algorithms::increment(ret.begin() + y.size(), ret.end());
+
+                return ret;
+            }
+
+            if (a_l_zero) { // a_h_zero is false
+                XENONIS_STATS_EVENT(karatsuba_a_l_zero);
+                if (b_l_zero)
+                    return full(
+                        lshift<OutContainer, OutContainer>(mul(a_h_first, a_h_last, b_h_first, b_h_last), max_size));
+
+                auto x{mul(a_h_first, a_h_last, b_h_first, b_h_last)};
+                auto y{lshift<OutContainer, OutContainer>(mul(a_h_first, a_h_last, b_l_first, b_l_last), limb_size)};
+
+                OutContainer ret(a_size + b_size, 0);
+                std::copy(x.begin(), x.end(), ret.begin() + max_size);
+
+                if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
+                    algorithms::increment(ret.begin() + y.size(), ret.end());
+
+                return ret;
+            }
+
+            if (b_l_zero) { // b_h_zero is false
+                XENONIS_STATS_EVENT(karatsuba_b_l_zero);
+                auto x{mul(b_h_first, b_h_last, a_h_first, a_h_last)};
+                auto y{lshift<OutContainer, OutContainer>(mul(b_h_first, b_h_last, a_l_first, a_l_last), limb_size)};
+
+                OutContainer ret(a_size + b_size, 0);
+                std::copy(x.begin(), x.end(), ret.begin() + max_size);
+
+                if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
+                    algorithms::increment(ret.begin() + y.size(), ret.end());
+
+                return ret;
+            }
+
+            OutContainer p1;
+            OutContainer p2;
+            OutContainer p3;
+
+            // calculate p1 and p2
+            // tbb::task_group tg; // simple parallelization which may be used in the future
+            /*tg.run([&]() {*/ p1 = mul(a_h_first, a_h_last, b_h_first, b_h_last); //});
+            /*tg.run([&]() {*/ p2 = mul(a_l_first, a_l_last, b_l_first, b_l_last); //});
+
+            constexpr auto cp_add = [](auto a_first, auto a_last, auto b_first, auto b_last, auto a_size, auto b_size) {
+                constexpr auto add = [](auto a_first, auto a_last, auto b_first, auto b_last, auto a_size,
+                                        auto b_size) {
+                    OutContainer tmp(a_size + 1);
+                    tmp.back() = 0;
+                    if (xenonis::algorithms::add(a_first, b_first, b_last, tmp.begin())) {
+                        std::copy(a_first + b_size, a_last, tmp.begin() + b_size);
+                        xenonis::algorithms::increment(tmp.begin() + b_size, tmp.end());
+                    } else {
+                        std::copy(a_first + b_size, a_last, tmp.begin() + b_size);
+                        tmp.pop_back();
+                    }
+                    return /*std::move(*/ tmp /*)*/;
+                };
+
+                if (a_size >= b_size)
+                    return add(a_first, a_last, b_first, b_last, a_size, b_size);
+                else
+                    return add(b_first, b_last, a_first, a_last, b_size, a_size);
+            };
+
+            // calculate p3
+            auto p3_1{cp_add(a_l_first, a_l_last, a_h_first, a_h_last, limb_size,
+                             static_cast<std::size_t>(std::distance(a_h_first, a_h_last)))};
+            auto p3_2{cp_add(b_l_first, b_l_last, b_h_first, b_h_last, limb_size,
+                             static_cast<std::size_t>(std::distance(b_h_first, b_h_last)))};
+
+            /*tg.run([&]() {*/ p3 = karatsuba_mul_unnormalized<OutContainer, decltype(p3_1.cbegin()), threshold>(
+                p3_1.cbegin(), p3_1.cend(), p3_2.cbegin(), p3_2.cend(), poll); //});
+            // tg.wait();
+
+            // p3 >= p1 and p3 >= p2, so the limbs of p1 and p2 beyond the length of p3 are zero
+            const auto p1_size{std::min(p1.size(), p3.size())};
+            const auto p2_size{std::min(p2.size(), p3.size())};
+
+            // TODO: do not decrement twice, decrement by 2 ones
+            if (sub_from(p3.begin(), p1.cbegin(), p1.cbegin() + p1_size))
+                decrement(p3.begin() + p1_size, p3.end());
+
+            if (sub_from(p3.begin(), p2.cbegin(), p2.cbegin() + p2_size))
+                decrement(p3.begin() + p2_size, p3.end());
+
+            // p3 * base^limb_size <= a * b, so the limbs of p3 beyond the length of the result are zero
+            const auto p3_size{std::min(p3.size(), a_size + b_size - limb_size)};
+
+            // calculate result
             OutContainer ret(a_size + b_size, 0);
+            std::copy(p1.begin(), p1.end(), ret.begin() + max_size);
 
-            std::copy(x.begin(), x.end(), ret.begin() + limb_size);
+            // TODO: do not decrement twice, decrement by 2 ones
+            if (add(ret.cbegin(), p2.cbegin(), p2.cend(), ret.begin()))
+                increment(ret.begin() + p2.size(), ret.end());
 
-            if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
-                algorithms::increment(ret.begin() + y.size(), ret.end());
+            if (add(ret.cbegin() + limb_size, p3.cbegin(), p3.cbegin() + p3_size, ret.begin() + limb_size))
+                increment(ret.begin() + p3_size + limb_size, ret.end());
 
-            remove_zeros(ret);
             return ret;
         }
+    } // namespace internal
 
-        if (b_h_zero) { // b_l_zero is false
-            if (a_h_zero)
-                return karatsuba_mul<OutContainer>(b_l_first, b_l_last, a_l_first, a_l_last);
-
-            if (a_l_zero) // a_h_zero is false
-                return lshift<OutContainer, OutContainer>(
-                    karatsuba_mul<OutContainer>(b_l_first, b_l_last, a_h_first, a_h_last), limb_size);
+    template <class OutContainer, class InIter, std::size_t threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last)
+    {
+        return karatsuba_mul<OutContainer, InIter, threshold>(a_first, a_last, b_first, b_last, internal::no_poll{});
+    }
 
-            auto x{karatsuba_mul<OutContainer>(a_h_first, a_h_last, b_l_first, b_l_last)};
-            auto y{karatsuba_mul<OutContainer>(b_l_first, b_l_last, a_l_first, a_l_last)};
+    template <class OutContainer, class InIter, std::size_t threshold, class Poll>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_mul(InIter a_first, InIter a_last, InIter b_first, InIter b_last,
+                                                     Poll poll)
+    {
+        // only the final product is normalized
+        auto ret{internal::karatsuba_mul_unnormalized<OutContainer, InIter, threshold>(a_first, a_last, b_first,
+                                                                                        b_last, poll)};
+        remove_zeros(ret);
+        return ret;
+    }
 
-            OutContainer ret(a_size + b_size, 0);
+    template <class OutIter, class InIter>
+    XENONIS_CONSTEXPR_ASM void naive_mullo(InIter a_first, InIter a_last, InIter b_first, InIter b_last, std::size_t n,
+                                           OutIter out_first)
+    {
+        const auto a_size{std::min(static_cast<std::size_t>(std::distance(a_first, a_last)), n)};
+        const auto b_size{std::min(static_cast<std::size_t>(std::distance(b_first, b_last)), n)};
+        XENONIS_STATS_KERNEL(naive_mullo, n);
+
+        std::fill(out_first, out_first + n, 0);
+        for (std::size_t j{0}; j < b_size; ++j) {
+            // the row is cut at the limb n, the limb following it is not touched by the rows before
+            const auto size{std::min(a_size, n - j)};
+            const auto carry{addmul_1(a_first, a_first + size, b_first[j], out_first + j)};
+            if (j + size < n)
+                out_first[j + size] = carry;
+        }
+    }
 
-            std::copy(x.begin(), x.end(), ret.begin() + limb_size);
+    namespace internal {
+        // the recursion of mullo, the result has exactly n limbs
+        template <class OutContainer, class InIter, std::size_t threshold>
+        XENONIS_CONSTEXPR_ASM OutContainer mullo_unnormalized(InIter a_first, InIter a_last, InIter b_first,
+                                                              InIter b_last, std::size_t n)
+        {
+            // the limbs from n on do not contribute
+            const auto a_size{std::min(static_cast<std::size_t>(std::distance(a_first, a_last)), n)};
+            const auto b_size{std::min(static_cast<std::size_t>(std::distance(b_first, b_last)), n)};
+            XENONIS_STATS_KERNEL(mullo, n);
+
+            OutContainer ret(n, 0);
+            if (a_size == 0 || b_size == 0)
+                return ret;
+
+            if (a_size <= threshold || b_size <= threshold) {
+                naive_mullo(a_first, a_first + a_size, b_first, b_first + b_size, n, ret.begin());
+                return ret;
+            }
 
-            if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
-                algorithms::increment(ret.begin() + y.size(), ret.end());
+            // the product of the low limbs, if the operands are short enough it is the full product
+            const auto k{a_size + b_size <= n ? n : (7 * n + 9) / 10};
+            const auto a_l_size{std::min(a_size, k)};
+            const auto b_l_size{std::min(b_size, k)};
+            const auto low{karatsuba_mul_unnormalized<OutContainer, InIter, threshold>(
+                a_first, a_first + a_l_size, b_first, b_first + b_l_size)};
+            std::copy(low.cbegin(), low.cbegin() + std::min(low.size(), n), ret.begin());
+
+            // the cross products contribute to the limbs [k, n), the carries beyond n are dropped
+            if (a_size > k) {
+                const auto cross{mullo_unnormalized<OutContainer, InIter, threshold>(
+                    a_first + k, a_first + a_size, b_first, b_first + b_l_size, n - k)};
+                add(ret.cbegin() + k, cross.cbegin(), cross.cend(), ret.begin() + k);
+            }
+            if (b_size > k) {
+                const auto cross{mullo_unnormalized<OutContainer, InIter, threshold>(
+                    a_first, a_first + a_l_size, b_first + k, b_first + b_size, n - k)};
+                add(ret.cbegin() + k, cross.cbegin(), cross.cend(), ret.begin() + k);
+            }
 
-            remove_zeros(ret);
             return ret;
         }
 
-        if (a_l_zero) { // a_h_zero is false
-            if (b_l_zero)
-                return lshift<OutContainer, OutContainer>(
-                    karatsuba_mul<OutContainer>(a_h_first, a_h_last, b_h_first, b_h_last), max_size);
+        // the recursion of mulhi for a and b with n limbs each: the result has exactly n limbs and
+        // 0 <= floor(a * b / base^n) - h <= 2 * n
+        template <class OutContainer, class InIter, std::size_t threshold>
+        XENONIS_CONSTEXPR_ASM OutContainer mulhi_balanced(InIter a_first, InIter b_first, std::size_t n)
+        {
+            XENONIS_STATS_KERNEL(mulhi, n);
+
+            if (n <= threshold || n < 8) {
+                auto ret{naive_mulhi<OutContainer>(a_first, a_first + n, b_first, b_first + n, n)};
+                ret.resize(n, 0);
+                return ret;
+            }
 
-            auto x{karatsuba_mul<OutContainer>(a_h_first, a_h_last, b_h_first, b_h_last)};
-            auto y{lshift<OutContainer, OutContainer>(
-                karatsuba_mul<OutContainer>(a_h_first, a_h_last, b_l_first, b_l_last), limb_size)};
+            // a = a_h * base^l + a_l, a * b / base^n = a_h * b_h / base^(k - l) + (a_h * b_l + a_l * b_h) / base^k +
+            // a_l * b_l / base^n. The last term is less than one, the cross products are approximated by the products of
+            // the l most significant limbs of a_h (or b_h) with b_l (or a_l), which is less than one off. By
+            // induction the error is at most 2 * (2 * l) + 5 <= 2 * n for k >= 0.7 * n and n >= 8.
+            const auto k{(7 * n + 9) / 10};
+            const auto l{n - k};
+            const auto high{karatsuba_mul_unnormalized<OutContainer, InIter, threshold>(a_first + l, a_first + n,
+                                                                                         b_first + l, b_first + n)};
+            // high has 2 * k limbs, the k - l least significant ones are dropped
+            OutContainer ret(n, 0);
+            if (high.size() > k - l)
+                std::copy(high.cbegin() + (k - l), high.cbegin() + std::min(high.size(), k - l + n), ret.begin());
+
+            const auto cross_a{mulhi_balanced<OutContainer, InIter, threshold>(a_first + k, b_first, l)};
+            if (add(ret.cbegin(), cross_a.cbegin(), cross_a.cend(), ret.begin()))
+                increment(ret.begin() + l, ret.end());
+            const auto cross_b{mulhi_balanced<OutContainer, InIter, threshold>(a_first, b_first + k, l)};
+            if (add(ret.cbegin(), cross_b.cbegin(), cross_b.cend(), ret.begin()))
+                increment(ret.begin() + l, ret.end());
 
-            OutContainer ret(a_size + b_size, 0);
-            std::copy(x.begin(), x.end(), ret.begin() + max_size);
+            return ret;
+        }
+    } // namespace internal
 
-            if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
-                algorithms::increment(ret.begin() + y.size(), ret.end());
+    template <class OutContainer, class InIter, std::size_t threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer mullo(InIter a_first, InIter a_last, InIter b_first, InIter b_last, std::size_t n)
+    {
+        auto ret{internal::mullo_unnormalized<OutContainer, InIter, threshold>(a_first, a_last, b_first, b_last, n)};
+        remove_zeros(ret);
+        return ret;
+    }
 
+    template <class OutContainer, class InIter, std::size_t threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer mulhi(InIter a_first, InIter a_last, InIter b_first, InIter b_last, std::size_t n)
+    {
+        auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+        auto b_size{static_cast<std::size_t>(std::distance(b_first, b_last))};
+        if (n >= a_size + b_size)
+            return karatsuba_mul<OutContainer, InIter, threshold>(a_first, a_last, b_first, b_last);
+
+        // the limbs below the n most significant ones of an operand contribute less than one to the result
+        if (a_size > n) {
+            a_first += a_size - n;
+            a_size = n;
+        }
+        if (b_size > n) {
+            b_first += b_size - n;
+            b_size = n;
+        }
+        const auto shift{a_size + b_size - n};
+
+        if (a_size <= threshold || b_size <= threshold)
+            return naive_mulhi<OutContainer>(a_first, a_last, b_first, b_last, n);
+
+        // the operands are extended by zero limbs to n limbs, which multiplies the product by base^(2 * n - a_size -
+        // b_size), if this costs less than the full product
+        if (2 * n - a_size - b_size <= n / 4) {
+            OutContainer a(n, 0);
+            OutContainer b(n, 0);
+            std::copy(a_first, a_last, a.begin() + (n - a_size));
+            std::copy(b_first, b_last, b.begin() + (n - b_size));
+            auto ret{internal::mulhi_balanced<OutContainer, decltype(a.cbegin()), threshold>(
+                a.cbegin(), b.cbegin(), n)};
             remove_zeros(ret);
             return ret;
         }
 
-        if (b_l_zero) { // b_h_zero is false
-            auto x{karatsuba_mul<OutContainer>(b_h_first, b_h_last, a_h_first, a_h_last)};
-            auto y{lshift<OutContainer, OutContainer>(
-                karatsuba_mul<OutContainer>(b_h_first, b_h_last, a_l_first, a_l_last), limb_size)};
+        const auto product{
+            internal::karatsuba_mul_unnormalized<OutContainer, InIter, threshold>(a_first, a_last, b_first, b_last)};
+        // product has a_size + b_size limbs, the shift least significant ones are dropped
+        OutContainer ret(n, 0);
+        if (product.size() > shift)
+            std::copy(product.cbegin() + shift, product.cbegin() + std::min(product.size(), shift + n), ret.begin());
+        remove_zeros(ret);
+        return ret;
+    }
 
-            OutContainer ret(a_size + b_size, 0);
-            std::copy(x.begin(), x.end(), ret.begin() + max_size);
+    template <class OutIter, class InIter>
+    XENONIS_CONSTEXPR_ASM void naive_sqr(InIter a_first, InIter a_last, OutIter out_first)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        const auto size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+        XENONIS_STATS_KERNEL(naive_sqr, size);
 
-            if (algorithms::add(ret.cbegin(), y.cbegin(), y.cend(), ret.begin()))
-                algorithms::increment(ret.begin() + y.size(), ret.end());
+        std::fill(out_first, out_first + 2 * size, value_type{0});
+
+        // the products a[i] * a[j] with i < j, row i starts at out[2 * i + 1] and its carry is the first limb which
+        // has not been written yet
+        for (std::size_t i{0}; i + 1 < size; ++i)
+            out_first[i + size] = addmul_1(a_first + i + 1, a_last, static_cast<value_type>(a_first[i]),
+                                           out_first + 2 * i + 1);
+
+        // doubled, their sum is less than a^2 / 2, so no bit is shifted out
+        lshift_bits(out_first, out_first + 2 * size, out_first, 1);
+
+        value_type carry{0};
+        for (std::size_t i{0}; i < size; ++i) {
+            const auto square{base_mul(static_cast<value_type>(a_first[i]), static_cast<value_type>(a_first[i]))};
+            out_first[2 * i] = add_carry(static_cast<value_type>(out_first[2 * i]), square[0], carry);
+            out_first[2 * i + 1] = add_carry(static_cast<value_type>(out_first[2 * i + 1]), square[1], carry);
+        }
+    }
+
+    namespace internal {
+        // the recursion of karatsuba_sqr, the result has exactly twice the size of a and is not normalized
+        template <class OutContainer, class InIter, std::size_t threshold>
+        XENONIS_CONSTEXPR_ASM OutContainer karatsuba_sqr_unnormalized(InIter a_first, InIter a_last)
+        {
+            const auto size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+            XENONIS_STATS_KERNEL(karatsuba_sqr, size);
+
+            if (size <= threshold) {
+                OutContainer ret(2 * size);
+                naive_sqr(a_first, a_last, ret.begin());
+                return ret;
+            }
+
+            // the low half l has k limbs, the high half h has size - k <= k limbs
+            const auto k{(size + 1) / 2};
+            const auto h_size{size - k};
+            const auto l_last{a_first + k};
+
+            const auto p1{karatsuba_sqr_unnormalized<OutContainer, InIter, threshold>(l_last, a_last)};
+            const auto p2{karatsuba_sqr_unnormalized<OutContainer, InIter, threshold>(a_first, l_last)};
+
+            OutContainer sum(k + 1, 0);
+            const bool carry{add(a_first, l_last, a_last, sum.begin())};
+            std::copy(a_first + h_size, l_last, sum.begin() + h_size);
+            if (carry)
+                increment(sum.begin() + h_size, sum.end());
+            if (sum.back() == 0)
+                sum.pop_back();
+
+            // p3 = 2 * h * l, p1 and p2 are not longer than p3
+            auto p3{karatsuba_sqr_unnormalized<OutContainer, decltype(sum.cbegin()), threshold>(sum.cbegin(),
+                                                                                                 sum.cend())};
+            if (sub_from(p3.begin(), p1.cbegin(), p1.cend()))
+                decrement(p3.begin() + p1.size(), p3.end());
+            if (sub_from(p3.begin(), p2.cbegin(), p2.cend()))
+                decrement(p3.begin() + p2.size(), p3.end());
+
+            // p3 < 2 * base^size, so the limbs of p3 beyond the length of the result are zero
+            const auto p3_size{std::min(p3.size(), 2 * size - k)};
+
+            OutContainer ret(2 * size);
+            std::copy(p2.cbegin(), p2.cend(), ret.begin());
+            std::copy(p1.cbegin(), p1.cend(), ret.begin() + 2 * k);
+            if (add(ret.cbegin() + k, p3.cbegin(), p3.cbegin() + p3_size, ret.begin() + k))
+                increment(ret.begin() + k + p3_size, ret.end());
 
-            remove_zeros(ret);
             return ret;
         }
+    } // namespace internal
 
-        OutContainer p1;
-        OutContainer p2;
-        OutContainer p3;
-
-        // calculate p1 and p2
-        // tbb::task_group tg; // simple parallelization which may be used in the future
-        /*tg.run([&]() {*/ p1 = karatsuba_mul<OutContainer>(a_h_first, a_h_last, b_h_first, b_h_last); //});
-        /*tg.run([&]() {*/ p2 = karatsuba_mul<OutContainer>(a_l_first, a_l_last, b_l_first, b_l_last); //});
-
-        constexpr auto cp_add = [](auto a_first, auto a_last, auto b_first, auto b_last, auto a_size, auto b_size) {
-            constexpr auto add = [](auto a_first, auto a_last, auto b_first, auto b_last, auto a_size, auto b_size) {
-                OutContainer tmp(a_size + 1);
-                tmp.back() = 0;
-                if (xenonis::algorithms::add(a_first, b_first, b_last, tmp.begin())) {
-                    std::copy(a_first + b_size, a_last, tmp.begin() + b_size);
-                    xenonis::algorithms::increment(tmp.begin() + b_size, tmp.end());
+    template <class OutContainer, class InIter, std::size_t threshold>
+    XENONIS_CONSTEXPR_ASM OutContainer karatsuba_sqr(InIter a_first, InIter a_last)
+    {
+        auto ret{internal::karatsuba_sqr_unnormalized<OutContainer, InIter, threshold>(a_first, a_last)};
+        remove_zeros(ret);
+        return ret;
+    }
+
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer pow(InIter a_first, InIter a_last, std::uint64_t exp)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        using iter = decltype(std::declval<const OutContainer&>().cbegin());
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+
+        // a is copied, so that all operands have the same iterator type
+        const auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+        OutContainer a(a_size);
+        std::copy(a_first, a_last, a.begin());
+        if (exp == 1)
+            return a;
+
+        // a < 2^a_bits, so a^exp < 2^(a_bits * exp), the kernels may write one more (zero) limb
+        const auto a_bits{a_size * bits - count_leading_zeros(a.back())};
+        const auto max_size{(a_bits * exp + bits - 1) / bits + 1};
+        OutContainer x(max_size), y(max_size);
+        std::copy(a.cbegin(), a.cend(), x.begin());
+        std::size_t size{a_size};
+
+        const auto normalized_size = [](const OutContainer& c, std::size_t n) {
+            while (n > 1 && c[n - 1] == 0)
+                --n;
+            return n;
+        };
+
+        for (auto i{static_cast<unsigned>(std::numeric_limits<std::uint64_t>::digits) - 1 -
+                    count_leading_zeros(exp)};
+             i-- > 0;) {
+            // y = x^2
+            if (size <= karatsuba_threshold) {
+                naive_sqr(x.cbegin(), x.cbegin() + size, y.begin());
+            } else {
+                const auto square{internal::karatsuba_sqr_unnormalized<OutContainer, iter, karatsuba_threshold>(
+                    x.cbegin(), x.cbegin() + size)};
+                std::copy(square.cbegin(), square.cend(), y.begin());
+            }
+            size = normalized_size(y, 2 * size);
+            std::swap(x, y);
+
+            if (((exp >> i) & 1) != 0) {
+                // y = x * a, x is at least as long as a
+                if (a_size <= karatsuba_threshold) {
+                    std::fill(y.begin(), y.begin() + size + a_size, value_type{0});
+                    naive_mul(x.cbegin(), x.cbegin() + size, a.cbegin(), a.cend(), y.begin());
                 } else {
-                    std::copy(a_first + b_size, a_last, tmp.begin() + b_size);
-                    tmp.pop_back();
+                    const auto product{internal::karatsuba_mul_unnormalized<OutContainer, iter, karatsuba_threshold>(
+                        x.cbegin(), x.cbegin() + size, a.cbegin(), a.cend())};
+                    std::copy(product.cbegin(), product.cend(), y.begin());
                 }
-                return /*std::move(*/ tmp /*)*/;
-            };
+                size = normalized_size(y, size + a_size);
+                std::swap(x, y);
+            }
+        }
 
-            if (a_size >= b_size)
-                return add(a_first, a_last, b_first, b_last, a_size, b_size);
-            else
-                return add(b_first, b_last, a_first, a_last, b_size, a_size);
-        };
+        x.pop_n(x.size() - size);
+        return x;
+    }
+
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR std::pair<OutContainer, OutContainer> divmod(InIter a_first, InIter a_last, InIter b_first,
+                                                                   InIter b_last)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        using doubled = typename traits::uinteger<value_type>::doubled;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+        constexpr doubled base{static_cast<doubled>(std::numeric_limits<value_type>::max()) + 1};
 
-        // calculate p3
-        auto p3_1{cp_add(a_l_first, a_l_last, a_h_first, a_h_last, limb_size, static_cast<std::size_t>(std::distance(a_h_first, a_h_last)))};
-        auto p3_2{cp_add(b_l_first, b_l_last, b_h_first, b_h_last, limb_size, static_cast<std::size_t>(std::distance(b_h_first, b_h_last)))};
+        const auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+        const auto b_size{static_cast<std::size_t>(std::distance(b_first, b_last))};
+        XENONIS_STATS_KERNEL(divmod, a_size);
 
-        /*tg.run([&]() {*/ p3 = karatsuba_mul<OutContainer>(p3_1.begin(), p3_1.end(), p3_2.begin(), p3_2.end()); //});
-        // tg.wait();
+        if (less(a_first, a_last, b_first, b_last, false)) {
+            OutContainer r(a_size);
+            std::copy(a_first, a_last, r.begin());
+            return std::make_pair(OutContainer(1, 0), std::move(r));
+        }
 
-        // TODO: do not decrement twice, decrement by 2 ones
-        if (sub_from(p3.begin(), p1.begin(), p1.end()))
-            decrement(p3.begin() + p1.size(), p3.end());
+        if (b_size == 1) {
+            const value_type digit{*b_first};
+            OutContainer q(a_size);
+            doubled r{0};
+            for (auto i{a_size}; i-- > 0;) {
+                const auto n{static_cast<doubled>((r << bits) | a_first[i])};
+                q[i] = static_cast<value_type>(n / digit);
+                r = n % digit;
+            }
+            remove_zeros(q);
+            return std::make_pair(std::move(q), OutContainer(1, static_cast<value_type>(r)));
+        }
 
-        if (sub_from(p3.begin(), p2.begin(), p2.end()))
-            decrement(p3.begin() + p2.size(), p3.end());
+        // normalize, so that the most significant bit of b is set, then the estimated quotient digit is at most two
+        // too large
+        const unsigned shift{count_leading_zeros(b_first[b_size - 1])};
+        OutContainer bn(b_size);
+        OutContainer an(a_size + 1);
+        if (shift != 0) {
+            lshift_bits(b_first, b_last, bn.begin(), shift);
+            an.back() = lshift_bits(a_first, a_last, an.begin(), shift);
+        } else {
+            std::copy(b_first, b_last, bn.begin());
+            std::copy(a_first, a_last, an.begin());
+            an.back() = 0;
+        }
 
-        remove_zeros(p3);
+        const value_type b_high{bn[b_size - 1]};
+        const value_type b_next{bn[b_size - 2]};
+        OutContainer q(a_size - b_size + 1);
+
+        for (auto j{a_size - b_size + 1}; j-- > 0;) {
+            const auto n{static_cast<doubled>((static_cast<doubled>(an[j + b_size]) << bits) | an[j + b_size - 1])};
+            auto q_hat{static_cast<doubled>(n / b_high)};
+            auto r_hat{static_cast<doubled>(n % b_high)};
+
+            while (q_hat >= base ||
+                   static_cast<doubled>(q_hat * b_next) > static_cast<doubled>((r_hat << bits) | an[j + b_size - 2])) {
+                --q_hat;
+                r_hat += b_high;
+                if (r_hat >= base)
+                    break;
+            }
 
-        // calculate result
-        OutContainer ret(a_size + b_size, 0);
-        std::copy(p1.begin(), p1.end(), ret.begin() + max_size);
+            // an[j, j + b_size] -= q_hat * bn
+            value_type mul_carry{0};
+            bool borrow{false};
+            for (std::size_t i{0}; i < b_size; ++i) {
+                const auto p{static_cast<doubled>(q_hat * bn[i] + mul_carry)};
+                mul_carry = static_cast<value_type>(p >> bits);
+                const auto p_low{static_cast<value_type>(p)};
+                const value_type n_i{an[i + j]};
+                an[i + j] = static_cast<value_type>(n_i - p_low - borrow);
+                borrow = borrow ? n_i <= p_low : n_i < p_low;
+            }
 
-        // TODO: do not decrement twice, decrement by 2 ones
-        if (add(ret.cbegin(), p2.cbegin(), p2.cend(), ret.begin()))
-            increment(ret.begin() + p2.size(), ret.end());
+            const value_type n_high{an[j + b_size]};
+            const auto sub{static_cast<doubled>(static_cast<doubled>(mul_carry) + borrow)};
+            an[j + b_size] = static_cast<value_type>(n_high - sub);
 
-        if (add(ret.cbegin() + limb_size, p3.cbegin(), p3.cend(), ret.begin() + limb_size))
-            increment(ret.begin() + p3.size() + limb_size, ret.end());
+            if (n_high < sub) { // q_hat was one too large, add b back
+                --q_hat;
+                if (add(an.cbegin() + j, bn.cbegin(), bn.cend(), an.begin() + j))
+                    ++an[j + b_size];
+            }
 
-        remove_zeros(ret);
-        return ret;
+            q[j] = static_cast<value_type>(q_hat);
+        }
+
+        OutContainer r(b_size);
+        if (shift != 0)
+            rshift_bits(an.cbegin(), an.cbegin() + b_size, r.begin(), shift);
+        else
+            std::copy(an.cbegin(), an.cbegin() + b_size, r.begin());
+
+        remove_zeros(q);
+        remove_zeros(r);
+        return std::make_pair(std::move(q), std::move(r));
     }
 } // namespace xenonis::algorithms
@@ -0,0 +1,177 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file batch.hpp
+ *  Implements the arithmetic algorithms used in batch.hpp
+ *  \details All numbers of a batch have the same number of limbs and are stored as structure of arrays: limb i of
+ *  number j is stored at first[i * count + j]. The kernels process lane groups of batch_lanes numbers at once, the
+ *  inner loops run over independent numbers and are branch free, so that the compiler can map them to SIMD
+ *  registers (e.g. 4 or 8 lanes of AVX2 / AVX-512 when compiling with -mavx2 / -mavx512f).
+ */
+#pragma once
+
+#include "arithmetic.hpp"
+#include <cstddef>
+#include <iterator>
+
+namespace xenonis::algorithms {
+    //! the number of numbers processed together by the batch kernels
+    constexpr std::size_t batch_lanes{8};
+
+    /*!
+     *  Adds b to a and writes the result to c for count numbers with limbs limbs each. It is possible that a is c.
+     *  \param a_first random access iterator pointing to the first element of a. Could be const iterator.
+     *  \param b_first random access iterator pointing to the first element of b. Could be const iterator.
+     *  \param c_first random access iterator pointing to the first element of c.
+     *  \param carry_first random access iterator pointing to count elements, receives the carries
+     */
+    template <class InIter, class OutIter, class CarryIter>
+    inline void batch_add(InIter a_first, InIter b_first, OutIter c_first, CarryIter carry_first, std::size_t limbs,
+                          std::size_t count);
+
+    /*!
+     *  Subtracts b from a and writes the result to c for count numbers with limbs limbs each. It is possible that a is
+     *  c.
+     *  \param carry_first random access iterator pointing to count elements, receives the borrows
+     */
+    template <class InIter, class OutIter, class CarryIter>
+    inline void batch_sub(InIter a_first, InIter b_first, OutIter c_first, CarryIter carry_first, std::size_t limbs,
+                          std::size_t count);
+
+    /*!
+     *  Multiplies a with b and writes the lower limbs limbs of the product to c for count numbers. c must be neither a
+     *  nor b.
+     */
+    template <class InIter, class OutIter>
+    inline void batch_mul(InIter a_first, InIter b_first, OutIter c_first, std::size_t limbs, std::size_t count);
+
+    /*!
+     *  Compares a with b for count numbers with limbs limbs each.
+     *  \param out_first random access iterator pointing to count elements, receives -1 if a < b, 0 if a == b and 1 if
+     *  a > b
+     */
+    template <class InIter, class OutIter>
+    inline void batch_compare(InIter a_first, InIter b_first, OutIter out_first, std::size_t limbs,
+                              std::size_t count);
+
+    namespace internal {
+        // applies op(a, b, carry) to Lanes numbers, carry is kept in an array so that it stays in registers
+        template <std::size_t Lanes, class InIter, class OutIter, class CarryIter, class Op>
+        inline void batch_carry_group(InIter a_first, InIter b_first, OutIter c_first, CarryIter carry_first,
+                                      std::size_t limbs, std::size_t stride, Op op)
+        {
+            using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+
+            value_type carry[Lanes]{};
+            for (std::size_t i{0}; i < limbs; ++i) {
+                const auto offset{i * stride};
+                for (std::size_t l{0}; l < Lanes; ++l)
+                    c_first[offset + l] = op(a_first[offset + l], b_first[offset + l], carry[l]);
+            }
+            for (std::size_t l{0}; l < Lanes; ++l)
+                carry_first[l] = carry[l];
+        }
+
+        template <std::size_t Lanes, class InIter, class OutIter>
+        inline void batch_mul_group(InIter a_first, InIter b_first, OutIter c_first, std::size_t limbs,
+                                    std::size_t stride)
+        {
+            using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+
+            for (std::size_t i{0}; i < limbs; ++i)
+                for (std::size_t l{0}; l < Lanes; ++l)
+                    c_first[i * stride + l] = 0;
+
+            // row by row like naive_mul, the products beyond limbs are discarded
+            for (std::size_t i{0}; i < limbs; ++i) {
+                value_type carry[Lanes]{};
+                for (std::size_t j{0}; i + j < limbs; ++j) {
+                    const auto a_offset{i * stride}, b_offset{j * stride}, c_offset{(i + j) * stride};
+                    for (std::size_t l{0}; l < Lanes; ++l) {
+                        auto n{base_mul<value_type>(a_first[a_offset + l], b_first[b_offset + l])};
+                        n[0] = static_cast<value_type>(n[0] + carry[l]);
+                        n[1] = static_cast<value_type>(n[1] + (n[0] < carry[l]));
+                        const auto c{static_cast<value_type>(c_first[c_offset + l] + n[0])};
+                        c_first[c_offset + l] = c;
+                        carry[l] = static_cast<value_type>(n[1] + (c < n[0]));
+                    }
+                }
+            }
+        }
+
+        template <std::size_t Lanes, class InIter, class OutIter>
+        inline void batch_compare_group(InIter a_first, InIter b_first, OutIter out_first, std::size_t limbs,
+                                        std::size_t stride)
+        {
+            int res[Lanes]{};
+            // from the most significant limb, the first difference decides
+            for (std::size_t i{limbs}; i-- > 0;) {
+                const auto offset{i * stride};
+                for (std::size_t l{0}; l < Lanes; ++l) {
+                    const auto a{a_first[offset + l]}, b{b_first[offset + l]};
+                    const int cmp{static_cast<int>(a > b) - static_cast<int>(a < b)};
+                    res[l] = res[l] != 0 ? res[l] : cmp;
+                }
+            }
+            for (std::size_t l{0}; l < Lanes; ++l)
+                out_first[l] = res[l];
+        }
+    } // namespace internal
+
+    template <class InIter, class OutIter, class CarryIter>
+    inline void batch_add(InIter a_first, InIter b_first, OutIter c_first, CarryIter carry_first, std::size_t limbs,
+                          std::size_t count)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        const auto op = [](value_type a, value_type b, value_type& carry) { return add_carry(a, b, carry); };
+
+        std::size_t j{0};
+        for (; j + batch_lanes <= count; j += batch_lanes)
+            internal::batch_carry_group<batch_lanes>(a_first + j, b_first + j, c_first + j, carry_first + j, limbs,
+                                                     count, op);
+        for (; j < count; ++j)
+            internal::batch_carry_group<1>(a_first + j, b_first + j, c_first + j, carry_first + j, limbs, count, op);
+    }
+
+    template <class InIter, class OutIter, class CarryIter>
+    inline void batch_sub(InIter a_first, InIter b_first, OutIter c_first, CarryIter carry_first, std::size_t limbs,
+                          std::size_t count)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        const auto op = [](value_type a, value_type b, value_type& borrow) { return sub_borrow(a, b, borrow); };
+
+        std::size_t j{0};
+        for (; j + batch_lanes <= count; j += batch_lanes)
+            internal::batch_carry_group<batch_lanes>(a_first + j, b_first + j, c_first + j, carry_first + j, limbs,
+                                                     count, op);
+        for (; j < count; ++j)
+            internal::batch_carry_group<1>(a_first + j, b_first + j, c_first + j, carry_first + j, limbs, count, op);
+    }
+
+    template <class InIter, class OutIter>
+    inline void batch_mul(InIter a_first, InIter b_first, OutIter c_first, std::size_t limbs, std::size_t count)
+    {
+        std::size_t j{0};
+        for (; j + batch_lanes <= count; j += batch_lanes)
+            internal::batch_mul_group<batch_lanes>(a_first + j, b_first + j, c_first + j, limbs, count);
+        for (; j < count; ++j)
+            internal::batch_mul_group<1>(a_first + j, b_first + j, c_first + j, limbs, count);
+    }
+
+    template <class InIter, class OutIter>
+    inline void batch_compare(InIter a_first, InIter b_first, OutIter out_first, std::size_t limbs,
+                              std::size_t count)
+    {
+        std::size_t j{0};
+        for (; j + batch_lanes <= count; j += batch_lanes)
+            internal::batch_compare_group<batch_lanes>(a_first + j, b_first + j, out_first + j, limbs, count);
+        for (; j < count; ++j)
+            internal::batch_compare_group<1>(a_first + j, b_first + j, out_first + j, limbs, count);
+    }
+} // namespace xenonis::algorithms
@@ -0,0 +1,250 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file bitwise.hpp
+ *  Implements the bit shifts and bitwise algorithms used in bigint.hpp
+ */
+#pragma once
+
+#include "../integer_traits.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+namespace xenonis::algorithms {
+    /*!
+     *  Shifts a to the left by shift bits and writes the result to c. Requires 0 < shift < bits of a limb and
+     *  c.size() >= a.size(). It is possible that c is a or that c starts after a (the limbs are processed from the
+     *  most significant one).
+     *  \param a_first iterator pointing to the first element of a. Could be const iterator.
+     *  \param a_last iterator pointing to the last element of a. Could be const iterator.
+     *  \param c_first iterator pointing to the first element of c.
+     *  \param shift the number of bits to shift
+     *  \returns the bits shifted out of the most significant limb
+     */
+    template <class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM inline auto lshift_bits(InIter a_first, InIter a_last, OutIter c_first, unsigned shift);
+
+    /*!
+     *  Shifts a to the right by shift bits and writes the result to c. Requires 0 < shift < bits of a limb and
+     *  c.size() >= a.size(). It is possible that c is a or that c starts before a (the limbs are processed from the
+     *  least significant one).
+     *  \param a_first iterator pointing to the first element of a. Could be const iterator.
+     *  \param a_last iterator pointing to the last element of a. Could be const iterator.
+     *  \param c_first iterator pointing to the first element of c.
+     *  \param shift the number of bits to shift
+     *  \returns the bits shifted out of the least significant limb, stored in the upper bits of the limb
+     */
+    template <class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM inline auto rshift_bits(InIter a_first, InIter a_last, OutIter c_first, unsigned shift);
+
+    /*!
+     *  Applies op limb by limb to a and b using two's complement semantics for negative numbers, a and b are given as
+     *  sign and magnitude. The result is written as sign and magnitude to c. Requires c.size() > max(a.size(),
+     *  b.size()). c must be neither a nor b.
+     *  \param op binary function which is applied to both the limbs and the signs
+     *  \returns the sign of the result
+     */
+    template <class InIter, class OutIter, class Op>
+    constexpr bool bitwise(InIter a_first, InIter a_last, bool a_sign, InIter b_first, InIter b_last, bool b_sign,
+                           OutIter c_first, OutIter c_last, Op op);
+
+    /*!
+     *  Counts the leading zero bits of a limb. Requires n != 0.
+     */
+    template <typename Value> constexpr inline unsigned count_leading_zeros(Value n) noexcept;
+
+    /*!
+     *  Counts the trailing zero bits of a limb. Requires n != 0.
+     */
+    template <typename Value> constexpr inline unsigned count_trailing_zeros(Value n) noexcept;
+
+    /*!
+     *  Counts the set bits of a limb.
+     */
+    template <typename Value> constexpr inline unsigned popcount(Value n) noexcept;
+
+    template <class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM inline auto lshift_bits(InIter a_first, InIter a_last, OutIter c_first, unsigned shift)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+#if defined(XENONIS_INLINE_ASM_AMD64)
+        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED()) {
+                std::uint64_t out{0}, size{static_cast<std::uint64_t>(std::distance(a_first, a_last))};
+                asm volatile(R"(
+                    movq -8(%[a], %[size], 8), %%r8     # r8 = a[size - 1]
+                    xorq %[out], %[out]
+                    shldq %%cl, %%r8, %[out]
+                    decq %[size]
+                    jz %=2f
+                %=1:
+                    movq -8(%[a], %[size], 8), %%r9
+                    shldq %%cl, %%r9, %%r8
+                    movq %%r8, (%[c], %[size], 8)
+                    movq %%r9, %%r8
+                    decq %[size]
+                    jnz %=1b
+                %=2:
+                    shlq %%cl, %%r8
+                    movq %%r8, (%[c])
+                )"
+                             : [out] "=&r"(out), [size] "+r"(size)
+                             : [a] "r"(&*a_first), [c] "r"(&*c_first), "c"(shift)
+                             : "r8", "r9", "cc", "memory");
+                return out;
+            }
+        }
+#endif
+        auto size{std::distance(a_first, a_last)};
+        value_type high{a_first[size - 1]};
+        const auto out{static_cast<value_type>(high >> (bits - shift))};
+        for (--size; size > 0; --size) {
+            const value_type low{a_first[size - 1]};
+            c_first[size] = static_cast<value_type>((high << shift) | (low >> (bits - shift)));
+            high = low;
+        }
+        *c_first = static_cast<value_type>(high << shift);
+        return out;
+    }
+
+    template <class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM inline auto rshift_bits(InIter a_first, InIter a_last, OutIter c_first, unsigned shift)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+#if defined(XENONIS_INLINE_ASM_AMD64)
+        if constexpr (std::is_same_v<value_type, std::uint64_t>) {
+            if (!XENONIS_IS_CONSTANT_EVALUATED()) {
+                std::uint64_t out{0}, size{static_cast<std::uint64_t>(std::distance(a_first, a_last))};
+                asm volatile(R"(
+                    movq (%[a]), %%r8                   # r8 = a[0]
+                    xorq %[out], %[out]
+                    shrdq %%cl, %%r8, %[out]
+                    xorq %%r10, %%r10
+                    decq %[size]
+                    jz %=2f
+                %=1:
+                    movq 8(%[a], %%r10, 8), %%r9
+                    shrdq %%cl, %%r9, %%r8
+                    movq %%r8, (%[c], %%r10, 8)
+                    movq %%r9, %%r8
+                    incq %%r10
+                    decq %[size]
+                    jnz %=1b
+                %=2:
+                    shrq %%cl, %%r8
+                    movq %%r8, (%[c], %%r10, 8)
+                )"
+                             : [out] "=&r"(out), [size] "+r"(size)
+                             : [a] "r"(&*a_first), [c] "r"(&*c_first), "c"(shift)
+                             : "r8", "r9", "r10", "cc", "memory");
+                return out;
+            }
+        }
+#endif
+        value_type low{*a_first};
+        const auto out{static_cast<value_type>(low << (bits - shift))};
+        for (++a_first; a_first != a_last; ++a_first, ++c_first) {
+            const value_type high{*a_first};
+            *c_first = static_cast<value_type>((low >> shift) | (high << (bits - shift)));
+            low = high;
+        }
+        *c_first = static_cast<value_type>(low >> shift);
+        return out;
+    }
+
+    template <class InIter, class OutIter, class Op>
+    constexpr bool bitwise(InIter a_first, InIter a_last, bool a_sign, InIter b_first, InIter b_last, bool b_sign,
+                           OutIter c_first, OutIter c_last, Op op)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        constexpr value_type ones{std::numeric_limits<value_type>::max()};
+
+        // negative numbers are converted on the fly: -x = ~x + 1, the carry of the + 1 is propagated through the
+        // limbs, beyond the last limb a negative number is sign extended with ones
+        const auto twos_complement = [ones](auto& first, const auto last, bool sign, bool& carry) -> value_type {
+            if (first == last)
+                return sign ? ones : 0;
+
+            const value_type n{*(first++)};
+            if (!sign)
+                return n;
+
+            const auto ret{static_cast<value_type>(static_cast<value_type>(~n) + carry)};
+            carry = carry && n == 0;
+            return ret;
+        };
+
+        const bool c_sign{static_cast<bool>(op(a_sign, b_sign))};
+        bool a_carry{true}, b_carry{true}, c_carry{true};
+
+        for (; c_first != c_last; ++c_first) {
+            const auto n{static_cast<value_type>(op(twos_complement(a_first, a_last, a_sign, a_carry),
+                                                    twos_complement(b_first, b_last, b_sign, b_carry)))};
+            if (c_sign) { // convert back to the magnitude: |c| = ~c + 1
+                *c_first = static_cast<value_type>(static_cast<value_type>(~n) + c_carry);
+                c_carry = c_carry && n == 0;
+            } else {
+                *c_first = n;
+            }
+        }
+
+        return c_sign;
+    }
+
+    template <typename Value> constexpr inline unsigned count_leading_zeros(Value n) noexcept
+    {
+        constexpr unsigned bits{std::numeric_limits<Value>::digits};
+#if defined(__GNUC__)
+        if constexpr (bits <= std::numeric_limits<unsigned int>::digits)
+            return static_cast<unsigned>(__builtin_clz(n)) - (std::numeric_limits<unsigned int>::digits - bits);
+        else
+            return static_cast<unsigned>(__builtin_clzll(n));
+#else
+        unsigned ret{0};
+        for (Value mask{static_cast<Value>(Value{1} << (bits - 1))}; (n & mask) == 0; mask >>= 1)
+            ++ret;
+        return ret;
+#endif
+    }
+
+    template <typename Value> constexpr inline unsigned count_trailing_zeros(Value n) noexcept
+    {
+#if defined(__GNUC__)
+        if constexpr (std::numeric_limits<Value>::digits <= std::numeric_limits<unsigned int>::digits)
+            return static_cast<unsigned>(__builtin_ctz(n));
+        else
+            return static_cast<unsigned>(__builtin_ctzll(n));
+#else
+        unsigned ret{0};
+        for (; (n & 1) == 0; n >>= 1)
+            ++ret;
+        return ret;
+#endif
+    }
+
+    template <typename Value> constexpr inline unsigned popcount(Value n) noexcept
+    {
+#if defined(__GNUC__)
+        if constexpr (std::numeric_limits<Value>::digits <= std::numeric_limits<unsigned int>::digits)
+            return static_cast<unsigned>(__builtin_popcount(n));
+        else
+            return static_cast<unsigned>(__builtin_popcountll(n));
+#else
+        unsigned ret{0};
+        for (; n != 0; n &= n - 1)
+            ++ret;
+        return ret;
+#endif
+    }
+} // namespace xenonis::algorithms
@@ -13,18 +13,28 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 
 namespace xenonis::algorithms {
     template <typename Value, class InContainer>
-    std::string to_string(const InContainer& a, bool is_signed, bool lower_case = true);
+    XENONIS_CONSTEXPR std::string to_string(const InContainer& a, bool is_signed, bool lower_case = true);
 
-    template <typename Value, class OutContainer> OutContainer from_string(const std::string_view str);
+    template <typename Value, class OutContainer>
+    XENONIS_CONSTEXPR OutContainer from_string(const std::string_view str);
 
+    /*!
+     *  Converts a to a decimal string.
+     *  \details Divides a copy of a repeatedly by the largest power of ten which fits into a limb, every division yields
+     *  the next digits, starting with the least significant ones. Complexity: O(n^2)
+     */
     template <typename Value, class InContainer>
-    std::string to_string(const InContainer& data, bool is_signed, bool lower_case)
+    XENONIS_CONSTEXPR std::string to_decimal_string(const InContainer& a, bool is_signed);
+
+    template <typename Value, class InContainer>
+    XENONIS_CONSTEXPR std::string to_string(const InContainer& data, bool is_signed, bool lower_case)
     {
         using size_type = decltype(data.size());
         std::string ret(data.size() * sizeof(Value) * 2, '\0');
@@ -35,11 +45,10 @@ namespace xenonis::algorithms {
 
         size_type i_ret{0};
         std::for_each(data.cbegin(), data.cend(), [&ret, &i_ret](Value n) {
-            auto* n_ptr{reinterpret_cast<std::uint8_t*>(&n)};
-
             for (size_type i{0}; i < sizeof(Value); ++i) {
-                ret[i_ret++] = static_cast<char>(mask1 & n_ptr[i]);
-                ret[i_ret++] = static_cast<char>((mask0 & n_ptr[i]) >> 4);
+                const auto byte{static_cast<std::uint8_t>(n >> (i * 8))};
+                ret[i_ret++] = static_cast<char>(mask1 & byte);
+                ret[i_ret++] = static_cast<char>((mask0 & byte) >> 4);
             }
         });
 
@@ -65,7 +74,51 @@ namespace xenonis::algorithms {
         return ret;
     }
 
-    template <typename Value, class OutContainer> OutContainer from_string(const std::string_view str)
+    template <typename Value, class InContainer>
+    XENONIS_CONSTEXPR std::string to_decimal_string(const InContainer& a, bool is_signed)
+    {
+        using doubled = typename traits::uinteger<Value>::doubled;
+        constexpr unsigned bits{std::numeric_limits<Value>::digits};
+
+        // 10^chunk_digits is the largest power of ten which fits into a limb
+        constexpr unsigned chunk_digits{std::numeric_limits<Value>::digits10};
+        constexpr Value chunk{[] {
+            Value ret{1};
+            for (unsigned i{0}; i < chunk_digits; ++i)
+                ret *= 10;
+            return ret;
+        }()};
+
+        InContainer n(a);
+        remove_zeros(n);
+        std::string ret;
+        while (!n.empty() && (n.size() > 1 || n.front() != 0)) {
+            doubled r{0};
+            for (auto i{n.size()}; i-- > 0;) {
+                const auto x{static_cast<doubled>((r << bits) | n[i])};
+                n[i] = static_cast<Value>(x / chunk);
+                r = x % chunk;
+            }
+            remove_zeros(n);
+
+            // the digits of the most significant chunk are not padded with zeros
+            const bool last{n.size() == 1 && n.front() == 0};
+            for (unsigned i{0}; i < chunk_digits && (!last || r != 0); ++i) {
+                ret += static_cast<char>('0' + r % 10);
+                r /= 10;
+            }
+        }
+
+        if (ret.empty())
+            ret = "0";
+        if (is_signed)
+            ret += '-';
+        std::reverse(ret.begin(), ret.end());
+
+        return ret;
+    }
+
+    template <typename Value, class OutContainer> XENONIS_CONSTEXPR OutContainer from_string(const std::string_view str)
     {
         auto conv = [](auto c) {
             if (c >= 48 && c <= 57)
@@ -98,7 +151,8 @@ namespace xenonis::algorithms {
         return ret;
     }
 
-    template <typename OutValue, typename InValue, class OutContainer> OutContainer from_uint(InValue n)
+    template <typename OutValue, typename InValue, class OutContainer>
+    XENONIS_CONSTEXPR OutContainer from_uint(InValue n)
     {
         if constexpr (sizeof(OutValue) >= sizeof(InValue)) {
             return OutContainer(1, n);
@@ -108,15 +162,17 @@ namespace xenonis::algorithms {
             auto mask{static_cast<InValue>(std::numeric_limits<OutValue>::max())};
 
             for (std::size_t i{0}; i < out.size(); ++i) {
-                out[i] = (n & mask) >> (i * 8);
+                out[i] = static_cast<OutValue>((n & mask) >> (i * sizeof(OutValue) * 8));
                 mask <<= sizeof(OutValue) * 8;
             }
 
+            remove_zeros(out);
             return out;
         }
     }
 
-    template <typename OutValue, typename InValue, class OutContainer> std::pair<bool, OutContainer> from_int(InValue n)
+    template <typename OutValue, typename InValue, class OutContainer>
+    XENONIS_CONSTEXPR std::pair<bool, OutContainer> from_int(InValue n)
     {
         using unsigned_type = typename traits::integer<InValue>::unsigned_type;
         if (n < 0) {
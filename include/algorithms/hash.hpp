@@ -0,0 +1,95 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file hash.hpp
+ *  Implements the hash of the limbs used by std::hash<bigint>
+ */
+#pragma once
+
+#include "bigint_config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+namespace xenonis::algorithms {
+    namespace internal {
+        // the constants of wyhash
+        constexpr std::uint64_t hash_secret[5]{0xa0761d6478bd642f, 0xe7037ed1a0b428db, 0x8ebc6af09c88c6e3,
+                                               0x589965cc75374cc3, 0x1d8e4e27c47d124f};
+
+        // the 128-bit product a * b, the upper half is xored into the lower one
+        constexpr std::uint64_t fold_mul(std::uint64_t a, std::uint64_t b) noexcept
+        {
+#ifdef XENONIS_USE_UINT128
+            const auto p{static_cast<uint128_t>(a) * b};
+            return static_cast<std::uint64_t>(p) ^ static_cast<std::uint64_t>(p >> 64);
+#else
+            const std::uint64_t a_l{a & 0xffffffff}, a_h{a >> 32};
+            const std::uint64_t b_l{b & 0xffffffff}, b_h{b >> 32};
+            const auto ll{a_l * b_l};
+            const auto lh{a_l * b_h};
+            const auto hl{a_h * b_l};
+            const auto mid{(ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff)};
+            const auto lo{(mid << 32) | (ll & 0xffffffff)};
+            const auto hi{a_h * b_h + (lh >> 32) + (hl >> 32) + (mid >> 32)};
+            return lo ^ hi;
+#endif
+        }
+    } // namespace internal
+
+    /*!
+     *  Hashes the magnitude first..last (the least significant limb first, without leading zero limbs) and the sign.
+     *  \details The limbs are combined into 64-bit words, so a number has the same hash for all limb widths, an empty
+     *  range is hashed like zero. Pairs of words are mixed with a 64 x 64 -> 128 bit multiplication like in wyhash;
+     *  four independent lanes consume 64 bytes per iteration, so the multiplications overlap. The hash is fast, but
+     *  not resistant to hash flooding with chosen numbers.
+     */
+    template <class InIter>
+    constexpr std::uint64_t hash(InIter first, InIter last, bool sign) noexcept
+    {
+        using value_type = typename std::iterator_traits<InIter>::value_type;
+        constexpr unsigned value_bits{std::numeric_limits<value_type>::digits};
+        constexpr std::size_t limbs_per_word{value_bits >= 64 ? 1 : 64 / value_bits};
+        static_assert(value_bits <= 64 && 64 % value_bits == 0, "Not supported!");
+
+        const auto limbs{static_cast<std::size_t>(std::distance(first, last))};
+        const auto words{limbs == 0 ? 1 : (limbs + limbs_per_word - 1) / limbs_per_word};
+
+        // the i-th word, zero above the number
+        const auto word = [first, limbs](std::size_t i) {
+            std::uint64_t ret{0};
+            if constexpr (limbs_per_word == 1) {
+                if (i < limbs)
+                    ret = static_cast<std::uint64_t>(first[i]);
+            } else {
+                for (std::size_t j{0}; j < limbs_per_word && i * limbs_per_word + j < limbs; ++j)
+                    ret |= static_cast<std::uint64_t>(first[i * limbs_per_word + j]) << (j * value_bits);
+            }
+            return ret;
+        };
+
+        std::uint64_t lanes[4]{internal::hash_secret[0], internal::hash_secret[1], internal::hash_secret[2],
+                               internal::hash_secret[3]};
+        std::size_t i{0};
+        for (; i + 8 <= words; i += 8) {
+            for (std::size_t lane{0}; lane < 4; ++lane)
+                lanes[lane] = internal::fold_mul(word(i + 2 * lane) ^ internal::hash_secret[lane],
+                                                 word(i + 2 * lane + 1) ^ lanes[lane]);
+        }
+        // the remaining pairs continue the round robin, a missing last word is zero
+        for (std::size_t lane{0}; i < words; i += 2, ++lane)
+            lanes[lane] = internal::fold_mul(word(i) ^ internal::hash_secret[lane], word(i + 1) ^ lanes[lane]);
+
+        const auto h{internal::fold_mul(lanes[0] ^ internal::hash_secret[4], lanes[1]) ^
+                     internal::fold_mul(lanes[2] ^ internal::hash_secret[4], lanes[3])};
+        return internal::fold_mul(h ^ internal::hash_secret[0],
+                                  ((static_cast<std::uint64_t>(words) << 1) | sign) ^ internal::hash_secret[1]);
+    }
+} // namespace xenonis::algorithms
@@ -0,0 +1,416 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file modular.hpp
+ *  Implements the modular arithmetic (Montgomery reduction and exponentiation) used in bigint.hpp
+ */
+#pragma once
+
+#include "arithmetic.hpp"
+#include "compare.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace xenonis::algorithms {
+    /*!
+     *  Calculates a mod d for a small divisor d.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param d the divisor, must not be 0
+     *  \returns the remainder
+     */
+    template <class InIter> constexpr std::uint32_t mod_small(InIter a_first, InIter a_last, std::uint32_t d) noexcept;
+
+    /*!
+     *  \returns -m^(-1) mod base, m has to be odd
+     */
+    template <typename Value> constexpr Value montgomery_inverse(Value m) noexcept;
+
+    /*!
+     *  Montgomery reduction: writes t * base^(-n) mod m to out, n is the size of m.
+     *  \details t has to have 2 * n limbs and has to be less than m * base^n, it is overwritten. Complexity: O(n^2)
+     *  \param t_first iterator pointing to the first element of t.
+     *  \param m_first iterator pointing to the first element of m.
+     *  \param m_last iterator pointing to the last element of m.
+     *  \param m_inv -m^(-1) mod base, see montgomery_inverse
+     *  \param out_first iterator pointing to the first element of out, which has n limbs and must not overlap t.
+     */
+    template <class InOutIter, class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM void montgomery_redc(InOutIter t_first, InIter m_first, InIter m_last, Value m_inv,
+                                               OutIter out_first);
+
+    /*!
+     *  \returns -m^(-1) mod base^n with n limbs, n is the size of m, which has to be odd
+     *  \details Newton's iteration x = x + x * (1 - m * x) doubles the number of correct limbs in every step, the
+     *  products are calculated using mullo.
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer montgomery_inverse_n(InIter m_first, InIter m_last);
+
+    /*!
+     *  Montgomery reduction using products: writes t * base^(-n) mod m to out, n is the size of m.
+     *  \details u = t * (-m^(-1)) mod base^n is calculated using mullo and t + u * m using karatsuba_mul, the sum is
+     *  divisible by base^n. This replaces the n passes over m of montgomery_redc for large m. t has to have 2 * n limbs
+     *  and has to be less than m * base^n.
+     *  \param t_first iterator pointing to the first element of t.
+     *  \param m_first iterator pointing to the first element of m.
+     *  \param m_last iterator pointing to the last element of m.
+     *  \param m_inv_first iterator pointing to the first element of -m^(-1) mod base^n, see montgomery_inverse_n
+     *  \param out_first iterator pointing to the first element of out, which has n limbs and must not overlap t.
+     */
+    template <class OutContainer, class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM void montgomery_redc_mul(InIter t_first, InIter m_first, InIter m_last, InIter m_inv_first,
+                                                   OutIter out_first);
+
+    /*!
+     *  Calculates a^e mod m and returns the result.
+     *  \details Uses the Montgomery multiplication and a sliding window over the bits of e, the window size grows
+     *  with the size of e. Requires m to be odd and a < m.
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param e_first iterator pointing to the first element of e.
+     *  \param e_last iterator pointing to the last element of e.
+     *  \param m_first iterator pointing to the first element of m.
+     *  \param m_last iterator pointing to the last element of m.
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer powmod(InIter a_first, InIter a_last, InIter e_first, InIter e_last,
+                                              InIter m_first, InIter m_last);
+
+    /*!
+     *  Calculates the greatest common divisor of a and b and returns it, gcd(0, 0) is 0.
+     *  \details Lehmer's algorithm: the Euclidean algorithm is run on the leading bits of a and b (at most 62 bits)
+     *  as long as the quotients are certain to be the ones of the full numbers. The collected cofactors are then
+     *  applied to a and b at once using addmul_1 and submul_1, so every pass over the limbs replaces about 30 steps of
+     *  the Euclidean algorithm. A division is used if the quotient is too large. Complexity: O(n^2)
+     *  \param a_first iterator pointing to the first element of a.
+     *  \param a_last iterator pointing to the last element of a.
+     *  \param b_first iterator pointing to the first element of b.
+     *  \param b_last iterator pointing to the last element of b.
+     *  \returns the result
+     */
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer gcd(InIter a_first, InIter a_last, InIter b_first, InIter b_last);
+
+    template <class InIter> constexpr std::uint32_t mod_small(InIter a_first, InIter a_last, std::uint32_t d) noexcept
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+        // the limbs are processed in chunks of at most 32 bits, so that the remainder fits into 64 bits
+        constexpr unsigned chunk_bits{bits < 32 ? bits : 32};
+
+        std::uint64_t r{0};
+        for (auto first{std::make_reverse_iterator(a_last)}; first != std::make_reverse_iterator(a_first); ++first) {
+            for (auto shift{bits}; shift != 0;) {
+                shift -= chunk_bits;
+                const auto chunk{static_cast<std::uint64_t>(*first >> shift) &
+                                 (std::uint64_t{0xffffffff} >> (32 - chunk_bits))};
+                r = ((r << chunk_bits) | chunk) % d;
+            }
+        }
+        return static_cast<std::uint32_t>(r);
+    }
+
+    template <typename Value> constexpr Value montgomery_inverse(Value m) noexcept
+    {
+        // Newton iteration x = x * (2 - m * x), m * m == 1 mod 8, so m is the inverse of itself modulo 2^3 and every
+        // step doubles the number of correct bits
+        Value x{m};
+        for (unsigned correct{3}; correct < std::numeric_limits<Value>::digits; correct *= 2)
+            x = static_cast<Value>(x * static_cast<Value>(2 - static_cast<Value>(m * x)));
+        return static_cast<Value>(0 - x);
+    }
+
+    template <class InOutIter, class InIter, class OutIter, typename Value>
+    XENONIS_CONSTEXPR_ASM void montgomery_redc(InOutIter t_first, InIter m_first, InIter m_last, Value m_inv,
+                                               OutIter out_first)
+    {
+        const auto n{std::distance(m_first, m_last)};
+
+        // every step clears the limb t[i] by adding a multiple of m * base^i, the carry which belongs to t[i + n] is
+        // stored in the cleared limb and all carries are added at once in the end
+        for (std::ptrdiff_t i{0}; i < n; ++i) {
+            const auto u{static_cast<Value>(t_first[i] * m_inv)};
+            t_first[i] = addmul_1(m_first, m_last, u, t_first + i);
+        }
+
+        // the result is less than 2 * m
+        if (add(t_first + n, t_first, t_first + n, out_first) ||
+            !std::lexicographical_compare(std::make_reverse_iterator(out_first + n),
+                                          std::make_reverse_iterator(out_first), std::make_reverse_iterator(m_last),
+                                          std::make_reverse_iterator(m_first)))
+            sub_from(out_first, m_first, m_last);
+    }
+
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer montgomery_inverse_n(InIter m_first, InIter m_last)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*m_first)>>;
+        const auto n{static_cast<std::size_t>(std::distance(m_first, m_last))};
+
+        // x = m^(-1) mod base^k
+        OutContainer x(1, static_cast<value_type>(0 - montgomery_inverse<value_type>(*m_first)));
+        for (std::size_t k{1}; k < n;) {
+            const auto next{std::min(2 * k, n)};
+
+            // m * x = 1 + d * base^k mod base^next, so x - x * d * base^k is the inverse modulo base^next
+            const auto e{internal::mullo_unnormalized<OutContainer, InIter, karatsuba_threshold>(
+                m_first, m_first + next, x.cbegin(), x.cend(), next)};
+            const auto d{internal::mullo_unnormalized<OutContainer, InIter, karatsuba_threshold>(
+                x.cbegin(), x.cend(), e.cbegin() + k, e.cend(), next - k)};
+            x.resize(next);
+            std::transform(d.cbegin(), d.cend(), x.begin() + k, [](value_type v) { return static_cast<value_type>(~v); });
+            increment(x.begin() + k, x.end());
+            k = next;
+        }
+
+        // -x
+        std::transform(x.cbegin(), x.cend(), x.begin(), [](value_type v) { return static_cast<value_type>(~v); });
+        increment(x.begin(), x.end());
+        return x;
+    }
+
+    template <class OutContainer, class InIter, class OutIter>
+    XENONIS_CONSTEXPR_ASM void montgomery_redc_mul(InIter t_first, InIter m_first, InIter m_last, InIter m_inv_first,
+                                                   OutIter out_first)
+    {
+        const auto n{static_cast<std::size_t>(std::distance(m_first, m_last))};
+
+        const auto u{internal::mullo_unnormalized<OutContainer, InIter, karatsuba_threshold>(
+            t_first, t_first + n, m_inv_first, m_inv_first + n, n)};
+        // u * m is extended to 2 * n limbs, so that its high half can be added limb by limb
+        auto um{internal::karatsuba_mul_unnormalized<OutContainer, InIter, karatsuba_threshold>(u.cbegin(), u.cend(),
+                                                                                                m_first, m_last)};
+        um.resize(2 * n, 0);
+
+        // the low half of t + u * m is zero, it carries into the high half unless the low half of t is zero
+        bool carry{add(t_first + n, um.cbegin() + n, um.cend(), out_first)};
+        if (!is_zero(t_first, t_first + n))
+            carry = increment(out_first, out_first + n) || carry;
+
+        // the result is less than 2 * m
+        if (carry || !std::lexicographical_compare(std::make_reverse_iterator(out_first + n),
+                                                   std::make_reverse_iterator(out_first),
+                                                   std::make_reverse_iterator(m_last),
+                                                   std::make_reverse_iterator(m_first)))
+            sub_from(out_first, m_first, m_last);
+    }
+
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer powmod(InIter a_first, InIter a_last, InIter e_first, InIter e_last,
+                                              InIter m_first, InIter m_last)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*m_first)>>;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+
+        const auto n{static_cast<std::size_t>(std::distance(m_first, m_last))};
+        const auto a_size{static_cast<std::size_t>(std::distance(a_first, a_last))};
+        OutContainer m(n);
+        std::copy(m_first, m_last, m.begin());
+        const auto m_inv{montgomery_inverse<value_type>(m.front())};
+
+        // x * base^n mod m, the residues are kept at n limbs
+        const auto to_montgomery = [&](const OutContainer& x) {
+            auto ret{divmod<OutContainer>(x.cbegin(), x.cend(), m.cbegin(), m.cend()).second};
+            ret.resize(n, 0);
+            return ret;
+        };
+
+        OutContainer shifted(n + a_size, 0);
+        std::copy(a_first, a_last, shifted.begin() + n);
+        const auto a_mont{to_montgomery(shifted)};
+        OutContainer one(n + 1, 0);
+        one.back() = 1;
+        auto x{to_montgomery(one)};
+
+        // above the Karatsuba threshold the reduction uses products as well
+        const auto m_inv_n{n > karatsuba_threshold ? montgomery_inverse_n<OutContainer>(m.cbegin(), m.cend())
+                                                   : OutContainer(1, 0)};
+
+        // out = a * b * base^(-n) mod m, out may be a or b
+        OutContainer t(2 * n);
+        const auto mul = [&](auto a, auto b, auto out) {
+            if (n > karatsuba_threshold) {
+                // montgomery_redc_mul reads 2 * n limbs
+                auto product{internal::karatsuba_mul_unnormalized<OutContainer, decltype(a), karatsuba_threshold>(
+                    a, a + n, b, b + n)};
+                product.resize(2 * n, 0);
+                montgomery_redc_mul<OutContainer>(product.cbegin(), m.cbegin(), m.cend(), m_inv_n.cbegin(), out);
+            } else {
+                std::fill(t.begin(), t.end(), 0);
+                naive_mul(a, a + n, b, b + n, t.begin());
+                montgomery_redc(t.begin(), m.cbegin(), m.cend(), m_inv, out);
+            }
+        };
+
+        auto e_size{static_cast<std::size_t>(std::distance(e_first, e_last))};
+        while (e_size != 0 && e_first[e_size - 1] == 0)
+            --e_size;
+        const std::size_t e_bits{e_size == 0 ? 0 : e_size * bits - count_leading_zeros(e_first[e_size - 1])};
+
+        const auto bit = [&](std::size_t i) { return ((e_first[i / bits] >> (i % bits)) & 1) != 0; };
+
+        // the window sizes of OpenSSL (BN_window_bits_for_exponent_size)
+        const unsigned window{e_bits > 671 ? 6u : e_bits > 239 ? 5u : e_bits > 79 ? 4u : e_bits > 23 ? 3u : 1u};
+
+        // table[i] = a^(2 * i + 1)
+        OutContainer table(n << (window - 1));
+        std::copy(a_mont.cbegin(), a_mont.cend(), table.begin());
+        if (window > 1) {
+            OutContainer a_square(n);
+            mul(a_mont.cbegin(), a_mont.cbegin(), a_square.begin());
+            for (std::size_t i{1}; i < (std::size_t{1} << (window - 1)); ++i)
+                mul(table.cbegin() + (i - 1) * n, a_square.cbegin(), table.begin() + i * n);
+        }
+
+        bool first_window{true};
+        for (auto i{e_bits}; i-- > 0;) {
+            if (!bit(i)) {
+                mul(x.cbegin(), x.cbegin(), x.begin());
+                continue;
+            }
+
+            // the longest window [j, i] of at most window bits which ends with a set bit
+            auto j{i + 1 >= window ? i + 1 - window : 0};
+            while (!bit(j))
+                ++j;
+            std::size_t value{0};
+            for (auto k{i + 1}; k-- > j;)
+                value = (value << 1) | bit(k);
+
+            if (first_window) {
+                std::copy(table.cbegin() + (value >> 1) * n, table.cbegin() + ((value >> 1) + 1) * n, x.begin());
+                first_window = false;
+            } else {
+                for (auto k{j}; k <= i; ++k)
+                    mul(x.cbegin(), x.cbegin(), x.begin());
+                mul(x.cbegin(), table.cbegin() + (value >> 1) * n, x.begin());
+            }
+            i = j;
+        }
+
+        // back from the Montgomery form: x * base^(-n)
+        std::fill(t.begin(), t.end(), 0);
+        std::copy(x.cbegin(), x.cend(), t.begin());
+        OutContainer ret(n);
+        montgomery_redc(t.begin(), m.cbegin(), m.cend(), m_inv, ret.begin());
+        remove_zeros(ret);
+        return ret;
+    }
+
+    template <class OutContainer, class InIter>
+    XENONIS_CONSTEXPR_ASM OutContainer gcd(InIter a_first, InIter a_last, InIter b_first, InIter b_last)
+    {
+        using value_type = std::remove_const_t<std::remove_reference_t<decltype(*a_first)>>;
+        constexpr unsigned bits{std::numeric_limits<value_type>::digits};
+        // the cofactors are less than 2^window, so they fit into a limb and the sums below into std::int64_t
+        constexpr unsigned window{(bits < 64 ? bits : 64) - 2};
+
+        OutContainer x(static_cast<std::size_t>(std::distance(a_first, a_last)));
+        std::copy(a_first, a_last, x.begin());
+        OutContainer y(static_cast<std::size_t>(std::distance(b_first, b_last)));
+        std::copy(b_first, b_last, y.begin());
+        remove_zeros(x);
+        remove_zeros(y);
+        if (less(x, y))
+            std::swap(x, y);
+
+        const auto bit_length = [](const OutContainer& n) {
+            return n.size() * bits - count_leading_zeros(n.back());
+        };
+
+        // the bits [shift, shift + window) of n
+        const auto extract = [](const OutContainer& n, std::size_t shift) {
+            std::uint64_t ret{0};
+            for (auto i{shift / bits}; i < n.size() && i * bits < shift + window; ++i) {
+                if (i * bits >= shift)
+                    ret |= static_cast<std::uint64_t>(n[i]) << (i * bits - shift);
+                else
+                    ret |= static_cast<std::uint64_t>(n[i] >> (shift - i * bits));
+            }
+            return ret & ((std::uint64_t{1} << window) - 1);
+        };
+
+        // out = p * u - q * v, the result has to be non-negative
+        const auto combine = [](const OutContainer& u, value_type p, const OutContainer& v, value_type q,
+                                OutContainer& out) {
+            out.resize(std::max(u.size(), v.size()) + 1);
+            std::fill(out.begin(), out.end(), 0);
+            out[u.size()] = addmul_1(u.cbegin(), u.cend(), p, out.begin());
+            const auto borrow{submul_1(v.cbegin(), v.cend(), q, out.begin())};
+            const auto top{out.begin() + static_cast<std::ptrdiff_t>(v.size())};
+            const auto old{*top};
+            *top = static_cast<value_type>(*top - borrow);
+            if (old < borrow)
+                decrement(top + 1, out.end());
+            remove_zeros(out);
+        };
+
+        OutContainer next_x(1);
+        OutContainer next_y(1);
+        while (!is_zero(y.cbegin(), y.cend())) {
+            if (x.size() == 1) {
+                auto u{x.front()};
+                auto v{y.front()};
+                while (v != 0) {
+                    const auto r{static_cast<value_type>(u % v)};
+                    u = v;
+                    v = r;
+                }
+                x.front() = u;
+                return x;
+            }
+
+            const auto x_bits{bit_length(x)};
+            const auto shift{x_bits > window ? x_bits - window : 0};
+            std::int64_t x_top{static_cast<std::int64_t>(extract(x, shift))};
+            std::int64_t y_top{static_cast<std::int64_t>(extract(y, shift))};
+
+            // the Euclidean algorithm on the leading bits, x_top + A, y_top + C and x_top + B, y_top + D bound the
+            // leading bits of the remainders, a step is only taken if both bounds result in the same quotient
+            std::int64_t a{1}, b{0}, c{0}, d{1};
+            while (y_top + c != 0 && y_top + d != 0) {
+                const auto q{(x_top + a) / (y_top + c)};
+                if (q != (x_top + b) / (y_top + d))
+                    break;
+                a = std::exchange(c, a - q * c);
+                b = std::exchange(d, b - q * d);
+                x_top = std::exchange(y_top, x_top - q * y_top);
+            }
+
+            if (b == 0) {
+                // the quotient is not determined by the leading bits
+                auto r{divmod<OutContainer>(x.cbegin(), x.cend(), y.cbegin(), y.cend()).second};
+                x = std::move(y);
+                y = std::move(r);
+                continue;
+            }
+
+            // x = a * x + b * y, y = c * x + d * y, the cofactors of a row have opposite signs (or one is zero)
+            const auto apply = [&](std::int64_t p, std::int64_t q, OutContainer& out) {
+                if (q <= 0)
+                    combine(x, static_cast<value_type>(p), y, static_cast<value_type>(-q), out);
+                else
+                    combine(y, static_cast<value_type>(q), x, static_cast<value_type>(-p), out);
+            };
+            apply(a, b, next_x);
+            apply(c, d, next_y);
+            std::swap(x, next_x);
+            std::swap(y, next_y);
+        }
+        return x;
+    }
+} // namespace xenonis::algorithms
@@ -0,0 +1,99 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file multimod.hpp
+ *  Implements the residue-wise arithmetic used in multimod.hpp
+ *  \details The residues of a number modulo count moduli m_i < 2^63 are stored contiguously, residue i belongs to
+ *  modulus i. All residues are independent, so the loops are branch free (conditional subtractions are done with
+ *  masks) and the compiler can map them to SIMD registers. The modular multiplication uses the Montgomery
+ *  representation, the moduli have to be odd.
+ */
+#pragma once
+
+#include "arithmetic.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace xenonis::algorithms {
+    /*!
+     *  \returns a * b * 2^(-64) mod m for a, b < m < 2^63, m has to be odd
+     *  \param m_inv -m^(-1) mod 2^64, see montgomery_inverse
+     */
+    constexpr inline std::uint64_t montgomery_mul_1(std::uint64_t a, std::uint64_t b, std::uint64_t m,
+                                                    std::uint64_t m_inv) noexcept;
+
+    /*!
+     *  Writes (a_i + b_i) mod m_i to c for all residues of [a_first, a_last). It is possible that a is c.
+     *  \param a_first random access iterator pointing to the first element of a. Could be const iterator.
+     *  \param a_last random access iterator pointing to the last element of a. Could be const iterator.
+     *  \param b_first random access iterator pointing to the first element of b. Could be const iterator.
+     *  \param m_first random access iterator pointing to the first modulus. Could be const iterator.
+     *  \param c_first random access iterator pointing to the first element of c.
+     */
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_add(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, OutIter c_first) noexcept;
+
+    /*!
+     *  Writes (a_i - b_i) mod m_i to c for all residues of [a_first, a_last). It is possible that a is c.
+     */
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_sub(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, OutIter c_first) noexcept;
+
+    /*!
+     *  Writes a_i * b_i * 2^(-64) mod m_i to c for all residues of [a_first, a_last). It is possible that a is c.
+     *  \param inv_first random access iterator pointing to -m_i^(-1) mod 2^64 for all moduli
+     */
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_mul(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, ModIter inv_first,
+                             OutIter c_first) noexcept;
+
+    namespace internal {
+        // x mod m for x < 2 * m
+        constexpr inline std::uint64_t reduce_once(std::uint64_t x, std::uint64_t m) noexcept
+        {
+            return x - (m & (0 - static_cast<std::uint64_t>(x >= m)));
+        }
+    } // namespace internal
+
+    constexpr inline std::uint64_t montgomery_mul_1(std::uint64_t a, std::uint64_t b, std::uint64_t m,
+                                                    std::uint64_t m_inv) noexcept
+    {
+        // t + u * m < m^2 + 2^64 * m < 2^128, the lower halves cancel out, so there is a carry unless t[0] == 0
+        const auto t{base_mul(a, b)};
+        const auto um{base_mul(static_cast<std::uint64_t>(t[0] * m_inv), m)};
+        return internal::reduce_once(t[1] + um[1] + static_cast<std::uint64_t>(t[0] != 0), m);
+    }
+
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_add(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, OutIter c_first) noexcept
+    {
+        const auto size{static_cast<std::size_t>(a_last - a_first)};
+        for (std::size_t i{0}; i < size; ++i)
+            c_first[i] = internal::reduce_once(a_first[i] + b_first[i], m_first[i]);
+    }
+
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_sub(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, OutIter c_first) noexcept
+    {
+        const auto size{static_cast<std::size_t>(a_last - a_first)};
+        for (std::size_t i{0}; i < size; ++i) {
+            // a - b + m < 2 * m
+            c_first[i] = internal::reduce_once(a_first[i] - b_first[i] + m_first[i], m_first[i]);
+        }
+    }
+
+    template <class InIter, class ModIter, class OutIter>
+    inline void multimod_mul(InIter a_first, InIter a_last, InIter b_first, ModIter m_first, ModIter inv_first,
+                             OutIter c_first) noexcept
+    {
+        const auto size{static_cast<std::size_t>(a_last - a_first)};
+        for (std::size_t i{0}; i < size; ++i)
+            c_first[i] = montgomery_mul_1(a_first[i], b_first[i], m_first[i], inv_first[i]);
+    }
+} // namespace xenonis::algorithms
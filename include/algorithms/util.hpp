@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include "bigint_config.hpp"
+#include "../stats.hpp"
+
 #include <algorithm>
 
 namespace xenonis::algorithms {
@@ -16,23 +19,23 @@ namespace xenonis::algorithms {
      * 2, 3 }
      */
     template <class InContainer, class OutContainer = InContainer>
-    OutContainer lshift(const InContainer& data, decltype(data.size()) count);
+    XENONIS_CONSTEXPR OutContainer lshift(const InContainer& data, decltype(data.size()) count);
 
     /*!
      * \brief Removes all redundant zeros. z.B { 0, 1, 2 } -> { 1, 2 }
      * \details Never returns empty container. z.B { 0, 0, 0 } -> { 0 }
      */
-    template <class InContainer> void remove_zeros(InContainer& data) noexcept;
+    template <class InContainer> XENONIS_CONSTEXPR void remove_zeros(InContainer& data) noexcept;
 
     template <class InContainer, class OutContainer>
-    OutContainer lshift(const InContainer& data, decltype(data.size()) count)
+    XENONIS_CONSTEXPR OutContainer lshift(const InContainer& data, decltype(data.size()) count)
     {
         OutContainer tmp(data.size() + count, 0);
         std::copy(data.cbegin(), data.cend(), tmp.begin() + count);
         return tmp;
     }
 
-    template <class InContainer> void remove_zeros(InContainer& data) noexcept
+    template <class InContainer> XENONIS_CONSTEXPR void remove_zeros(InContainer& data) noexcept
     {
         auto first{data.crbegin()};
         auto last{data.crend()};
@@ -42,11 +45,15 @@ namespace xenonis::algorithms {
                 break;
 
         if (first == last) { // data.size() must not be 0
+            if (data.size() > 1)
+                XENONIS_STATS_EVENT(remove_zeros_shrink);
             data.resize(1);
             data.front() = 0;
             return;
         }
 
+        if (first != data.crbegin())
+            XENONIS_STATS_EVENT(remove_zeros_shrink);
         data.resize(last - first);
     }
 } // namespace xenonis::algorithms
@@ -0,0 +1,110 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file async.hpp
+ *  \brief Multiplications of large bigints on other threads, which can be cancelled.
+ */
+#pragma once
+
+#include "bigint.hpp"
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace xenonis {
+    /*!
+     *  Thrown by the computations which were cancelled using a cancellation_token.
+     */
+    class operation_cancelled : public std::runtime_error {
+      public:
+        operation_cancelled() : std::runtime_error("The operation was cancelled!") {}
+    };
+
+    /*!
+     *  Requests the cancellation of the computations it is passed to, it may be cancelled from any thread.
+     *  \details The computations check the token when they start and on every level of the Karatsuba recursion, so
+     *  they stop after at most one product of the size of the Karatsuba threshold and the additions of one level.
+     */
+    class cancellation_token {
+      public:
+        void cancel() noexcept { m_cancelled.store(true, std::memory_order_relaxed); }
+
+        bool is_cancelled() const noexcept { return m_cancelled.load(std::memory_order_relaxed); }
+
+      private:
+        std::atomic<bool> m_cancelled{false};
+    };
+
+    /*!
+     *  Calculates a * b like operator*, but throws operation_cancelled as soon as the token is cancelled.
+     */
+    template <class Bigint> Bigint cancellable_mul(const Bigint& a, const Bigint& b, const cancellation_token& token)
+    {
+        using container = std::remove_cv_t<std::remove_reference_t<decltype(a.data())>>;
+
+        const auto poll = [&token](std::size_t) {
+            if (token.is_cancelled())
+                throw operation_cancelled();
+        };
+        poll(0);
+
+        if (a.is_zero() || b.is_zero())
+            return Bigint(0);
+
+        const auto& a_data{a.data()};
+        const auto& b_data{b.data()};
+        auto product{algorithms::karatsuba_mul<container, decltype(a_data.cbegin()), algorithms::karatsuba_threshold>(
+            a_data.cbegin(), a_data.cend(), b_data.cbegin(), b_data.cend(), poll)};
+        return Bigint(std::move(product), a.is_negative() != b.is_negative());
+    }
+
+    /*!
+     *  Calculates a * b on a new thread (std::async), so that e.g. an event loop is not blocked.
+     *  \param token the multiplication is cancelled if the token is cancelled, the future then throws
+     *  operation_cancelled. May be nullptr.
+     *  \returns the future of the product
+     */
+    template <class Bigint>
+    std::future<Bigint> async_mul(Bigint a, Bigint b, std::shared_ptr<const cancellation_token> token = nullptr)
+    {
+        if (token == nullptr)
+            token = std::make_shared<const cancellation_token>();
+        return std::async(std::launch::async, [a = std::move(a), b = std::move(b), token = std::move(token)]() {
+            return cancellable_mul(a, b, *token);
+        });
+    }
+
+    /*!
+     *  Calculates a * b on a thread of an executor, e.g. a thread pool.
+     *  \param token the multiplication is cancelled if the token is cancelled, the future then throws
+     *  operation_cancelled. May be nullptr.
+     *  \param executor is called with a copyable function object without arguments, which it has to call once on any
+     *  thread, e.g. the post function of a thread pool.
+     *  \returns the future of the product
+     */
+    template <class Bigint, class Executor>
+    std::future<Bigint> async_mul(Bigint a, Bigint b, std::shared_ptr<const cancellation_token> token,
+                                  Executor&& executor)
+    {
+        if (token == nullptr)
+            token = std::make_shared<const cancellation_token>();
+        // std::packaged_task is move-only, the executor may require a copyable function object like std::function
+        auto task{std::make_shared<std::packaged_task<Bigint()>>(
+            [a = std::move(a), b = std::move(b), token = std::move(token)]() {
+                return cancellable_mul(a, b, *token);
+            })};
+        auto ret{task->get_future()};
+        std::forward<Executor>(executor)([task]() { (*task)(); });
+        return ret;
+    }
+} // namespace xenonis
@@ -0,0 +1,160 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file batch.hpp
+ *  \brief Arithmetic on many unsigned integers of the same size.
+ */
+#pragma once
+
+#include "algorithms/batch.hpp"
+#include "bigint.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace xenonis {
+    /*!
+     *  Stores count unsigned integers with limbs limbs each in a structure of arrays layout (limb i of all numbers
+     *  is contiguous). The arithmetic is done modulo 2^(limbs * bits of a limb) for all numbers at once without
+     *  allocations, sign checks or size checks per number.
+     */
+    template <typename Value = std::uint64_t, class Allocator = std::allocator<Value>> class batch {
+      public:
+        using value_type = Value;
+        using size_type = std::size_t;
+
+      private:
+        constexpr static unsigned bits{std::numeric_limits<Value>::digits};
+
+        size_type m_count{0};
+        size_type m_limbs{0};
+        std::vector<Value, Allocator> m_data;
+        // the carries or borrows of the last addition or subtraction
+        std::vector<Value, Allocator> m_carries;
+
+        void check_shape(const batch& other) const
+        {
+            if (m_count != other.m_count || m_limbs != other.m_limbs)
+                throw std::invalid_argument("Batch shapes do not match!");
+        }
+
+      public:
+        batch() noexcept {}
+
+        /*!
+         *  Creates a batch of count zeros with limbs limbs each.
+         */
+        batch(size_type count, size_type limbs)
+            : m_count(count), m_limbs(limbs), m_data(count * limbs), m_carries(count)
+        {
+        }
+
+        size_type count() const noexcept { return m_count; }
+        size_type limbs() const noexcept { return m_limbs; }
+
+        Value& limb(size_type number, size_type i) noexcept { return m_data[i * m_count + number]; }
+        const Value& limb(size_type number, size_type i) const noexcept { return m_data[i * m_count + number]; }
+
+        /*!
+         *  \returns the carries (or borrows) of the last += or -=, one per number
+         */
+        const std::vector<Value, Allocator>& carries() const noexcept { return m_carries; }
+
+        /*!
+         *  Stores n modulo 2^(limbs * bits of a limb) at position number, negative numbers are stored in two's
+         *  complement.
+         */
+        template <class Container> void set(size_type number, const internal::bigint<Value, Container>& n)
+        {
+            const auto& data{n.data()};
+            Value carry{1};
+            for (size_type i{0}; i < m_limbs; ++i) {
+                const Value e{i < data.size() ? data[i] : Value{0}};
+                if (n.is_negative()) // -x = ~x + 1
+                    limb(number, i) = algorithms::add_carry(static_cast<Value>(~e), Value{0}, carry);
+                else
+                    limb(number, i) = e;
+            }
+        }
+
+        /*!
+         *  \returns the number at position number
+         */
+        template <class Container = internal::bigint_data<Value>>
+        internal::bigint<Value, Container> get(size_type number) const
+        {
+            internal::bigint<Value, Container> ret(0);
+            for (size_type i{m_limbs}; i-- > 0;) {
+                ret <<= bits;
+                ret |= internal::bigint<Value, Container>(limb(number, i));
+            }
+            return ret;
+        }
+
+        batch& operator+=(const batch& other)
+        {
+            check_shape(other);
+            algorithms::batch_add(m_data.cbegin(), other.m_data.cbegin(), m_data.begin(), m_carries.begin(), m_limbs,
+                                  m_count);
+            return *this;
+        }
+
+        batch& operator-=(const batch& other)
+        {
+            check_shape(other);
+            algorithms::batch_sub(m_data.cbegin(), other.m_data.cbegin(), m_data.begin(), m_carries.begin(), m_limbs,
+                                  m_count);
+            return *this;
+        }
+
+        batch& operator*=(const batch& other)
+        {
+            check_shape(other);
+            batch ret(m_count, m_limbs);
+            algorithms::batch_mul(m_data.cbegin(), other.m_data.cbegin(), ret.m_data.begin(), m_limbs, m_count);
+            m_data = std::move(ret.m_data);
+            return *this;
+        }
+
+        /*!
+         *  Compares all numbers of a with the numbers of b.
+         *  \returns -1 if a < b, 0 if a == b and 1 if a > b for every number
+         */
+        friend std::vector<int> compare(const batch& a, const batch& b)
+        {
+            a.check_shape(b);
+            std::vector<int> ret(a.m_count);
+            algorithms::batch_compare(a.m_data.cbegin(), b.m_data.cbegin(), ret.begin(), a.m_limbs, a.m_count);
+            return ret;
+        }
+
+        friend batch operator+(batch a, const batch& b)
+        {
+            a += b;
+            return a;
+        }
+
+        friend batch operator-(batch a, const batch& b)
+        {
+            a -= b;
+            return a;
+        }
+
+        friend batch operator*(const batch& a, const batch& b)
+        {
+            a.check_shape(b);
+            batch ret(a.m_count, a.m_limbs);
+            algorithms::batch_mul(a.m_data.cbegin(), b.m_data.cbegin(), ret.m_data.begin(), a.m_limbs, a.m_count);
+            return ret;
+        }
+    };
+} // namespace xenonis
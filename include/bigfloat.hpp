@@ -0,0 +1,469 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file bigfloat.hpp
+ *  \brief Arbitrary-precision binary floating-point numbers with bigint mantissas.
+ */
+#pragma once
+
+#include "algorithms/arithmetic.hpp"
+#include "bigint.hpp"
+#include "roots.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace xenonis {
+    /*!
+     *  A binary floating-point number m * 2^e with a bigint mantissa m, an int64 exponent e and a precision p in bits.
+     *  \details The results of +, -, *, / and sqrt are the exact results rounded to nearest (ties to even) to the
+     *  larger precision of the operands. The mantissa has at most p bits and no trailing zero bits, so every value has
+     *  a unique representation. There are no infinities, NaNs or signed zeros and the exponent is not checked for
+     *  overflow.
+     */
+    template <class Bigint = bigint> class basic_bigfloat {
+      public:
+        using exponent_type = std::int64_t;
+
+        //! zero with a precision of 53 bits
+        basic_bigfloat() : m_mant(0), m_exp(0), m_prec(53) {}
+
+        /*!
+         *  Constructs mantissa * 2^exponent rounded to precision bits. Throws std::invalid_argument if precision is
+         *  zero.
+         */
+        basic_bigfloat(const Bigint& mantissa, exponent_type exponent, std::size_t precision)
+            : m_exp(0), m_prec(check_precision(precision))
+        {
+            assign_rounded(abs(mantissa), mantissa.is_negative(), exponent, false);
+        }
+
+        basic_bigfloat(const Bigint& n, std::size_t precision) : basic_bigfloat(n, 0, precision) {}
+
+        /*!
+         *  Converts d, which is exact if precision >= 53. Throws std::domain_error if d is not finite.
+         */
+        explicit basic_bigfloat(double d, std::size_t precision = 53) : m_exp(0), m_prec(check_precision(precision))
+        {
+            if (!std::isfinite(d))
+                throw std::domain_error("Not a finite number!");
+
+            int exp;
+            const auto mantissa{static_cast<std::int64_t>(std::ldexp(std::frexp(d, &exp), 53))};
+            assign_rounded(abs(Bigint(mantissa)), mantissa < 0, exp - 53, false);
+        }
+
+        const Bigint& mantissa() const noexcept { return m_mant; }
+        exponent_type exponent() const noexcept { return m_exp; }
+        std::size_t precision() const noexcept { return m_prec; }
+
+        bool is_zero() const noexcept { return m_mant.is_zero(); }
+        bool is_negative() const noexcept { return m_mant.is_negative(); }
+
+        /*!
+         *  Rounds the number to precision bits. Throws std::invalid_argument if precision is zero.
+         */
+        basic_bigfloat& set_precision(std::size_t precision)
+        {
+            m_prec = check_precision(precision);
+            assign_rounded(abs(m_mant), m_mant.is_negative(), m_exp, false);
+            return *this;
+        }
+
+        basic_bigfloat operator-() const
+        {
+            auto tmp{*this};
+            tmp.m_mant = -tmp.m_mant;
+            return tmp;
+        }
+
+        basic_bigfloat& operator+=(const basic_bigfloat& other) { return add_assign(other, false); }
+        basic_bigfloat& operator-=(const basic_bigfloat& other) { return add_assign(other, true); }
+
+        basic_bigfloat& operator*=(const basic_bigfloat& other)
+        {
+            m_prec = std::max(m_prec, other.m_prec);
+            if (is_zero() || other.is_zero()) {
+                m_mant = Bigint(0);
+                m_exp = 0;
+                return *this;
+            }
+
+            const bool negative{is_negative() != other.is_negative()};
+            const auto exp{m_exp + other.m_exp};
+            auto [product, shift, inexact] = mul_rounding_bits(abs(m_mant), abs(other.m_mant), m_prec);
+            assign_rounded(std::move(product), negative, exp + static_cast<exponent_type>(shift), inexact);
+            return *this;
+        }
+
+        /*!
+         *  Throws std::domain_error if other is zero.
+         */
+        basic_bigfloat& operator/=(const basic_bigfloat& other)
+        {
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+
+            m_prec = std::max(m_prec, other.m_prec);
+            if (is_zero())
+                return *this;
+
+            // the quotient has at least p + 2 bits, the remainder decides whether it is exact
+            const auto a_bits{m_mant.bit_length()};
+            const auto b_bits{other.m_mant.bit_length()};
+            const auto shift{m_prec + 2 + b_bits > a_bits ? m_prec + 2 + b_bits - a_bits : 0};
+            const auto a{abs(m_mant) << shift};
+            const auto b{abs(other.m_mant)};
+            auto [q, r] = algorithms::divmod<container>(a.data().cbegin(), a.data().cend(), b.data().cbegin(),
+                                                        b.data().cend());
+
+            const bool negative{is_negative() != other.is_negative()};
+            const auto exp{m_exp - other.m_exp - static_cast<exponent_type>(shift)};
+            assign_rounded(Bigint(std::move(q)), negative, exp, !Bigint(std::move(r)).is_zero());
+            return *this;
+        }
+
+#define BIGFLOAT_ARITHMETIC_OPERATOR_IMPL(op)                                                                          \
+    basic_bigfloat operator op(const basic_bigfloat& other) const                                                      \
+    {                                                                                                                  \
+        auto tmp{*this};                                                                                               \
+        tmp op## = other;                                                                                              \
+        return tmp;                                                                                                    \
+    }
+
+        BIGFLOAT_ARITHMETIC_OPERATOR_IMPL(+)
+        BIGFLOAT_ARITHMETIC_OPERATOR_IMPL(-)
+        BIGFLOAT_ARITHMETIC_OPERATOR_IMPL(*)
+        BIGFLOAT_ARITHMETIC_OPERATOR_IMPL(/)
+
+#undef BIGFLOAT_ARITHMETIC_OPERATOR_IMPL
+
+        //! compares the values, the precisions are ignored
+        bool operator==(const basic_bigfloat& other) const { return m_mant == other.m_mant && m_exp == other.m_exp; }
+        bool operator!=(const basic_bigfloat& other) const { return !(*this == other); }
+
+        bool operator<(const basic_bigfloat& other) const
+        {
+            if (is_negative() != other.is_negative())
+                return is_negative();
+            const auto cmp{compare_abs(*this, other)};
+            return is_negative() ? cmp > 0 : cmp < 0;
+        }
+
+        bool operator>(const basic_bigfloat& other) const { return other < *this; }
+        bool operator<=(const basic_bigfloat& other) const { return !(other < *this); }
+        bool operator>=(const basic_bigfloat& other) const { return !(*this < other); }
+
+        /*!
+         *  \returns the number rounded to a double, results in the subnormal range are rounded twice
+         */
+        double to_double() const
+        {
+            auto tmp{*this};
+            tmp.set_precision(53);
+
+            // the mantissa has at most 53 bits, so the sum is exact
+            double ret{0};
+            const auto& data{tmp.m_mant.data()};
+            for (auto i{data.size()}; i-- > 0;)
+                ret = ret * std::ldexp(1.0, limb_bits) + static_cast<double>(data[i]);
+
+            // beyond these exponents the result is 0 or infinity anyway
+            constexpr exponent_type max_exp{1 << 20};
+            ret = std::ldexp(ret, static_cast<int>(std::clamp(tmp.m_exp, -max_exp, max_exp)));
+            return tmp.is_negative() ? -ret : ret;
+        }
+
+        /*!
+         *  \param digits the number of significant decimal digits, 0 selects enough digits to distinguish all numbers
+         *  of the precision
+         *  \returns the number in decimal scientific notation, e.g. "-1.25e+03"
+         */
+        std::string to_string(std::size_t digits = 0) const
+        {
+            if (digits == 0)
+                digits = m_prec * 30103 / 100000 + 2;
+            if (is_zero())
+                return "0";
+
+            // |x| is in [2^(top - 1), 2^top), the estimate of floor(log10(|x|)) is corrected below
+            auto dec_exp{static_cast<exponent_type>(std::floor(static_cast<double>(top() - 1) * 0.30102999566398120))};
+            const auto digits_min{Bigint(10).pow(digits - 1)};
+            const auto digits_max{digits_min * Bigint(10)};
+
+            Bigint n;
+            while (true) {
+                // n = round(|x| / 10^(dec_exp - digits + 1))
+                const auto k{dec_exp - static_cast<exponent_type>(digits) + 1};
+                auto num{abs(m_mant)};
+                Bigint den(1);
+                if (m_exp >= 0)
+                    num <<= static_cast<std::size_t>(m_exp);
+                else
+                    den <<= static_cast<std::size_t>(-m_exp);
+                if (k >= 0)
+                    den *= Bigint(10).pow(static_cast<std::uint64_t>(k));
+                else
+                    num *= Bigint(10).pow(static_cast<std::uint64_t>(-k));
+
+                n = num / den;
+                const auto r{num - n * den};
+                const auto r2{r + r};
+                if (r2 > den || (r2 == den && n.test_bit(0)))
+                    ++n;
+
+                if (n >= digits_max)
+                    ++dec_exp;
+                else if (n < digits_min)
+                    --dec_exp;
+                else
+                    break;
+            }
+
+            const auto str{n.to_decimal_string()};
+            std::string ret;
+            if (is_negative())
+                ret += '-';
+            ret += str.front();
+            if (str.size() > 1) {
+                ret += '.';
+                ret.append(str, 1, std::string::npos);
+            }
+            ret += dec_exp < 0 ? "e-" : "e+";
+            const auto exp_str{std::to_string(dec_exp < 0 ? -dec_exp : dec_exp)};
+            if (exp_str.size() < 2)
+                ret += '0';
+            return ret + exp_str;
+        }
+
+      private:
+        using container = std::remove_const_t<std::remove_reference_t<decltype(std::declval<Bigint>().data())>>;
+        using limb_type = std::remove_const_t<std::remove_reference_t<decltype(std::declval<Bigint>().data()[0])>>;
+        static constexpr unsigned limb_bits{std::numeric_limits<limb_type>::digits};
+
+        Bigint m_mant;
+        exponent_type m_exp;
+        std::size_t m_prec;
+
+        static std::size_t check_precision(std::size_t precision)
+        {
+            if (precision == 0)
+                throw std::invalid_argument("The precision has to be positive!");
+            return precision;
+        }
+
+        static Bigint abs(const Bigint& n) { return n.is_negative() ? -n : n; }
+
+        //! the value is less than 2^top() in magnitude
+        exponent_type top() const noexcept { return m_exp + static_cast<exponent_type>(m_mant.bit_length()); }
+
+        // true if the bits [first, last) of the non-negative n are all ones (or all zeros if ones is false)
+        static bool bits_equal(const Bigint& n, std::size_t first, std::size_t last, bool ones) noexcept
+        {
+            const auto& data{n.data()};
+            while (first < last) {
+                const auto limb{first / limb_bits};
+                const auto shift{static_cast<unsigned>(first % limb_bits)};
+                const auto count{std::min<std::size_t>(limb_bits - shift, last - first)};
+                const auto mask{static_cast<limb_type>(std::numeric_limits<limb_type>::max() >> (limb_bits - count))};
+                const auto value{static_cast<limb_type>(limb < data.size() ? data[limb] >> shift : 0)};
+                if (static_cast<limb_type>(value & mask) != (ones ? mask : 0))
+                    return false;
+                first += count;
+            }
+            return true;
+        }
+
+        static std::size_t trailing_zeros(const Bigint& n) noexcept
+        {
+            std::size_t ret{0};
+            auto first{n.data().cbegin()};
+            for (; *first == 0; ++first)
+                ret += limb_bits;
+            return ret + algorithms::count_trailing_zeros(*first);
+        }
+
+        // m_mant = round(magnitude * 2^exp) with m_prec bits, a set inexact flag means that the exact value is
+        // slightly larger than magnitude * 2^exp, which then has to have at least m_prec + 2 bits
+        void assign_rounded(Bigint magnitude, bool negative, exponent_type exp, bool inexact)
+        {
+            if (magnitude.is_zero()) {
+                m_mant = std::move(magnitude);
+                m_exp = 0;
+                return;
+            }
+
+            const auto bits{magnitude.bit_length()};
+            if (bits > m_prec) {
+                const auto shift{bits - m_prec};
+                const bool half{magnitude.test_bit(shift - 1)};
+                const bool sticky{inexact || !bits_equal(magnitude, 0, shift - 1, false)};
+                magnitude >>= shift;
+                exp += static_cast<exponent_type>(shift);
+                if (half && (sticky || magnitude.test_bit(0))) {
+                    ++magnitude;
+                    if (magnitude.bit_length() > m_prec) { // rounded up to 2^p
+                        magnitude = Bigint(1);
+                        exp += static_cast<exponent_type>(m_prec);
+                    }
+                }
+            }
+
+            const auto zeros{trailing_zeros(magnitude)};
+            if (zeros != 0) {
+                magnitude >>= zeros;
+                exp += static_cast<exponent_type>(zeros);
+            }
+
+            m_mant = negative ? -magnitude : std::move(magnitude);
+            m_exp = exp;
+        }
+
+        basic_bigfloat& add_assign(const basic_bigfloat& other, bool subtract)
+        {
+            m_prec = std::max(m_prec, other.m_prec);
+            if (other.is_zero())
+                return *this;
+            if (is_zero()) {
+                m_mant = subtract ? -other.m_mant : other.m_mant;
+                m_exp = other.m_exp;
+                return *this;
+            }
+
+            // a is the operand with the larger bound 2^top, the signs include the subtraction
+            const bool swapped{top() < other.top()};
+            const auto& a{swapped ? other : *this};
+            const auto& b{swapped ? *this : other};
+            const bool a_negative{a.is_negative() != (swapped && subtract)};
+            const bool b_negative{b.is_negative() != (!swapped && subtract)};
+
+            // the operands are aligned at the exponent e, at most 4 bits below the last bit of the result. A b with
+            // bits below e is at most 2^(top(a) - 4) in magnitude, these bits are replaced by a sticky bit at e,
+            // which keeps the sum between the same rounding boundaries (multiples of 2^(e + 1)) as the exact sum
+            const auto e{std::max(std::min(a.m_exp, b.m_exp), a.top() - static_cast<exponent_type>(m_prec) - 4)};
+            auto x{abs(a.m_mant) << static_cast<std::size_t>(a.m_exp - e)};
+            Bigint y;
+            if (b.m_exp >= e) {
+                y = abs(b.m_mant) << static_cast<std::size_t>(b.m_exp - e);
+            } else {
+                // the mantissa is odd, so some of the truncated bits are set
+                const auto shift{static_cast<std::uint64_t>(e - b.m_exp)};
+                y = shift < b.m_mant.bit_length() ? abs(b.m_mant) >> static_cast<std::size_t>(shift) : Bigint(0);
+                if (!y.test_bit(0))
+                    ++y;
+            }
+
+            bool negative{a_negative};
+            if (a_negative == b_negative) {
+                x += y;
+            } else {
+                x -= y;
+                if (x.is_negative()) {
+                    x = -x;
+                    negative = !negative;
+                }
+            }
+
+            assign_rounded(std::move(x), negative, e, false);
+            return *this;
+        }
+
+        // the product of the non-negative a and b reduced to the bits required to round it to p bits: returns
+        // (h, shift, inexact) such that rounding h * 2^shift with the inexact flag gives the rounded product
+        static std::tuple<Bigint, std::size_t, bool> mul_rounding_bits(const Bigint& a, const Bigint& b,
+                                                                       std::size_t p)
+        {
+            const auto& a_data{a.data()};
+            const auto& b_data{b.data()};
+            const auto a_size{a_data.size()};
+            const auto b_size{b_data.size()};
+
+            // the high product h has at least p + 2 * limb_bits - 2 bits, so the bits below the rounding bit
+            // include more than a full limb above the error of the short product
+            const auto n{(p + limb_bits - 1) / limb_bits + 4};
+            const auto error{2 * n + 2};
+            if (a_size + b_size <= n + 1 || error >= std::numeric_limits<limb_type>::max())
+                return {a * b, 0, false};
+
+            const auto shift{(a_size + b_size - n) * limb_bits};
+            Bigint high(
+                algorithms::mulhi<container>(a_data.cbegin(), a_data.cend(), b_data.cbegin(), b_data.cend(), n));
+
+            // a * b / 2^shift is in [h, h + error + 1). Rounding only depends on h if no multiple of 2^r, r being the
+            // position of the rounding bit, is in this interval: the bits [limb_bits, r) of h are neither all zeros
+            // nor all ones.
+            const auto r{high.bit_length() - p - 1};
+            if (!bits_equal(high, limb_bits, r, false) && !bits_equal(high, limb_bits, r, true))
+                return {std::move(high), shift, true};
+
+            return {a * b, 0, false};
+        }
+
+        // compares |x| and |y|
+        static int compare_abs(const basic_bigfloat& x, const basic_bigfloat& y)
+        {
+            if (x.is_zero() || y.is_zero())
+                return static_cast<int>(!x.is_zero()) - static_cast<int>(!y.is_zero());
+            if (x.top() != y.top())
+                return x.top() < y.top() ? -1 : 1;
+
+            // the same bound, the difference of the exponents is less than the lengths of the mantissas
+            auto x_mant{abs(x.m_mant)};
+            auto y_mant{abs(y.m_mant)};
+            if (x.m_exp > y.m_exp)
+                x_mant <<= static_cast<std::size_t>(x.m_exp - y.m_exp);
+            else
+                y_mant <<= static_cast<std::size_t>(y.m_exp - x.m_exp);
+            return x_mant < y_mant ? -1 : (y_mant < x_mant ? 1 : 0);
+        }
+
+        template <class B> friend basic_bigfloat<B> sqrt(const basic_bigfloat<B>& x);
+    };
+
+    using bigfloat = basic_bigfloat<bigint>;
+
+    /*!
+     *  \returns the square root of x rounded to the precision of x. Throws std::domain_error if x < 0.
+     */
+    template <class Bigint> basic_bigfloat<Bigint> sqrt(const basic_bigfloat<Bigint>& x)
+    {
+        using exponent_type = typename basic_bigfloat<Bigint>::exponent_type;
+
+        if (x.is_negative())
+            throw std::domain_error("Square root of a negative number!");
+
+        basic_bigfloat<Bigint> ret;
+        ret.m_prec = x.m_prec;
+        if (x.is_zero())
+            return ret;
+
+        // the root of m * 2^shift has at least p + 2 bits, m * 2^shift * 2^(e - shift) with an even e - shift
+        const auto bits{x.m_mant.bit_length()};
+        auto shift{2 * x.m_prec + 4 > bits ? 2 * x.m_prec + 4 - bits : 0};
+        if ((x.m_exp - static_cast<exponent_type>(shift)) % 2 != 0)
+            ++shift;
+
+        auto [s, r] = sqrtrem(x.m_mant << shift);
+        ret.assign_rounded(std::move(s), false, (x.m_exp - static_cast<exponent_type>(shift)) / 2, !r.is_zero());
+        return ret;
+    }
+
+    template <class Bigint> std::ostream& operator<<(std::ostream& out, const basic_bigfloat<Bigint>& x)
+    {
+        return out << x.to_string();
+    }
+} // namespace xenonis
@@ -16,18 +16,28 @@
 #include "bigint_config.hpp"
 
 #include "algorithms/arithmetic.hpp"
+#include "algorithms/bitwise.hpp"
 #include "algorithms/compare.hpp"
 #include "algorithms/conversion.hpp"
+#include "algorithms/hash.hpp"
+#include "algorithms/modular.hpp"
 #include "container/bigint_data.hpp"
 #include "integer_traits.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <limits>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <type_traits>
 
+#ifdef XENONIS_THREE_WAY_COMPARISON
+    #include <compare>
+#endif
+
 namespace xenonis::internal {
     template <typename Value, class Container> class bigint {
         static_assert(std::is_integral<Value>::value && std::is_unsigned<Value>::value,
@@ -44,23 +54,166 @@ namespace xenonis::internal {
         using base_type = typename traits::uinteger<Value>::doubled;
         constexpr static Value base_min_one{std::numeric_limits<Value>::max()};
         constexpr static base_type base{static_cast<base_type>(base_min_one) + 1};
-        bigint(Container data, bool sign = false) : m_data(std::move(data)), m_sign(sign) {}
+        constexpr static unsigned bits{std::numeric_limits<Value>::digits};
+        // the machine integers the comparisons accept without converting them to a bigint
+        template <typename T>
+        using enable_if_integer = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int>;
+        template <class Op> XENONIS_CONSTEXPR bigint& bitwise_assign(const bigint& other, Op op)
+        {
+            Container tmp(std::max(m_data.size(), other.m_data.size()) + 1);
+            m_sign = algorithms::bitwise(m_data.cbegin(), m_data.cend(), m_sign, other.m_data.cbegin(),
+                                         other.m_data.cend(), other.m_sign, tmp.begin(), tmp.end(), op);
+            m_data = std::move(tmp);
+            algorithms::remove_zeros(m_data);
+            return *this;
+        }
+
+        // adds other with the sign other_sign to this, m_data is grown in place and only reallocated if the capacity
+        // is exhausted
+        XENONIS_CONSTEXPR bigint& add_assign(const bigint& other, bool other_sign)
+        {
+            if (&other == this) {
+                const bigint copy(other);
+                return add_assign(copy, other_sign);
+            }
+
+            const auto size{m_data.size()};
+            const auto other_size{other.m_data.size()};
+
+            if (m_sign == other_sign) {
+                bool carry{false};
+                if (size >= other_size) {
+                    if (other_size != 0)
+                        carry = algorithms::add(m_data.cbegin(), other.m_data.cbegin(), other.m_data.cend(),
+                                                m_data.begin());
+                    if (carry)
+                        carry = algorithms::increment(m_data.begin() + other_size, m_data.end());
+                } else {
+                    m_data.resize(other_size);
+                    if (size != 0)
+                        carry = algorithms::add(other.m_data.cbegin(), m_data.cbegin(), m_data.cbegin() + size,
+                                                m_data.begin());
+                    std::copy(other.m_data.cbegin() + size, other.m_data.cend(), m_data.begin() + size);
+                    if (carry)
+                        carry = algorithms::increment(m_data.begin() + size, m_data.end());
+                }
+                if (carry)
+                    m_data.push_back(1);
+            } else {
+                if (!algorithms::less<Container>(m_data, other.m_data)) {
+                    // |this| >= |other|: the sign is kept, the result is <= 0 if this is negative, else >= 0
+                    if (other_size != 0 &&
+                        algorithms::sub_from(m_data.begin(), other.m_data.cbegin(), other.m_data.cend()))
+                        algorithms::decrement(m_data.begin() + other_size, m_data.end());
+                } else {
+                    // |this| < |other|: this = other - this
+                    m_data.resize(other_size);
+                    bool borrow{false};
+                    if (size != 0)
+                        borrow = algorithms::sub(other.m_data.cbegin(), m_data.cbegin(), m_data.cbegin() + size,
+                                                 m_data.begin());
+                    std::copy(other.m_data.cbegin() + size, other.m_data.cend(), m_data.begin() + size);
+                    if (borrow)
+                        algorithms::decrement(m_data.begin() + size, m_data.end());
+                    m_sign = !m_sign;
+                }
+                algorithms::remove_zeros(m_data);
+            }
+
+            if (m_data.size() == 1 && m_data.front() == 0)
+                m_sign = false;
+
+            return *this;
+        }
+
+        // adds a * b to this if subtract is false, else subtracts it, using addmul_1 / submul_1 for every limb of the
+        // shorter operand
+        XENONIS_CONSTEXPR bigint& addmul_assign(const bigint& a, const bigint& b, bool subtract)
+        {
+            if (&a == this || &b == this) {
+                const bigint copy(*this);
+                return addmul_assign(&a == this ? copy : a, &b == this ? copy : b, subtract);
+            }
+
+            if (a.is_zero() || b.is_zero())
+                return *this;
+
+            const auto& x{a.m_data.size() >= b.m_data.size() ? a.m_data : b.m_data};
+            const auto& y{a.m_data.size() >= b.m_data.size() ? b.m_data : a.m_data};
+            const auto x_size{x.size()};
+
+            // the subquadratic multiplication is faster for large operands
+            if (y.size() > algorithms::karatsuba_threshold) {
+                const auto product{a * b};
+                return subtract ? *this -= product : *this += product;
+            }
+
+            // the result fits into size - 1 limbs, the additional limb receives the carries
+            m_data.resize(std::max(m_data.size(), x_size + y.size()) + 1, 0);
+
+            if (((a.m_sign != b.m_sign) != subtract) == m_sign) {
+                for (size_type i{0}; i < y.size(); ++i) {
+                    if (y[i] == 0)
+                        continue;
+                    const auto carry{algorithms::addmul_1(x.cbegin(), x.cend(), y[i], m_data.begin() + i)};
+                    const auto top{m_data.begin() + i + x_size};
+                    *top += carry;
+                    if (*top < carry)
+                        algorithms::increment(top + 1, m_data.end());
+                }
+            } else {
+                // |this| - |a * b| is calculated modulo base^size, if it is negative it is negated in the end
+                bool borrow{false};
+                for (size_type i{0}; i < y.size(); ++i) {
+                    if (y[i] == 0)
+                        continue;
+                    const auto digit_borrow{algorithms::submul_1(x.cbegin(), x.cend(), y[i], m_data.begin() + i)};
+                    const auto top{m_data.begin() + i + x_size};
+                    const auto old{*top};
+                    *top -= digit_borrow;
+                    if (old < digit_borrow)
+                        borrow |= algorithms::decrement(top + 1, m_data.end());
+                }
+                if (borrow) {
+                    for (auto& e : m_data)
+                        e = static_cast<Value>(~e);
+                    algorithms::increment(m_data.begin(), m_data.end());
+                    m_sign = !m_sign;
+                }
+            }
+
+            algorithms::remove_zeros(m_data);
+            if (m_data.size() == 1 && m_data.front() == 0)
+                m_sign = false;
+
+            return *this;
+        }
 
       public:
-        bigint() noexcept {}
+        XENONIS_CONSTEXPR bigint() noexcept {}
+
+        /*!
+         *  Constructs the number from its limbs, the least significant limb first. Leading zero limbs are removed.
+         */
+        XENONIS_CONSTEXPR explicit bigint(Container data, bool sign = false) : m_data(std::move(data)), m_sign(sign)
+        {
+            algorithms::remove_zeros(m_data);
+            if (m_data.size() == 1 && m_data.front() == 0)
+                m_sign = false;
+        }
 
-        bigint(const bigint& other) : m_data(other.m_data), m_sign(other.m_sign) {}
+        XENONIS_CONSTEXPR bigint(const bigint& other) : m_data(other.m_data), m_sign(other.m_sign) {}
 
-        bigint(bigint&& other) : m_data(std::move(other.m_data)), m_sign(other.m_sign) {}
+        XENONIS_CONSTEXPR bigint(bigint&& other) : m_data(std::move(other.m_data)), m_sign(other.m_sign) {}
 
-        bigint& operator=(const bigint& other) noexcept
+        XENONIS_CONSTEXPR bigint& operator=(const bigint& other) noexcept
         {
             m_data = other.m_data;
             m_sign = other.m_sign;
             return *this;
         }
 
-        bigint& operator=(bigint&& other) noexcept
+        XENONIS_CONSTEXPR bigint& operator=(bigint&& other) noexcept
         {
             m_data = std::move(other.m_data);
             m_sign = other.m_sign;
@@ -68,7 +221,7 @@ namespace xenonis::internal {
         }
 
 #define BIGINT_INT_CONSTRUCTOR(T)                                                                                      \
-    bigint(T n) noexcept                                                                                               \
+    XENONIS_CONSTEXPR bigint(T n) noexcept                                                                             \
     {                                                                                                                  \
         auto ret{algorithms::from_int<Value, T, Container>(n)};                                                        \
         m_sign = ret.first;                                                                                            \
@@ -82,7 +235,7 @@ namespace xenonis::internal {
 #undef BIGINT_INT_CONSTRUCTOR
 
 #define BIGINT_UINT_CONSTRUCTOR(T)                                                                                     \
-    bigint(T n) noexcept { m_data = algorithms::from_uint<Value, T, Container>(n); }
+    XENONIS_CONSTEXPR bigint(T n) noexcept { m_data = algorithms::from_uint<Value, T, Container>(n); }
 
         BIGINT_UINT_CONSTRUCTOR(std::uint64_t)
         BIGINT_UINT_CONSTRUCTOR(std::uint32_t)
@@ -90,7 +243,7 @@ namespace xenonis::internal {
         BIGINT_UINT_CONSTRUCTOR(std::uint8_t)
 #undef BIGINT_UINT_CONSTRUCTOR
 
-        bigint(const std::string_view hex_str)
+        XENONIS_CONSTEXPR bigint(const std::string_view hex_str)
         {
             if ((hex_str.size() == 2 && hex_str.front() == '-' && hex_str.back() == '0') ||
                 (hex_str.size() == 1 && hex_str.front() == '0')) {
@@ -109,7 +262,7 @@ namespace xenonis::internal {
                 std::string_view(hex_str.data() + m_sign, hex_str.size() - m_sign));
         }
 
-        bigint& operator++()
+        XENONIS_CONSTEXPR bigint& operator++()
         {
             if (m_sign) {
                 if (m_data.size() == 1 && m_data.front() == 1) {
@@ -118,6 +271,8 @@ namespace xenonis::internal {
                     return *this;
                 }
                 algorithms::decrement(m_data.begin(), m_data.end());
+                if (m_data.size() > 1 && m_data.back() == 0)
+                    m_data.pop_back();
             } else {
                 if (algorithms::increment(m_data.begin(), m_data.end()))
                     m_data.push_back(1);
@@ -125,7 +280,7 @@ namespace xenonis::internal {
             return *this;
         }
 
-        bigint& operator--()
+        XENONIS_CONSTEXPR bigint& operator--()
         {
             if (!m_sign) {
                 if (m_data.size() == 1 && m_data.front() == 0) {
@@ -134,6 +289,8 @@ namespace xenonis::internal {
                     return *this;
                 }
                 algorithms::decrement(m_data.begin(), m_data.end());
+                if (m_data.size() > 1 && m_data.back() == 0)
+                    m_data.pop_back();
             } else {
                 if (algorithms::increment(m_data.begin(), m_data.end()))
                     m_data.push_back(1);
@@ -141,160 +298,289 @@ namespace xenonis::internal {
             return *this;
         }
 
-        bigint& operator++(int)
+        XENONIS_CONSTEXPR bigint operator++(int)
         {
             auto tmp{*this};
-            ++tmp;
+            ++*this;
             return tmp;
         }
 
-        bigint& operator--(int)
+        XENONIS_CONSTEXPR bigint operator--(int)
         {
             auto tmp{*this};
-            --tmp;
+            --*this;
             return tmp;
         }
 
-        bigint& operator+=(const bigint& other)
+        XENONIS_CONSTEXPR bigint& operator+=(const bigint& other) { return add_assign(other, other.m_sign); }
+
+        // other is read-only and a copy is expensive, so the sign of other is passed separately instead of negating
+        // other and calling operator+=
+        XENONIS_CONSTEXPR bigint& operator-=(const bigint& other) { return add_assign(other, !other.m_sign); }
+
+        XENONIS_CONSTEXPR bigint& operator*=(const bigint& other)
         {
-            constexpr auto add = [](const auto& a, const auto& b) {
-                Container tmp(a.size() + 1);
-                tmp.back() = 0;
-                if (algorithms::add(a.cbegin(), b.cbegin(), b.cend(),
-                                    tmp.begin())) { // algorithms::add(a.cbegin(), b.cbegin(), tmp.begin(), b.size())
-                    std::copy(a.cbegin() + b.size(), a.cend(), tmp.begin() + b.size());
-                    algorithms::increment(tmp.begin() + a.size(), tmp.end());
-                } else {
-                    std::copy(a.begin() + b.size(), a.end(), tmp.begin() + b.size());
-                    tmp.pop_back();
-                }
-                return tmp;
-            };
-
-            if (m_sign == other.m_sign) {
-                if (m_data.size() >= other.m_data.size()) {
-                    if (m_data.size() - 1 >= other.m_data.size()) {
-                        if (algorithms::add(
-                                m_data.cbegin(), other.m_data.cbegin(), other.m_data.cend(),
-                                m_data.begin())) { // algorithms::add(m_data.cbegin(), other.m_data.cbegin(),
-                                                   // m_data.begin(), other.m_data.size())
-                            if (algorithms::increment(m_data.begin() + other.m_data.size(), m_data.end()))
-                                m_data.push_back(1);
-                        }
-                    } else {
-                        m_data = add(m_data, other.m_data);
-                    }
-                } else {
-                    m_data = add(other.m_data, m_data);
-                }
-            } else { // is_signed != other.is_signed
-                if (algorithms::greater<Container>(m_data, other.m_data)) {
-                    if (algorithms::sub_from(m_data.begin(), other.m_data.cbegin(), other.m_data.cend()))
-                        algorithms::decrement(m_data.begin() + other.m_data.size(), m_data.end());
-                    // is_signed = is_signed; when is_signed == true then the result has to be <= 0,
-                    // else >= 0
-                } else {
-                    Container tmp(other.m_data.size());
-                    if (algorithms::sub(other.m_data.cbegin(), m_data.cbegin(), m_data.cend(), tmp.begin())) {
-                        std::copy(other.m_data.cbegin() + m_data.size(), other.m_data.cend(),
-                                  tmp.begin() + m_data.size());
-                        algorithms::decrement(tmp.begin() + m_data.size(), tmp.end());
-                    } else {
-                        std::copy(other.m_data.cbegin() + m_data.size(), other.m_data.cend(),
-                                  tmp.begin() + m_data.size());
-                    }
-                    m_data = std::move(tmp);
-                    m_sign = !m_sign;
-                }
-                algorithms::remove_zeros(m_data);
+            if (m_data.size() == 1 && m_data.front() == 0)
+                return *this;
+
+            if (other.m_data.size() == 1 && other.m_data.front() == 0) {
+                m_data = Container(1, 0);
+                m_sign = false;
+                return *this;
             }
 
-            if (m_data.size() == 1 && m_data.front() == 0)
+            if (&other == this) { // x *= x
+                m_data = algorithms::karatsuba_sqr<Container>(m_data.cbegin(), m_data.cend());
                 m_sign = false;
+                return *this;
+            }
+
+            m_data = algorithms::karatsuba_mul<Container, decltype(m_data.cbegin())>(m_data.cbegin(), m_data.cend(), other.m_data.cbegin(),
+                                                      other.m_data.cend());
 
+            m_sign = m_sign != other.m_sign;
             return *this;
         }
 
-        bigint& operator-=(const bigint& other)
+        /*!
+         *  Adds a * b to this without creating the product, the limbs of this are grown in place.
+         */
+        XENONIS_CONSTEXPR bigint& addmul(const bigint& a, const bigint& b) { return addmul_assign(a, b, false); }
+
+        /*!
+         *  Subtracts a * b from this without creating the product, the limbs of this are grown in place.
+         */
+        XENONIS_CONSTEXPR bigint& submul(const bigint& a, const bigint& b) { return addmul_assign(a, b, true); }
+
+        // the division truncates like the division of built-in integers: the quotient is rounded towards zero and
+        // the remainder has the sign of the dividend
+        XENONIS_CONSTEXPR bigint& operator/=(const bigint& other)
         {
-            // because other is read-only and a copy is expensive, operator-= is implemented without
-            // just other.is_signed = !other.is_signed; and calling operator+=
-            constexpr auto add = [](const auto& a, const auto& b) {
-                Container tmp(a.size() + 1);
-                tmp.back() = 0;
-                if (algorithms::add(a.cbegin(), b.cbegin(), b.cend(), tmp.begin())) {
-                    std::copy(a.cbegin() + b.size(), a.cend(), tmp.begin() + b.size());
-                    algorithms::increment(tmp.begin() + a.size(), tmp.end());
-                } else {
-                    std::copy(a.begin() + b.size(), a.end(), tmp.begin() + b.size());
-                    tmp.pop_back();
-                }
-                return /*std::move(*/ tmp /*)*/;
-            };
-
-            if (m_sign != other.m_sign) {
-                if (m_data.size() >= other.m_data.size()) {
-                    if (m_data.size() > other.m_data.size()) {
-                        if (algorithms::add(m_data.cbegin(), other.m_data.cbegin(), other.m_data.cend(),
-                                            m_data.begin())) {
-                            if (algorithms::increment(m_data.begin() + other.m_data.size(), m_data.end()))
-                                m_data.push_back(1);
-                        }
-                    } else {
-                        m_data = add(m_data, other.m_data);
-                    }
-                } else {
-                    m_data = add(other.m_data, m_data);
-                }
-            } else { // is_signed != other.is_signed
-                if (algorithms::greater<Container>(m_data, other.m_data)) {
-                    if (algorithms::sub_from(m_data.begin(), other.m_data.cbegin(), other.m_data.cend()))
-                        algorithms::decrement(m_data.begin() + other.m_data.size(), m_data.end());
-                    // is_signed = is_signed; when is_signed == true then the result has to be <= 0,
-                    // else >= 0
-                } else {
-                    Container tmp(other.m_data.size());
-                    if (algorithms::sub(other.m_data.cbegin(), m_data.cbegin(), m_data.cend(), tmp.begin())) {
-                        std::copy(other.m_data.cbegin() + m_data.size(), other.m_data.cend(),
-                                  tmp.begin() + m_data.size());
-                        algorithms::decrement(tmp.begin() + m_data.size(), tmp.end());
-                    } else {
-                        std::copy(other.m_data.cbegin() + m_data.size(), other.m_data.cend(),
-                                  tmp.begin() + m_data.size());
-                    }
-                    m_data = std::move(tmp);
-                    m_sign = !m_sign;
-                }
-                algorithms::remove_zeros(m_data);
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+
+            m_data = algorithms::divmod<Container>(m_data.cbegin(), m_data.cend(), other.m_data.cbegin(),
+                                                   other.m_data.cend())
+                         .first;
+            m_sign = m_sign != other.m_sign && !is_zero();
+            return *this;
+        }
+
+        XENONIS_CONSTEXPR bigint& operator%=(const bigint& other)
+        {
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+
+            m_data = algorithms::divmod<Container>(m_data.cbegin(), m_data.cend(), other.m_data.cbegin(),
+                                                   other.m_data.cend())
+                         .second;
+            m_sign = m_sign && !is_zero();
+            return *this;
+        }
+
+        /*!
+         *  Calculates this^exp, 0^0 is 1. Throws std::length_error if the result does not fit into a container.
+         *  \details The trailing zero bits of this are removed and applied to the result as a shift, so powers of two
+         *  (e.g. 16^k) and numbers with trailing zero limbs only require a shift. The remaining odd part is raised using
+         *  algorithms::pow, which squares using karatsuba_sqr.
+         */
+        XENONIS_CONSTEXPR bigint pow(std::uint64_t exp) const
+        {
+            if (exp == 0)
+                return bigint(1);
+            if (is_zero())
+                return *this;
+
+            std::size_t zeros{0};
+            auto first{m_data.cbegin()};
+            for (; *first == 0; ++first)
+                zeros += bits;
+            zeros += algorithms::count_trailing_zeros(*first);
+
+            if (exp > std::numeric_limits<std::size_t>::max() / bit_length())
+                throw std::length_error("Too many limbs!");
+
+            bigint ret(1);
+            if (zeros == 0) {
+                ret.m_data = algorithms::pow<Container>(m_data.cbegin(), m_data.cend(), exp);
+            } else if (bit_length() - zeros > 1) {
+                auto odd{*this >> zeros}; // exact, the shifted out bits are zero
+                ret.m_data = algorithms::pow<Container>(odd.m_data.cbegin(), odd.m_data.cend(), exp);
             }
+            ret <<= zeros * exp;
+            ret.m_sign = m_sign && exp % 2 == 1;
+            return ret;
+        }
+
+        /*!
+         *  Calculates this^exp mod m, the result is in [0, |m|). Throws std::domain_error if m is zero or exp is
+         *  negative.
+         *  \details Uses the Montgomery multiplication and a sliding window over the bits of exp if m is odd, the
+         *  products are reduced by division otherwise.
+         */
+        XENONIS_CONSTEXPR bigint powmod(const bigint& exp, const bigint& m) const
+        {
+            if (m.is_zero())
+                throw std::domain_error("Division by zero!");
+            if (exp.m_sign)
+                throw std::domain_error("Negative exponent!");
+
+            const bigint modulus(m.m_data);
+            auto base{*this % modulus};
+            if (base.m_sign)
+                base += modulus;
+
+            if (modulus.m_data.front() % 2 != 0)
+                return bigint(algorithms::powmod<Container>(base.m_data.cbegin(), base.m_data.cend(),
+                                                            exp.m_data.cbegin(), exp.m_data.cend(),
+                                                            modulus.m_data.cbegin(), modulus.m_data.cend()));
+
+            bigint ret(1);
+            ret %= modulus;
+            for (auto i{exp.bit_length()}; i-- > 0;) {
+                ret *= ret;
+                if (exp.test_bit(i))
+                    ret *= base;
+                ret %= modulus;
+            }
+            return ret;
+        }
+
+        XENONIS_CONSTEXPR bigint operator-() const
+        {
+            auto tmp{*this};
+            tmp.m_sign = !m_sign && !is_zero();
+            return tmp;
+        }
+
+        // the bitwise operators use two's complement semantics for negative numbers, e.g. -1 & n == n
+        XENONIS_CONSTEXPR bigint& operator&=(const bigint& other) { return bitwise_assign(other, std::bit_and<>{}); }
+        XENONIS_CONSTEXPR bigint& operator|=(const bigint& other) { return bitwise_assign(other, std::bit_or<>{}); }
+        XENONIS_CONSTEXPR bigint& operator^=(const bigint& other) { return bitwise_assign(other, std::bit_xor<>{}); }
+
+        XENONIS_CONSTEXPR bigint operator~() const
+        {
+            auto tmp{*this}; // ~n == -n - 1
+            ++tmp;
+            if (!tmp.is_zero())
+                tmp.m_sign = !tmp.m_sign;
+            return tmp;
+        }
+
+        XENONIS_CONSTEXPR bigint& operator<<=(size_type count)
+        {
+            if (is_zero())
+                return *this;
+
+            const auto limbs{count / bits};
+            const auto shift{static_cast<unsigned>(count % bits)};
+            const auto size{m_data.size()};
+
+            m_data.resize(size + limbs + (shift != 0));
+            if (shift != 0) {
+                // the limbs are moved from the most significant one, so the shift can be done in place
+                m_data.back() =
+                    algorithms::lshift_bits(m_data.cbegin(), m_data.cbegin() + size, m_data.begin() + limbs, shift);
+                if (m_data.back() == 0)
+                    m_data.pop_back();
+            } else {
+                std::copy_backward(m_data.begin(), m_data.begin() + size, m_data.begin() + size + limbs);
+            }
+            std::fill(m_data.begin(), m_data.begin() + limbs, 0);
 
-            if (m_data.size() == 1 && m_data.front() == 0)
-                m_sign = false;
             return *this;
         }
 
-        bigint& operator*=(const bigint& other)
+        // negative numbers are rounded towards negative infinity, like the arithmetic shift of a two's complement
+        XENONIS_CONSTEXPR bigint& operator>>=(size_type count)
         {
-            if (m_data.size() == 1 && m_data.front() == 0)
+            if (is_zero())
                 return *this;
 
-            if (other.m_data.size() == 1 && other.m_data.front() == 0) {
-                m_data = Container(1, 0);
-                m_sign = false;
+            const auto limbs{count / bits};
+            const auto shift{static_cast<unsigned>(count % bits)};
+
+            if (limbs >= m_data.size()) {
+                m_data = Container(1, m_sign ? 1 : 0);
                 return *this;
             }
 
-            m_data = algorithms::karatsuba_mul<Container, decltype(m_data.cbegin())>(m_data.cbegin(), m_data.cend(), other.m_data.cbegin(),
-                                                      other.m_data.cend());
+            bool inexact{m_sign && !algorithms::is_zero(m_data.cbegin(), m_data.cbegin() + limbs)};
+            if (shift != 0) {
+                if (algorithms::rshift_bits(m_data.cbegin() + limbs, m_data.cend(), m_data.begin(), shift) != 0)
+                    inexact = true;
+            } else {
+                std::copy(m_data.cbegin() + limbs, m_data.cend(), m_data.begin());
+            }
+            m_data.pop_n(limbs);
+            algorithms::remove_zeros(m_data);
+
+            if (m_sign && inexact) {
+                if (algorithms::increment(m_data.begin(), m_data.end()))
+                    m_data.push_back(1);
+            }
 
-            m_sign = m_sign != other.m_sign;
             return *this;
         }
 
-        bigint& operator/=(const bigint& other) noexcept;
+        XENONIS_CONSTEXPR bigint operator<<(size_type count) const
+        {
+            auto tmp{*this};
+            tmp <<= count;
+            return tmp;
+        }
+
+        XENONIS_CONSTEXPR bigint operator>>(size_type count) const
+        {
+            auto tmp{*this};
+            tmp >>= count;
+            return tmp;
+        }
+
+        /*!
+         *  \returns the number of bits required to represent the absolute value, 0 for 0
+         */
+        XENONIS_CONSTEXPR std::size_t bit_length() const noexcept
+        {
+            if (is_zero())
+                return 0;
+            return m_data.size() * bits - algorithms::count_leading_zeros(m_data.back());
+        }
+
+        /*!
+         *  \returns the number of set bits of the absolute value
+         */
+        XENONIS_CONSTEXPR std::size_t popcount() const noexcept
+        {
+            std::size_t ret{0};
+            for (const auto n : m_data)
+                ret += algorithms::popcount(n);
+            return ret;
+        }
+
+        /*!
+         *  \returns the bit at position n, uses two's complement semantics for negative numbers
+         */
+        XENONIS_CONSTEXPR bool test_bit(std::size_t n) const noexcept
+        {
+            const auto limb{n / bits};
+            const bool bit{limb < m_data.size() && ((m_data[limb] >> (n % bits)) & 1) != 0};
+            if (!m_sign)
+                return bit;
+
+            // -x == ~(x - 1): the bits below the lowest set bit of x stay zero, the lowest set bit stays set and all
+            // bits above are inverted
+            std::size_t lowest{0};
+            auto first{m_data.cbegin()};
+            for (; *first == 0; ++first)
+                lowest += bits;
+            lowest += algorithms::count_trailing_zeros(*first);
+
+            return n <= lowest ? bit : !bit;
+        }
 
 #define BIGINT_ARITHMETIC_OPERTATOR_IMPL(op)                                                                           \
-    bigint operator op(const bigint& other) const                                                                      \
+    XENONIS_CONSTEXPR bigint operator op(const bigint& other) const                                                    \
     {                                                                                                                  \
         auto tmp{*this};                                                                                               \
         tmp op## = other;                                                                                              \
@@ -304,59 +590,156 @@ namespace xenonis::internal {
         BIGINT_ARITHMETIC_OPERTATOR_IMPL(+)
         BIGINT_ARITHMETIC_OPERTATOR_IMPL(-)
         BIGINT_ARITHMETIC_OPERTATOR_IMPL(*)
-        // BIGINT_ARITHMETIC_OPERTATOR_IMPL(/)
+        BIGINT_ARITHMETIC_OPERTATOR_IMPL(/)
+        BIGINT_ARITHMETIC_OPERTATOR_IMPL(%)
+        BIGINT_ARITHMETIC_OPERTATOR_IMPL(&)
+        BIGINT_ARITHMETIC_OPERTATOR_IMPL(|)
+        BIGINT_ARITHMETIC_OPERTATOR_IMPL(^)
 
 #undef BIGINT_ARITHMETIC_OPERTATOR_IMPL
 
-        bool operator<(const bigint& other) const noexcept
+        /*!
+         *  \returns -1, 0 or 1 if this is less than, equal to or greater than other, see algorithms::compare
+         */
+        XENONIS_CONSTEXPR int compare(const bigint& other) const noexcept
         {
-            if (m_sign == other.m_sign)
-                return m_sign ? algorithms::greater(m_data, other.m_data, false)
-                              : algorithms::less(m_data, other.m_data, false);
-            else
-                return m_sign;
+            if (m_sign != other.m_sign)
+                return m_sign ? -1 : 1;
+            if (m_data.empty() || other.m_data.empty()) // default constructed, both are non-negative
+                return static_cast<int>(!is_zero()) - static_cast<int>(!other.is_zero());
+
+            const auto cmp{algorithms::compare(m_data, other.m_data)};
+            return m_sign ? -cmp : cmp;
         }
 
-        bool operator>(const bigint& other) const noexcept
+        /*!
+         *  Compares with a machine integer without converting it to a bigint, the integer is split into at most
+         *  sizeof(T) / sizeof(Value) limbs on the stack.
+         *  \returns -1, 0 or 1 if this is less than, equal to or greater than n
+         */
+        template <typename T, enable_if_integer<T> = 0> XENONIS_CONSTEXPR int compare(T n) const noexcept
         {
-            if (m_sign == other.m_sign)
-                return m_sign ? algorithms::less(m_data, other.m_data, false)
-                              : algorithms::greater(m_data, other.m_data, false);
-            else
-                return !m_sign;
+            using unsigned_type = std::make_unsigned_t<T>;
+            constexpr std::size_t max_limbs{(std::numeric_limits<unsigned_type>::digits + bits - 1) / bits};
+
+            auto magnitude{static_cast<unsigned_type>(n)};
+            bool sign{false};
+            if constexpr (std::is_signed_v<T>) {
+                if (n < 0) {
+                    sign = true;
+                    magnitude = static_cast<unsigned_type>(unsigned_type{0} - magnitude); // also for min()
+                }
+            }
+
+            if (m_sign != sign)
+                return m_sign ? -1 : 1;
+            if (is_zero())
+                return magnitude == 0 ? 0 : -1;
+
+            Value n_data[max_limbs]{};
+            std::size_t n_size{0};
+            if constexpr (max_limbs == 1) {
+                n_data[0] = static_cast<Value>(magnitude);
+                n_size = 1;
+            } else {
+                for (; magnitude != 0; magnitude >>= bits)
+                    n_data[n_size++] = static_cast<Value>(magnitude);
+            }
+
+            int cmp{0};
+            if (m_data.size() != n_size) {
+                cmp = m_data.size() < n_size ? -1 : 1;
+            } else {
+                for (std::size_t i{n_size}; i-- != 0;) {
+                    if (m_data[i] != n_data[i]) {
+                        cmp = m_data[i] < n_data[i] ? -1 : 1;
+                        break;
+                    }
+                }
+            }
+            return m_sign ? -cmp : cmp;
         }
 
-        bool operator==(const bigint& other) const noexcept { return m_sign == other.m_sign && m_data == other.m_data; }
+        XENONIS_CONSTEXPR bool operator==(const bigint& other) const noexcept { return compare(other) == 0; }
 
-        bool operator!=(const bigint& other) const noexcept { return !this->operator==(other); }
+        template <typename T, enable_if_integer<T> = 0> XENONIS_CONSTEXPR bool operator==(T n) const noexcept
+        {
+            return compare(n) == 0;
+        }
 
-        bool operator<=(const bigint& other) const noexcept
+#ifdef XENONIS_THREE_WAY_COMPARISON
+        // the other relational operators and the ones with the machine integer on the left side are synthesised
+        XENONIS_CONSTEXPR std::strong_ordering operator<=>(const bigint& other) const noexcept
         {
-            if (m_sign == other.m_sign)
-                return m_sign ? algorithms::greater(m_data, other.m_data, true)
-                              : algorithms::less(m_data, other.m_data, true);
-            else
-                return m_sign;
+            return compare(other) <=> 0;
         }
 
-        bool operator>=(const bigint& other) const noexcept
+        template <typename T, enable_if_integer<T> = 0>
+        XENONIS_CONSTEXPR std::strong_ordering operator<=>(T n) const noexcept
+        {
+            return compare(n) <=> 0;
+        }
+#else
+        template <typename T, enable_if_integer<T> = 0>
+        friend XENONIS_CONSTEXPR bool operator==(T n, const bigint& b) noexcept
         {
-            if (m_sign == other.m_sign)
-                return m_sign ? algorithms::less(m_data, other.m_data, true)
-                              : algorithms::greater(m_data, other.m_data, true);
-            else
-                return !m_sign;
+            return b.compare(n) == 0;
         }
 
-        std::string to_string(bool lower_case = true) const
+#define BIGINT_COMPARISON_OPERATOR_IMPL(op)                                                                            \
+    XENONIS_CONSTEXPR bool operator op(const bigint& other) const noexcept { return compare(other) op 0; }             \
+                                                                                                                       \
+    template <typename T, enable_if_integer<T> = 0> XENONIS_CONSTEXPR bool operator op(T n) const noexcept             \
+    {                                                                                                                  \
+        return compare(n) op 0;                                                                                        \
+    }                                                                                                                  \
+                                                                                                                       \
+    template <typename T, enable_if_integer<T> = 0>                                                                    \
+    friend XENONIS_CONSTEXPR bool operator op(T n, const bigint& b) noexcept                                           \
+    {                                                                                                                  \
+        return 0 op b.compare(n);                                                                                      \
+    }
+
+        BIGINT_COMPARISON_OPERATOR_IMPL(!=)
+        BIGINT_COMPARISON_OPERATOR_IMPL(<)
+        BIGINT_COMPARISON_OPERATOR_IMPL(>)
+        BIGINT_COMPARISON_OPERATOR_IMPL(<=)
+        BIGINT_COMPARISON_OPERATOR_IMPL(>=)
+
+#undef BIGINT_COMPARISON_OPERATOR_IMPL
+#endif
+
+        XENONIS_CONSTEXPR std::string to_string(bool lower_case = true) const
         {
             return algorithms::to_string<Value, Container>(m_data, m_sign, lower_case);
         }
 
-        inline size_type size() const noexcept { return m_data.size() * sizeof(Value); }
-        const Container& data() const noexcept { return m_data; }
+        /*!
+         *  \returns the decimal representation, see algorithms::to_decimal_string
+         */
+        XENONIS_CONSTEXPR std::string to_decimal_string() const
+        {
+            return algorithms::to_decimal_string<Value, Container>(m_data, m_sign);
+        }
+
+        XENONIS_CONSTEXPR bool is_zero() const noexcept
+        {
+            return m_data.empty() || (m_data.size() == 1 && m_data.front() == 0);
+        }
+        XENONIS_CONSTEXPR bool is_negative() const noexcept { return m_sign; }
+
+        /*!
+         *  \returns the hash of the limbs and the sign, equal values have equal hashes for all limb widths. See
+         *  algorithms::hash.
+         */
+        XENONIS_CONSTEXPR std::size_t hash() const noexcept
+        {
+            return static_cast<std::size_t>(algorithms::hash(m_data.cbegin(), m_data.cend(), m_sign));
+        }
+
+        XENONIS_CONSTEXPR inline size_type size() const noexcept { return m_data.size() * sizeof(Value); }
+        XENONIS_CONSTEXPR const Container& data() const noexcept { return m_data; }
 
-        virtual ~bigint() = default;
     };
 
     // operator implementations
@@ -375,6 +758,39 @@ namespace xenonis {
     using bigint16 = internal::bigint<std::uint16_t, internal::bigint_data<std::uint16_t>>;
     using bigint8 = internal::bigint<std::uint8_t, internal::bigint_data<std::uint8_t>>;
     using bigint =
-        std::conditional_t<std::is_same_v<typename traits::uinteger<std::uintmax_t>::doubled, void>,
+        std::conditional_t<!std::is_same_v<typename traits::uinteger<std::uintmax_t>::doubled, void>,
                            internal::bigint<std::uintmax_t, internal::bigint_data<std::uintmax_t>>, bigint32>;
+
+    // the limbs are stored out of line, a bigint consists of a pointer, the 32-bit size and capacity and the sign
+    static_assert(sizeof(bigint) <= 24, "bigint is larger than expected");
+
+    /*!
+     *  \returns base^exp, see bigint::pow
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR internal::bigint<Value, Container> pow(const internal::bigint<Value, Container>& base,
+                                                             std::uint64_t exp)
+    {
+        return base.pow(exp);
+    }
+
+    /*!
+     *  \returns the greatest common divisor of |a| and |b|, gcd(0, 0) is 0. See algorithms::gcd.
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR internal::bigint<Value, Container> gcd(const internal::bigint<Value, Container>& a,
+                                                             const internal::bigint<Value, Container>& b)
+    {
+        return internal::bigint<Value, Container>(
+            algorithms::gcd<Container>(a.data().cbegin(), a.data().cend(), b.data().cbegin(), b.data().cend()));
+    }
 } // namespace xenonis
+
+namespace std {
+    /*!
+     *  Hashes bigints of all limb widths, see bigint::hash.
+     */
+    template <typename Value, class Container> struct hash<xenonis::internal::bigint<Value, Container>> {
+        std::size_t operator()(const xenonis::internal::bigint<Value, Container>& n) const noexcept { return n.hash(); }
+    };
+} // namespace std
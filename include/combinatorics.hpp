@@ -0,0 +1,218 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file combinatorics.hpp
+ *  \brief Products of sequences, factorials and binomial coefficients.
+ */
+#pragma once
+
+#include "algorithms/bitwise.hpp"
+#include "bigint.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace xenonis {
+    /*!
+     *  Multiplies all elements of [first, last) and returns the result.
+     *  \details Uses a balanced product tree, so that all multiplications have operands of about the same size and
+     *  can benefit from the Karatsuba multiplication. Machine integers are first packed into limb sized chunks. The
+     *  subtrees may be evaluated in parallel using up to threads threads.
+     *  \param first iterator pointing to the first element, the elements have to be either bigints or integers.
+     *  \param last iterator pointing to the last element.
+     *  \param threads the maximum number of threads used
+     *  \returns the product, 1 for an empty sequence
+     */
+    template <class Bigint = bigint, class InIter> Bigint product(InIter first, InIter last, unsigned threads = 1);
+
+    /*!
+     *  Calculates n!.
+     *  \details Uses the prime swing algorithm by Peter Luschny: n! = (n / 2)!^2 * swing(n), where the swing is built
+     *  from its prime factorization. The odd part of n! is calculated first and the power of two is applied by a
+     *  shift. Requires O(n) memory for the prime sieve.
+     *  \param threads the maximum number of threads used by the product trees
+     */
+    template <class Bigint = bigint> Bigint factorial(std::uint64_t n, unsigned threads = 1);
+
+    /*!
+     *  Calculates the binomial coefficient (n choose k).
+     *  \details The exponent of each prime is determined using Kummer's theorem, so no division is required. Requires
+     *  O(n) memory for the prime sieve.
+     *  \param threads the maximum number of threads used by the product tree
+     *  \returns the binomial coefficient, 0 if k > n
+     */
+    template <class Bigint = bigint> Bigint binomial(std::uint64_t n, std::uint64_t k, unsigned threads = 1);
+
+    namespace internal {
+        // subtrees with fewer leaves are always evaluated sequentially
+        constexpr std::ptrdiff_t parallel_product_threshold{64};
+
+        template <class Bigint, class InIter> Bigint product_tree(InIter first, InIter last, unsigned threads)
+        {
+            const auto size{std::distance(first, last)};
+
+            if (size == 0)
+                return Bigint(1);
+            if (size == 1)
+                return Bigint(*first);
+            if (size == 2) {
+                Bigint ret(*first);
+                ret *= Bigint(*std::next(first));
+                return ret;
+            }
+
+            const auto middle{std::next(first, size / 2)};
+            if (threads > 1 && size >= parallel_product_threshold) {
+                auto low{std::async(std::launch::async,
+                                    [first, middle, threads]() { return product_tree<Bigint>(first, middle, threads / 2); })};
+                auto high{product_tree<Bigint>(middle, last, threads - threads / 2)};
+                auto ret{low.get()};
+                ret *= high;
+                return ret;
+            }
+
+            auto ret{product_tree<Bigint>(first, middle, 1)};
+            ret *= product_tree<Bigint>(middle, last, 1);
+            return ret;
+        }
+
+        // returns the primes <= n
+        inline std::vector<std::uint64_t> primes(std::uint64_t n)
+        {
+            std::vector<std::uint64_t> ret;
+            if (n < 2)
+                return ret;
+
+            // sieve of Eratosthenes on the odd numbers, sieve[i] represents 2 * i + 1
+            std::vector<bool> composite(static_cast<std::size_t>(n / 2 + 1), false);
+            ret.push_back(2);
+            for (std::uint64_t i{3}; i <= n; i += 2) {
+                if (composite[static_cast<std::size_t>(i / 2)])
+                    continue;
+                ret.push_back(i);
+                for (std::uint64_t j{i * i}; j <= n; j += 2 * i)
+                    composite[static_cast<std::size_t>(j / 2)] = true;
+            }
+            return ret;
+        }
+
+        // returns the odd part of n! / (n / 2)!^2 as a list of factors, primes has to contain all primes <= n
+        inline std::vector<std::uint64_t> odd_swing_factors(std::uint64_t n, const std::vector<std::uint64_t>& primes)
+        {
+            std::vector<std::uint64_t> ret;
+            std::uint64_t sqrt_n{0};
+            while ((sqrt_n + 1) * (sqrt_n + 1) <= n)
+                ++sqrt_n;
+
+            for (auto first{primes.cbegin() + 1}; first != primes.cend() && *first <= n; ++first) {
+                const auto p{*first};
+                if (p > n / 2) { // n / 2 < p <= n: exponent 1
+                    ret.push_back(p);
+                } else if (p > n / 3) { // n / 3 < p <= n / 2: exponent 0
+                    continue;
+                } else if (p > sqrt_n) { // sqrt(n) < p <= n / 3: exponent (n / p) mod 2
+                    if ((n / p) % 2 == 1)
+                        ret.push_back(p);
+                } else { // the exponent is the sum of (n / p^i) mod 2
+                    std::uint64_t factor{1};
+                    for (auto q{n / p}; q != 0; q /= p) {
+                        if (q % 2 == 1)
+                            factor *= p;
+                    }
+                    if (factor != 1)
+                        ret.push_back(factor);
+                }
+            }
+            return ret;
+        }
+
+        template <class Bigint>
+        Bigint odd_factorial(std::uint64_t n, const std::vector<std::uint64_t>& primes, unsigned threads)
+        {
+            if (n < 2)
+                return Bigint(1);
+
+            auto ret{odd_factorial<Bigint>(n / 2, primes, threads)};
+            ret *= ret;
+
+            const auto factors{odd_swing_factors(n, primes)};
+            ret *= product<Bigint>(factors.cbegin(), factors.cend(), threads);
+            return ret;
+        }
+    } // namespace internal
+
+    template <class Bigint, class InIter> Bigint product(InIter first, InIter last, unsigned threads)
+    {
+        using value_type = typename std::iterator_traits<InIter>::value_type;
+
+        if constexpr (std::is_integral_v<value_type>) {
+            // pack the integers into chunks which fit into 64 bits to reduce the number of leaves
+            std::vector<std::uint64_t> chunks;
+            bool sign{false};
+            std::uint64_t chunk{1};
+            for (; first != last; ++first) {
+                const auto n{*first};
+                auto u{static_cast<std::uint64_t>(n)};
+                if constexpr (std::is_signed_v<value_type>) {
+                    if (n < 0) {
+                        sign = !sign;
+                        u = 0 - u;
+                    }
+                }
+                if (u == 0)
+                    return Bigint(0);
+                if (chunk > std::numeric_limits<std::uint64_t>::max() / u) {
+                    chunks.push_back(chunk);
+                    chunk = 1;
+                }
+                chunk *= u;
+            }
+            chunks.push_back(chunk);
+
+            auto ret{internal::product_tree<Bigint>(chunks.cbegin(), chunks.cend(), threads)};
+            return sign ? -ret : ret;
+        } else {
+            return internal::product_tree<Bigint>(first, last, threads);
+        }
+    }
+
+    template <class Bigint> Bigint factorial(std::uint64_t n, unsigned threads)
+    {
+        const auto primes{internal::primes(n)};
+        // the exponent of 2 in n! is n - popcount(n)
+        return internal::odd_factorial<Bigint>(n, primes, threads) << (n - algorithms::popcount(n));
+    }
+
+    template <class Bigint> Bigint binomial(std::uint64_t n, std::uint64_t k, unsigned threads)
+    {
+        if (k > n)
+            return Bigint(0);
+
+        // Kummer: the exponent of p is the number of carries when adding k and n - k in base p
+        std::vector<std::uint64_t> factors;
+        for (const auto p : internal::primes(n)) {
+            std::uint64_t factor{1};
+            bool carry{false};
+            for (std::uint64_t a{k}, b{n - k}; a != 0 || b != 0; a /= p, b /= p) {
+                carry = a % p + b % p + carry >= p;
+                if (carry)
+                    factor *= p;
+            }
+            if (factor != 1)
+                factors.push_back(factor);
+        }
+
+        return product<Bigint>(factors.cbegin(), factors.cend(), threads);
+    }
+} // namespace xenonis
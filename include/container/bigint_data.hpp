@@ -8,64 +8,109 @@
 
 #pragma once
 
+#include "bigint_config.hpp"
+#include "../stats.hpp"
+
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 
 namespace xenonis::internal {
-    template <typename Value, class Allocator = std::allocator<Value>> class bigint_data {
+    /*!
+     *  The limbs of a bigint. The size and the capacity are stored as 32-bit integers and the (usually empty)
+     *  allocator is a base class, so that a bigint_data takes only 16 bytes on 64-bit platforms.
+     */
+    template <typename Value, class Allocator = std::allocator<Value>> class bigint_data : private Allocator {
         using size_type = std::size_t;
-        Allocator m_alloc;
-        size_type m_size{0};
-        size_type m_capacity{0};
+        using stored_size_type = std::uint32_t;
         Value* m_ptr{nullptr};
-        auto allocate(size_type size)
+        stored_size_type m_size{0};
+        stored_size_type m_capacity{0};
+        XENONIS_CONSTEXPR auto allocate(size_type size)
         {
-            return m_alloc.allocate(size);
+            if (size > std::numeric_limits<stored_size_type>::max())
+                throw std::length_error("Too many limbs!");
+
+            auto* ret{static_cast<Allocator&>(*this).allocate(size)};
+            XENONIS_STATS_ALLOCATION(size * sizeof(Value));
+#if defined(XENONIS_CONSTEXPR_BIGINT)
+            // only objects within their lifetime may be accessed during constant evaluation
+            if (std::is_constant_evaluated()) {
+                for (size_type i{0}; i < size; ++i)
+                    std::construct_at(ret + i);
+            }
+#endif
+            return ret;
+        }
+        XENONIS_CONSTEXPR void deallocate()
+        {
+            if (m_ptr != nullptr)
+                static_cast<Allocator&>(*this).deallocate(m_ptr, m_capacity);
+        }
+        XENONIS_CONSTEXPR void reallocate(size_type new_capacity)
+        {
+            XENONIS_STATS_EVENT(reallocation);
+            auto* tmp{allocate(new_capacity)};
+            std::copy(begin(), end(), tmp);
+            deallocate();
+            m_ptr = tmp;
+            m_capacity = static_cast<stored_size_type>(new_capacity);
         }
-        void deallocate()
+        // grows geometrically, so that growing repeatedly by a few limbs needs only O(log n) allocations
+        XENONIS_CONSTEXPR void grow(size_type min_capacity)
         {
-            m_alloc.deallocate(m_ptr, m_capacity);
+            constexpr size_type max_capacity{std::numeric_limits<stored_size_type>::max()};
+            reallocate(std::max(min_capacity, std::min(size_type{m_capacity} * 2, max_capacity)));
         }
 
       public:
-        bigint_data() : m_size(0), m_capacity(0), m_ptr(nullptr) {}
+        XENONIS_CONSTEXPR bigint_data() : m_ptr(nullptr), m_size(0), m_capacity(0) {}
 
-        bigint_data(size_type n) : m_size(n), m_capacity(n), m_ptr(allocate(n)) {}
+        XENONIS_CONSTEXPR bigint_data(size_type n)
+            : m_ptr(allocate(n)), m_size(static_cast<stored_size_type>(n)),
+              m_capacity(static_cast<stored_size_type>(n))
+        {
+        }
 
-        bigint_data(size_type n, Value val) : bigint_data(n) { std::fill(begin(), end(), val); }
+        XENONIS_CONSTEXPR bigint_data(size_type n, Value val) : bigint_data(n) { std::fill(begin(), end(), val); }
 
-        bigint_data(const bigint_data& other)
-            : m_size(other.m_size), m_capacity(other.m_capacity),
-              m_ptr(allocate(other.m_capacity))
+        XENONIS_CONSTEXPR bigint_data(const bigint_data& other)
+            : Allocator(other), m_ptr(allocate(other.m_size)), m_size(other.m_size), m_capacity(other.m_size)
         {
             std::copy(other.cbegin(), other.cend(), begin());
         }
 
-        bigint_data(bigint_data&& other)
-            : m_size(other.m_size), m_capacity(other.m_capacity), m_ptr(other.m_ptr)
+        XENONIS_CONSTEXPR bigint_data(bigint_data&& other)
+            : Allocator(std::move(other)), m_ptr(other.m_ptr), m_size(other.m_size), m_capacity(other.m_capacity)
         {
             other.m_size = 0;
             other.m_capacity = 0;
             other.m_ptr = nullptr;
         }
 
-        bigint_data& operator=(const bigint_data& other)
+        XENONIS_CONSTEXPR bigint_data& operator=(const bigint_data& other)
         {
-            if (m_ptr != nullptr)
-                deallocate();
+            if (this == &other)
+                return *this;
 
-            m_ptr = allocate(other.m_capacity);
+            // reuses the memory if possible
+            if (m_capacity < other.m_size) {
+                auto* tmp{allocate(other.m_size)};
+                deallocate();
+                m_ptr = tmp;
+                m_capacity = other.m_size;
+            }
             m_size = other.m_size;
-            m_capacity = other.m_capacity;
             std::copy(other.cbegin(), other.cend(), begin());
 
             return *this;
         }
 
-        bigint_data& operator=(bigint_data&& other)
+        XENONIS_CONSTEXPR bigint_data& operator=(bigint_data&& other)
         {
             if (m_ptr != nullptr)
                 deallocate();
@@ -80,96 +125,78 @@ namespace xenonis::internal {
             return *this;
         }
 
-        void push_back(Value val)
+        /*!
+         *  Ensures that the capacity is at least new_capacity.
+         */
+        XENONIS_CONSTEXPR void reserve(size_type new_capacity)
         {
-            if (m_capacity > m_size) {
-                ++m_size;
-                m_ptr[m_size - 1] = val;
-            } else {
-                auto* tmp{allocate(m_size + 1)};
-                std::copy(begin(), end(), tmp);
-                deallocate();
-
-                m_ptr = tmp;
-                ++m_size;
-                m_capacity = m_size;
-            }
+            if (new_capacity > m_capacity)
+                reallocate(new_capacity);
         }
 
-        inline void pop_back() noexcept { --m_size; }
-        inline void pop_n(size_type n) noexcept { m_size -= n; }
-
-        void resize(size_type new_size)
+        XENONIS_CONSTEXPR void push_back(Value val)
         {
-            if (new_size < m_size) {
-                m_size = new_size;
-                return;
-            }
-
-            auto* tmp{allocate(new_size)};
-            std::copy(std::make_move_iterator(begin()), std::make_move_iterator(end()), tmp);
+            if (m_size == m_capacity)
+                grow(size_type{m_size} + 1);
+            m_ptr[m_size++] = val;
+        }
 
-            deallocate();
+        XENONIS_CONSTEXPR inline void pop_back() noexcept { --m_size; }
+        XENONIS_CONSTEXPR inline void pop_n(size_type n) noexcept { m_size -= static_cast<stored_size_type>(n); }
 
-            m_size = new_size;
-            m_capacity = new_size;
-            m_ptr = tmp;
+        /*!
+         *  Changes the size to new_size, the new elements are uninitialized. Reallocates only if new_size exceeds the
+         *  capacity.
+         */
+        XENONIS_CONSTEXPR void resize(size_type new_size)
+        {
+            if (new_size > m_capacity)
+                grow(new_size);
+            m_size = static_cast<stored_size_type>(new_size);
         }
 
-        void resize(size_type new_size, Value val)
+        XENONIS_CONSTEXPR void resize(size_type new_size, Value val)
         {
-            if (new_size < m_size) {
-                m_size = new_size;
-                return;
-            }
-
-            auto* tmp{allocate(new_size)};
-            std::copy(std::make_move_iterator(begin()), std::make_move_iterator(end()), tmp);
-
-            for (size_type i = m_size; i < new_size; ++i)
-                tmp[i] = val;
-
-            deallocate();
-
-            m_size = new_size;
-            m_capacity = new_size;
-            m_ptr = tmp;
+            const size_type old_size{m_size};
+            resize(new_size);
+            if (new_size > old_size)
+                std::fill(begin() + old_size, end(), val);
         }
 
-        inline Value& operator[](size_type i) noexcept { return m_ptr[i]; }
-        inline const Value& operator[](size_type i) const noexcept { return m_ptr[i]; }
-
-        inline Value& front() noexcept { return m_ptr[0]; }
-        inline const Value& front() const noexcept { return m_ptr[0]; }
-        inline Value& back() noexcept { return m_ptr[m_size - 1]; }
-        inline const Value& back() const noexcept { return m_ptr[m_size - 1]; }
-
-        inline Value* data() const noexcept { return m_ptr; }
-        inline auto begin() noexcept { return m_ptr; }
-        inline auto end() noexcept { return m_ptr + m_size; }
-        inline const Value* begin() const noexcept { return m_ptr; }
-        inline const Value* end() const noexcept { return m_ptr + m_size; }
-        inline const Value* cbegin() const noexcept { return m_ptr; }
-        inline const Value* cend() const noexcept { return m_ptr + m_size; }
-        inline auto rbegin() noexcept { return std::make_reverse_iterator(end()); }
-        inline auto rend() noexcept { return std::make_reverse_iterator(begin()); }
-        inline auto crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
-        inline auto crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
-
-        bool operator==(const bigint_data& other) const noexcept
+        XENONIS_CONSTEXPR inline Value& operator[](size_type i) noexcept { return m_ptr[i]; }
+        XENONIS_CONSTEXPR inline const Value& operator[](size_type i) const noexcept { return m_ptr[i]; }
+
+        XENONIS_CONSTEXPR inline Value& front() noexcept { return m_ptr[0]; }
+        XENONIS_CONSTEXPR inline const Value& front() const noexcept { return m_ptr[0]; }
+        XENONIS_CONSTEXPR inline Value& back() noexcept { return m_ptr[m_size - 1]; }
+        XENONIS_CONSTEXPR inline const Value& back() const noexcept { return m_ptr[m_size - 1]; }
+
+        XENONIS_CONSTEXPR inline Value* data() const noexcept { return m_ptr; }
+        XENONIS_CONSTEXPR inline auto begin() noexcept { return m_ptr; }
+        XENONIS_CONSTEXPR inline auto end() noexcept { return m_ptr + m_size; }
+        XENONIS_CONSTEXPR inline const Value* begin() const noexcept { return m_ptr; }
+        XENONIS_CONSTEXPR inline const Value* end() const noexcept { return m_ptr + m_size; }
+        XENONIS_CONSTEXPR inline const Value* cbegin() const noexcept { return m_ptr; }
+        XENONIS_CONSTEXPR inline const Value* cend() const noexcept { return m_ptr + m_size; }
+        XENONIS_CONSTEXPR inline auto rbegin() noexcept { return std::make_reverse_iterator(end()); }
+        XENONIS_CONSTEXPR inline auto rend() noexcept { return std::make_reverse_iterator(begin()); }
+        XENONIS_CONSTEXPR inline auto crbegin() const noexcept { return std::make_reverse_iterator(cend()); }
+        XENONIS_CONSTEXPR inline auto crend() const noexcept { return std::make_reverse_iterator(cbegin()); }
+
+        XENONIS_CONSTEXPR bool operator==(const bigint_data& other) const noexcept
         {
             if (m_size != other.m_size)
                 return false;
 
             return std::equal(other.begin(), other.end(), begin());
         }
-        bool operator!=(const bigint_data& other) const noexcept { return !operator==(other); }
+        XENONIS_CONSTEXPR bool operator!=(const bigint_data& other) const noexcept { return !operator==(other); }
 
-        inline bool empty() const noexcept { return m_size == 0; }
-        inline auto size() const noexcept { return m_size; }
-        inline auto capacity() const noexcept { return m_capacity; }
+        XENONIS_CONSTEXPR inline bool empty() const noexcept { return m_size == 0; }
+        XENONIS_CONSTEXPR inline size_type size() const noexcept { return m_size; }
+        XENONIS_CONSTEXPR inline size_type capacity() const noexcept { return m_capacity; }
 
-        ~bigint_data()
+        XENONIS_CONSTEXPR ~bigint_data()
         {
             if (m_ptr != nullptr)
                 deallocate();
@@ -0,0 +1,367 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file fixed_integer.hpp
+ *  \brief Fixed-width integers which wrap modulo 2^Bits.
+ */
+#pragma once
+
+#include "algorithms/arithmetic.hpp"
+#include "bigint.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace xenonis::internal {
+    // calls f(std::integral_constant<std::size_t, I>{}) for I = 0, ..., N - 1 without a loop
+    template <class F, std::size_t... I> constexpr void unroll(F&& f, std::index_sequence<I...>)
+    {
+        (f(std::integral_constant<std::size_t, I>{}), ...);
+    }
+
+    template <std::size_t N, class F> constexpr void unroll(F&& f) { unroll(f, std::make_index_sequence<N>{}); }
+
+    /*!
+     *  Integer with Bits bits stored in a std::array of 64-bit limbs, negative numbers of the signed variant are
+     *  stored in two's complement. All operations wrap modulo 2^Bits and never allocate. The loops over the limbs
+     *  are unrolled at compile time, the addition and multiplication are constexpr versions of add and naive_mul.
+     */
+    template <std::size_t Bits, bool Signed> class fixed_integer {
+        static_assert(Bits > 0 && Bits % 64 == 0, "Bits has to be a positive multiple of 64!");
+
+      public:
+        using value_type = std::uint64_t;
+        using size_type = std::size_t;
+        constexpr static size_type limbs{Bits / 64};
+
+      private:
+        std::array<std::uint64_t, limbs> m_data{};
+
+        // a = |a| / |b|, returns |a| % |b|, requires b != 0
+        constexpr static std::array<std::uint64_t, limbs> divmod(std::array<std::uint64_t, limbs>& a,
+                                                                   const std::array<std::uint64_t, limbs>& b) noexcept
+        {
+            // schoolbook binary long division, starting at the most significant set bit of a
+            fixed_integer<Bits, false> n, d, q, r;
+            n.m_data = a;
+            d.m_data = b;
+            for (auto i{n.bit_length()}; i-- > 0;) {
+                r <<= 1;
+                r.m_data[0] |= (n.m_data[i / 64] >> (i % 64)) & 1;
+                if (r >= d) {
+                    r -= d;
+                    q.m_data[i / 64] |= std::uint64_t{1} << (i % 64);
+                }
+            }
+            a = q.m_data;
+            return r.m_data;
+        }
+
+        template <std::size_t, bool> friend class fixed_integer;
+
+      public:
+        constexpr fixed_integer() noexcept {}
+
+        template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+        constexpr fixed_integer(T n) noexcept
+        {
+            m_data[0] = static_cast<std::uint64_t>(n);
+            if constexpr (std::is_signed_v<T>) {
+                if (n < 0) // sign extension
+                    for (size_type i{1}; i < limbs; ++i)
+                        m_data[i] = ~std::uint64_t{0};
+            }
+        }
+
+        /*!
+         *  Converts from a fixed_integer with a different width or signedness, signed numbers are sign extended.
+         */
+        template <std::size_t OtherBits, bool OtherSigned>
+        constexpr explicit fixed_integer(const fixed_integer<OtherBits, OtherSigned>& other) noexcept
+        {
+            const std::uint64_t ext{other.is_negative() ? ~std::uint64_t{0} : 0};
+            for (size_type i{0}; i < limbs; ++i)
+                m_data[i] = i < other.limbs ? other.m_data[i] : ext;
+        }
+
+        /*!
+         *  Converts n modulo 2^Bits.
+         */
+        template <typename Value, class Container>
+        XENONIS_CONSTEXPR explicit fixed_integer(const bigint<Value, Container>& n)
+        {
+            constexpr unsigned value_bits{std::numeric_limits<Value>::digits};
+            const auto& data{n.data()};
+            for (size_type k{0}; k < data.size() && k * value_bits < Bits; ++k)
+                m_data[k * value_bits / 64] |= static_cast<std::uint64_t>(data[k]) << (k * value_bits % 64);
+            if (n.is_negative())
+                *this = -*this;
+        }
+
+        template <typename Value, class Container> XENONIS_CONSTEXPR explicit operator bigint<Value, Container>() const
+        {
+            const bool sign{is_negative()};
+            const auto magnitude{sign ? -*this : *this};
+            bigint<Value, Container> ret(0);
+            for (size_type i{limbs}; i-- > 0;) {
+                ret <<= 64;
+                ret |= bigint<Value, Container>(magnitude.m_data[i]);
+            }
+            return sign ? -ret : ret;
+        }
+
+        constexpr fixed_integer& operator+=(const fixed_integer& other) noexcept
+        {
+            std::uint64_t carry{0};
+            unroll<limbs>([&](auto i) { m_data[i] = algorithms::add_carry(m_data[i], other.m_data[i], carry); });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator-=(const fixed_integer& other) noexcept
+        {
+            std::uint64_t borrow{0};
+            unroll<limbs>([&](auto i) { m_data[i] = algorithms::sub_borrow(m_data[i], other.m_data[i], borrow); });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator*=(const fixed_integer& other) noexcept
+        {
+            std::array<std::uint64_t, limbs> ret{};
+            // row by row like naive_mul, the products beyond Bits are never calculated
+            unroll<limbs>([&](auto i) {
+                std::uint64_t carry{0};
+                unroll<limbs - decltype(i)::value>([&](auto j) {
+                    auto n{algorithms::base_mul(m_data[i], other.m_data[j])};
+                    n[0] += carry;
+                    n[1] += n[0] < carry;
+                    ret[i + j] += n[0];
+                    n[1] += ret[i + j] < n[0];
+                    carry = n[1];
+                });
+            });
+            m_data = ret;
+            return *this;
+        }
+
+        /*!
+         *  Truncating division like for the builtin integers. Throws std::domain_error if other is zero.
+         */
+        constexpr fixed_integer& operator/=(const fixed_integer& other)
+        {
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+            const bool sign{is_negative() != other.is_negative()};
+            auto a{is_negative() ? -*this : *this};
+            divmod(a.m_data, (other.is_negative() ? -other : other).m_data);
+            *this = sign ? -a : a;
+            return *this;
+        }
+
+        /*!
+         *  The remainder has the sign of the dividend. Throws std::domain_error if other is zero.
+         */
+        constexpr fixed_integer& operator%=(const fixed_integer& other)
+        {
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+            const bool sign{is_negative()};
+            auto a{sign ? -*this : *this};
+            fixed_integer r;
+            r.m_data = divmod(a.m_data, (other.is_negative() ? -other : other).m_data);
+            *this = sign ? -r : r;
+            return *this;
+        }
+
+        constexpr fixed_integer& operator&=(const fixed_integer& other) noexcept
+        {
+            unroll<limbs>([&](auto i) { m_data[i] &= other.m_data[i]; });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator|=(const fixed_integer& other) noexcept
+        {
+            unroll<limbs>([&](auto i) { m_data[i] |= other.m_data[i]; });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator^=(const fixed_integer& other) noexcept
+        {
+            unroll<limbs>([&](auto i) { m_data[i] ^= other.m_data[i]; });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator<<=(size_type shift) noexcept
+        {
+            const auto limb_shift{shift / 64};
+            const auto bit_shift{static_cast<unsigned>(shift % 64)};
+            for (size_type i{limbs}; i-- > 0;) {
+                const std::uint64_t high{i >= limb_shift ? m_data[i - limb_shift] : 0};
+                const std::uint64_t low{i >= limb_shift + 1 ? m_data[i - limb_shift - 1] : 0};
+                m_data[i] = bit_shift == 0 ? high : (high << bit_shift) | (low >> (64 - bit_shift));
+            }
+            return *this;
+        }
+
+        /*!
+         *  Arithmetic shift for the signed variant, logical shift for the unsigned one.
+         */
+        constexpr fixed_integer& operator>>=(size_type shift) noexcept
+        {
+            const std::uint64_t ext{is_negative() ? ~std::uint64_t{0} : 0};
+            const auto limb_shift{shift / 64};
+            const auto bit_shift{static_cast<unsigned>(shift % 64)};
+            for (size_type i{0}; i < limbs; ++i) {
+                const std::uint64_t low{i + limb_shift < limbs ? m_data[i + limb_shift] : ext};
+                const std::uint64_t high{i + limb_shift + 1 < limbs ? m_data[i + limb_shift + 1] : ext};
+                m_data[i] = bit_shift == 0 ? low : (low >> bit_shift) | (high << (64 - bit_shift));
+            }
+            return *this;
+        }
+
+        constexpr fixed_integer& operator++() noexcept
+        {
+            std::uint64_t carry{1};
+            unroll<limbs>([&](auto i) { m_data[i] = algorithms::add_carry(m_data[i], std::uint64_t{0}, carry); });
+            return *this;
+        }
+
+        constexpr fixed_integer& operator--() noexcept
+        {
+            std::uint64_t borrow{1};
+            unroll<limbs>([&](auto i) { m_data[i] = algorithms::sub_borrow(m_data[i], std::uint64_t{0}, borrow); });
+            return *this;
+        }
+
+        constexpr fixed_integer operator++(int) noexcept
+        {
+            const auto ret{*this};
+            ++(*this);
+            return ret;
+        }
+
+        constexpr fixed_integer operator--(int) noexcept
+        {
+            const auto ret{*this};
+            --(*this);
+            return ret;
+        }
+
+        constexpr fixed_integer operator~() const noexcept
+        {
+            auto ret{*this};
+            unroll<limbs>([&](auto i) { ret.m_data[i] = ~ret.m_data[i]; });
+            return ret;
+        }
+
+        constexpr fixed_integer operator-() const noexcept { return ++(~*this); }
+
+        friend constexpr fixed_integer operator+(fixed_integer a, const fixed_integer& b) noexcept { return a += b; }
+        friend constexpr fixed_integer operator-(fixed_integer a, const fixed_integer& b) noexcept { return a -= b; }
+        friend constexpr fixed_integer operator*(fixed_integer a, const fixed_integer& b) noexcept { return a *= b; }
+        friend constexpr fixed_integer operator/(fixed_integer a, const fixed_integer& b) { return a /= b; }
+        friend constexpr fixed_integer operator%(fixed_integer a, const fixed_integer& b) { return a %= b; }
+        friend constexpr fixed_integer operator&(fixed_integer a, const fixed_integer& b) noexcept { return a &= b; }
+        friend constexpr fixed_integer operator|(fixed_integer a, const fixed_integer& b) noexcept { return a |= b; }
+        friend constexpr fixed_integer operator^(fixed_integer a, const fixed_integer& b) noexcept { return a ^= b; }
+        friend constexpr fixed_integer operator<<(fixed_integer a, size_type shift) noexcept { return a <<= shift; }
+        friend constexpr fixed_integer operator>>(fixed_integer a, size_type shift) noexcept { return a >>= shift; }
+
+        friend constexpr bool operator==(const fixed_integer& a, const fixed_integer& b) noexcept
+        {
+            bool ret{true};
+            unroll<limbs>([&](auto i) { ret &= a.m_data[i] == b.m_data[i]; });
+            return ret;
+        }
+
+        friend constexpr bool operator<(const fixed_integer& a, const fixed_integer& b) noexcept
+        {
+            if (a.is_negative() != b.is_negative())
+                return a.is_negative();
+            // equal signs: the two's complement representations compare like unsigned numbers
+            for (size_type i{limbs}; i-- > 0;) {
+                if (a.m_data[i] != b.m_data[i])
+                    return a.m_data[i] < b.m_data[i];
+            }
+            return false;
+        }
+
+        friend constexpr bool operator!=(const fixed_integer& a, const fixed_integer& b) noexcept { return !(a == b); }
+        friend constexpr bool operator>(const fixed_integer& a, const fixed_integer& b) noexcept { return b < a; }
+        friend constexpr bool operator<=(const fixed_integer& a, const fixed_integer& b) noexcept { return !(b < a); }
+        friend constexpr bool operator>=(const fixed_integer& a, const fixed_integer& b) noexcept { return !(a < b); }
+
+        constexpr bool is_negative() const noexcept { return Signed && (m_data[limbs - 1] >> 63) != 0; }
+
+        constexpr bool is_zero() const noexcept
+        {
+            std::uint64_t ret{0};
+            unroll<limbs>([&](auto i) { ret |= m_data[i]; });
+            return ret == 0;
+        }
+
+        /*!
+         *  \returns the number of significant bits of the two's complement representation interpreted as unsigned
+         */
+        constexpr size_type bit_length() const noexcept
+        {
+            for (size_type i{limbs}; i-- > 0;) {
+                if (m_data[i] != 0)
+                    return i * 64 + 64 - algorithms::count_leading_zeros(m_data[i]);
+            }
+            return 0;
+        }
+
+        constexpr const std::array<std::uint64_t, limbs>& data() const noexcept { return m_data; }
+
+        /*!
+         *  \returns the hex-string of the number, like bigint::to_string
+         */
+        std::string to_string(bool lower_case = true) const
+        {
+            const char* digits{lower_case ? "0123456789abcdef" : "0123456789ABCDEF"};
+            const bool sign{is_negative()};
+            const auto magnitude{sign ? -*this : *this};
+
+            std::string ret;
+            for (size_type i{limbs * 16}; i-- > 0;) {
+                const auto digit{(magnitude.m_data[i / 16] >> (i % 16 * 4)) & 0xf};
+                if (digit != 0 || !ret.empty())
+                    ret.push_back(digits[digit]);
+            }
+            if (ret.empty())
+                return "0";
+            return sign ? '-' + ret : ret;
+        }
+    };
+
+    template <std::size_t Bits, bool Signed>
+    std::ostream& operator<<(std::ostream& out, const fixed_integer<Bits, Signed>& n)
+    {
+        return out << n.to_string();
+    }
+} // namespace xenonis::internal
+
+namespace xenonis {
+    template <std::size_t Bits> using fixed_uint = internal::fixed_integer<Bits, false>;
+    template <std::size_t Bits> using fixed_int = internal::fixed_integer<Bits, true>;
+
+    using uint128 = fixed_uint<128>;
+    using uint256 = fixed_uint<256>;
+    using uint512 = fixed_uint<512>;
+    using uint1024 = fixed_uint<1024>;
+    using int128 = fixed_int<128>;
+    using int256 = fixed_int<256>;
+    using int512 = fixed_int<512>;
+    using int1024 = fixed_int<1024>;
+} // namespace xenonis
@@ -0,0 +1,427 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file multimod.hpp
+ *  \brief Multi-modular (residue number system) representation of bigints.
+ */
+#pragma once
+
+#include "algorithms/bitwise.hpp"
+#include "algorithms/modular.hpp"
+#include "algorithms/multimod.hpp"
+#include "bigint.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xenonis {
+    /*!
+     *  A set of pairwise coprime odd moduli m_i < 2^63 together with the precomputed data for the conversions between
+     *  bigints and their residues modulo all m_i. Numbers in [0, M), M being the product of the moduli, are represented
+     *  uniquely.
+     *  \details The moduli are stored in a product tree: the residues are calculated using a remainder tree (n is
+     *  reduced modulo the products of the subtrees from the root to the leaves) and the number is reconstructed using
+     *  the Chinese remainder theorem, where the sum of c_i * M / m_i is evaluated in the same tree. Both take
+     *  O(M(n) log(count)) time.
+     */
+    template <class Bigint = bigint> class multimod_basis {
+      public:
+        using size_type = std::size_t;
+
+        /*!
+         *  Uses the count largest primes below 2^63 as moduli.
+         */
+        explicit multimod_basis(size_type count);
+
+        /*!
+         *  Uses the given moduli. Throws std::invalid_argument if a modulus is even, less than 3 or not less than 2^63
+         *  or if the moduli are not pairwise coprime.
+         */
+        explicit multimod_basis(std::vector<std::uint64_t> moduli);
+
+        size_type size() const noexcept { return m_moduli.size(); }
+        const std::vector<std::uint64_t>& moduli() const noexcept { return m_moduli; }
+
+        /*!
+         *  \returns M, the product of all moduli
+         */
+        const Bigint& product() const noexcept { return m_tree.back().front(); }
+
+        /*!
+         *  \returns n mod m_i for all moduli, negative numbers are reduced into [0, M) first
+         */
+        std::vector<std::uint64_t> residues(const Bigint& n) const;
+
+        /*!
+         *  \returns the number in [0, M) with the residues r_i mod m_i
+         */
+        Bigint reconstruct(const std::vector<std::uint64_t>& residues) const;
+
+      private:
+        template <class> friend class multimod;
+
+        std::vector<std::uint64_t> m_moduli;
+        // -m_i^(-1) mod 2^64
+        std::vector<std::uint64_t> m_inverses;
+        // 2^128 mod m_i, converts residues into the Montgomery representation
+        std::vector<std::uint64_t> m_squares;
+        // (M / m_i)^(-1) mod m_i
+        std::vector<std::uint64_t> m_crt;
+        // m_tree[0] contains the moduli, every element of m_tree[l + 1] is the product of two elements of m_tree[l]
+        // (the last one may be taken over alone), m_tree.back() contains M
+        std::vector<std::vector<Bigint>> m_tree;
+
+        std::vector<Bigint> remainders(Bigint n, bool squared) const;
+        Bigint crt(const std::vector<std::uint64_t>& c) const;
+    };
+
+    /*!
+     *  A number modulo M, the product of the moduli of a multimod_basis, stored as its residues. The residue-wise
+     *  addition, subtraction and multiplication need neither carries nor allocations and are vectorised over the
+     *  moduli.
+     *  \details The residues are kept in the Montgomery representation. The basis has to outlive the numbers and the
+     *  operands of an operation have to use the same basis object.
+     */
+    template <class Bigint = bigint> class multimod {
+      public:
+        using basis_type = multimod_basis<Bigint>;
+        using size_type = std::size_t;
+
+      private:
+        const basis_type* m_basis{nullptr};
+        std::vector<std::uint64_t> m_residues;
+
+        void check_basis(const multimod& other) const
+        {
+            if (m_basis != other.m_basis)
+                throw std::invalid_argument("Multimod bases do not match!");
+        }
+
+      public:
+        multimod() noexcept {}
+
+        /*!
+         *  Stores n mod M.
+         */
+        multimod(const Bigint& n, const basis_type& basis);
+
+        const basis_type& basis() const noexcept { return *m_basis; }
+        size_type size() const noexcept { return m_residues.size(); }
+
+        /*!
+         *  \returns the residue modulo the modulus i of the basis
+         */
+        std::uint64_t residue(size_type i) const noexcept
+        {
+            return algorithms::montgomery_mul_1(m_residues[i], 1, m_basis->m_moduli[i], m_basis->m_inverses[i]);
+        }
+
+        /*!
+         *  \returns the number in [0, M)
+         */
+        Bigint to_bigint() const;
+
+        /*!
+         *  \returns the number in (-M / 2, M / 2]
+         */
+        Bigint to_signed_bigint() const;
+
+        multimod& operator+=(const multimod& other)
+        {
+            check_basis(other);
+            algorithms::multimod_add(m_residues.cbegin(), m_residues.cend(), other.m_residues.cbegin(),
+                                     m_basis->m_moduli.cbegin(), m_residues.begin());
+            return *this;
+        }
+
+        multimod& operator-=(const multimod& other)
+        {
+            check_basis(other);
+            algorithms::multimod_sub(m_residues.cbegin(), m_residues.cend(), other.m_residues.cbegin(),
+                                     m_basis->m_moduli.cbegin(), m_residues.begin());
+            return *this;
+        }
+
+        multimod& operator*=(const multimod& other)
+        {
+            check_basis(other);
+            algorithms::multimod_mul(m_residues.cbegin(), m_residues.cend(), other.m_residues.cbegin(),
+                                     m_basis->m_moduli.cbegin(), m_basis->m_inverses.cbegin(), m_residues.begin());
+            return *this;
+        }
+
+        multimod operator-() const
+        {
+            auto tmp{*this};
+            for (size_type i{0}; i < size(); ++i) {
+                const auto r{m_residues[i]};
+                tmp.m_residues[i] = (m_basis->m_moduli[i] - r) & (0 - static_cast<std::uint64_t>(r != 0));
+            }
+            return tmp;
+        }
+
+        friend multimod operator+(multimod a, const multimod& b)
+        {
+            a += b;
+            return a;
+        }
+
+        friend multimod operator-(multimod a, const multimod& b)
+        {
+            a -= b;
+            return a;
+        }
+
+        friend multimod operator*(multimod a, const multimod& b)
+        {
+            a *= b;
+            return a;
+        }
+
+        // the Montgomery representation is unique, so the residues can be compared directly
+        friend bool operator==(const multimod& a, const multimod& b)
+        {
+            a.check_basis(b);
+            return a.m_residues == b.m_residues;
+        }
+
+        friend bool operator!=(const multimod& a, const multimod& b) { return !(a == b); }
+    };
+
+    namespace internal {
+        // deterministic Miller-Rabin test for odd n < 2^63 using the bases of Jim Sinclair, which are sufficient for
+        // all n < 2^64
+        inline bool is_prime_63(std::uint64_t n) noexcept
+        {
+            for (const std::uint64_t p : {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47}) {
+                if (n % p == 0)
+                    return n == p;
+            }
+
+            const auto m_inv{algorithms::montgomery_inverse(n)};
+            const auto one{(0 - n) % n}; // 2^64 mod n
+            const auto minus_one{n - one};
+            auto square{one};
+            for (unsigned i{0}; i < 64; ++i)
+                square = algorithms::internal::reduce_once(square << 1, n);
+
+            const auto s{algorithms::count_trailing_zeros(n - 1)};
+            const auto d{(n - 1) >> s};
+            for (const std::uint64_t a : {2, 325, 9375, 28178, 450775, 9780504, 1795265022}) {
+                if (a % n == 0)
+                    continue;
+
+                auto x{one};
+                const auto base{algorithms::montgomery_mul_1(a % n, square, n, m_inv)};
+                for (auto i{64 - algorithms::count_leading_zeros(d)}; i-- > 0;) {
+                    x = algorithms::montgomery_mul_1(x, x, n, m_inv);
+                    if ((d >> i) & 1)
+                        x = algorithms::montgomery_mul_1(x, base, n, m_inv);
+                }
+                if (x == one || x == minus_one)
+                    continue;
+
+                bool composite{true};
+                for (unsigned i{1}; i < s && composite; ++i) {
+                    x = algorithms::montgomery_mul_1(x, x, n, m_inv);
+                    composite = x != minus_one;
+                }
+                if (composite)
+                    return false;
+            }
+            return true;
+        }
+
+        // the count largest primes below 2^63 in descending order
+        inline std::vector<std::uint64_t> primes_below_2_63(std::size_t count)
+        {
+            std::vector<std::uint64_t> ret;
+            ret.reserve(count);
+            for (std::uint64_t n{(std::uint64_t{1} << 63) - 1}; ret.size() < count; n -= 2) {
+                if (is_prime_63(n))
+                    ret.push_back(n);
+            }
+            return ret;
+        }
+
+        // n^(-1) mod m, 0 if gcd(n, m) != 1
+        inline std::uint64_t inverse_63(std::uint64_t n, std::uint64_t m) noexcept
+        {
+            // extended Euclidean algorithm, all values are less than 2^63
+            std::int64_t t{0}, new_t{1};
+            auto r{static_cast<std::int64_t>(m)}, new_r{static_cast<std::int64_t>(n % m)};
+            while (new_r != 0) {
+                const auto q{r / new_r};
+                t = std::exchange(new_t, t - q * new_t);
+                r = std::exchange(new_r, r - q * new_r);
+            }
+            if (r != 1)
+                return 0;
+            return static_cast<std::uint64_t>(t < 0 ? t + static_cast<std::int64_t>(m) : t);
+        }
+
+        // n has to be less than 2^64
+        template <class Bigint> std::uint64_t to_uint64(const Bigint& n) noexcept
+        {
+            const auto& data{n.data()};
+            constexpr unsigned limb_bits{
+                std::numeric_limits<std::remove_const_t<std::remove_reference_t<decltype(data[0])>>>::digits};
+
+            std::uint64_t ret{0};
+            for (std::size_t i{0}; i < data.size(); ++i)
+                ret |= static_cast<std::uint64_t>(data[i]) << (i * limb_bits);
+            return ret;
+        }
+    } // namespace internal
+
+    template <class Bigint>
+    multimod_basis<Bigint>::multimod_basis(size_type count) : multimod_basis(internal::primes_below_2_63(count))
+    {
+    }
+
+    template <class Bigint>
+    multimod_basis<Bigint>::multimod_basis(std::vector<std::uint64_t> moduli) : m_moduli(std::move(moduli))
+    {
+        if (m_moduli.empty())
+            throw std::invalid_argument("No moduli!");
+
+        for (const auto m : m_moduli) {
+            if (m % 2 == 0 || m < 3 || (m >> 63) != 0)
+                throw std::invalid_argument("Invalid modulus!");
+
+            m_inverses.push_back(algorithms::montgomery_inverse(m));
+            auto square{(0 - m) % m};
+            for (unsigned i{0}; i < 64; ++i)
+                square = algorithms::internal::reduce_once(square << 1, m);
+            m_squares.push_back(square);
+        }
+
+        m_tree.emplace_back(m_moduli.cbegin(), m_moduli.cend());
+        while (m_tree.back().size() > 1) {
+            const auto& level{m_tree.back()};
+            std::vector<Bigint> next;
+            for (size_type i{0}; i + 1 < level.size(); i += 2)
+                next.push_back(level[i] * level[i + 1]);
+            if (level.size() % 2 == 1)
+                next.push_back(level.back());
+            m_tree.push_back(std::move(next));
+        }
+
+        // M mod m_i^2 == m_i * ((M / m_i) mod m_i)
+        const auto rems{remainders(product(), true)};
+        for (size_type i{0}; i < size(); ++i) {
+            const auto m{m_moduli[i]};
+            const auto inv{internal::inverse_63(internal::to_uint64(rems[i] / Bigint(m)), m)};
+            if (inv == 0)
+                throw std::invalid_argument("Moduli not coprime!");
+            m_crt.push_back(inv);
+        }
+    }
+
+    template <class Bigint> std::vector<Bigint> multimod_basis<Bigint>::remainders(Bigint n, bool squared) const
+    {
+        std::vector<Bigint> rems;
+        rems.push_back(std::move(n));
+        for (auto level{m_tree.size() - 1}; level-- > 0;) {
+            std::vector<Bigint> next(m_tree[level].size());
+            for (size_type i{0}; i < next.size(); ++i) {
+                const auto& parent{rems[i / 2]};
+                const auto& node{m_tree[level][i]};
+                if (squared)
+                    next[i] = parent % (node * node);
+                else // the upper levels are skipped for numbers which are small compared to M
+                    next[i] = parent < node ? parent : parent % node;
+            }
+            rems = std::move(next);
+        }
+        return rems;
+    }
+
+    template <class Bigint>
+    std::vector<std::uint64_t> multimod_basis<Bigint>::residues(const Bigint& n) const
+    {
+        auto r{n};
+        if (r.is_negative() || !(r < product())) {
+            r %= product();
+            if (r.is_negative())
+                r += product();
+        }
+
+        const auto rems{remainders(std::move(r), false)};
+        std::vector<std::uint64_t> ret(size());
+        for (size_type i{0}; i < size(); ++i)
+            ret[i] = internal::to_uint64(rems[i]);
+        return ret;
+    }
+
+    template <class Bigint> Bigint multimod_basis<Bigint>::crt(const std::vector<std::uint64_t>& c) const
+    {
+        // the sum of c_i * M / m_i: the value of a node is left * product(right) + right * product(left)
+        std::vector<Bigint> values(c.cbegin(), c.cend());
+        for (size_type level{0}; level + 1 < m_tree.size(); ++level) {
+            const auto& nodes{m_tree[level]};
+            std::vector<Bigint> next;
+            for (size_type i{0}; i + 1 < values.size(); i += 2) {
+                auto value{values[i] * nodes[i + 1]};
+                value.addmul(values[i + 1], nodes[i]);
+                next.push_back(std::move(value));
+            }
+            if (values.size() % 2 == 1)
+                next.push_back(std::move(values.back()));
+            values = std::move(next);
+        }
+        // the sum is less than count * M
+        return values.front() % product();
+    }
+
+    template <class Bigint>
+    Bigint multimod_basis<Bigint>::reconstruct(const std::vector<std::uint64_t>& residues) const
+    {
+        if (residues.size() != size())
+            throw std::invalid_argument("Wrong number of residues!");
+
+        // c_i = r_i * (M / m_i)^(-1) mod m_i, the residues are converted into the Montgomery representation first
+        std::vector<std::uint64_t> c(size());
+        for (size_type i{0}; i < size(); ++i) {
+            const auto m{m_moduli[i]}, m_inv{m_inverses[i]};
+            const auto r{algorithms::montgomery_mul_1(residues[i] % m, m_squares[i], m, m_inv)};
+            c[i] = algorithms::montgomery_mul_1(r, m_crt[i], m, m_inv);
+        }
+        return crt(c);
+    }
+
+    template <class Bigint>
+    multimod<Bigint>::multimod(const Bigint& n, const basis_type& basis)
+        : m_basis(&basis), m_residues(basis.residues(n))
+    {
+        algorithms::multimod_mul(m_residues.cbegin(), m_residues.cend(), basis.m_squares.cbegin(),
+                                 basis.m_moduli.cbegin(), basis.m_inverses.cbegin(), m_residues.begin());
+    }
+
+    template <class Bigint> Bigint multimod<Bigint>::to_bigint() const
+    {
+        // the factor 2^64 of the Montgomery representation is removed by the multiplication
+        std::vector<std::uint64_t> c(size());
+        algorithms::multimod_mul(m_residues.cbegin(), m_residues.cend(), m_basis->m_crt.cbegin(),
+                                 m_basis->m_moduli.cbegin(), m_basis->m_inverses.cbegin(), c.begin());
+        return m_basis->crt(c);
+    }
+
+    template <class Bigint> Bigint multimod<Bigint>::to_signed_bigint() const
+    {
+        auto ret{to_bigint()};
+        if (ret > (m_basis->product() >> 1))
+            ret -= m_basis->product();
+        return ret;
+    }
+} // namespace xenonis
@@ -0,0 +1,347 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file prime.hpp
+ *  \brief Probabilistic primality test and the search of the next prime.
+ */
+#pragma once
+
+#include "algorithms/modular.hpp"
+#include "bigint.hpp"
+#include "random.hpp"
+#include "roots.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xenonis {
+    /*!
+     *  Tests whether n is a probable prime.
+     *  \details Uses trial division by the small primes, which decides the test for n < 2^30, and the Baillie-PSW test
+     *  (a Miller-Rabin test to base 2 followed by a strong Lucas test with the parameters of Selfridge). No composite
+     *  number passing the Baillie-PSW test is known. Additional Miller-Rabin tests with random bases can be requested.
+     *  \param rounds the number of additional Miller-Rabin tests with random bases
+     *  \param engine the random number generator which chooses the bases, an UniformRandomBitGenerator
+     *  \returns false if n is composite, true if n is prime or a pseudoprime to all tests
+     */
+    template <typename Value, class Container, class URBG>
+    bool is_probable_prime(const internal::bigint<Value, Container>& n, unsigned rounds, URBG& engine);
+
+    /*!
+     *  Tests whether n is a probable prime, see above. The random bases are chosen by a xoshiro256x4 with a fixed
+     *  seed, so that the result is reproducible.
+     */
+    template <typename Value, class Container>
+    bool is_probable_prime(const internal::bigint<Value, Container>& n, unsigned rounds = 0);
+
+    /*!
+     *  Returns the smallest probable prime greater than n (see is_probable_prime).
+     *  \details The candidates are sieved in blocks using their residues modulo the small primes, so that only the
+     *  candidates without a small factor are tested using the Baillie-PSW test.
+     */
+    template <typename Value, class Container>
+    internal::bigint<Value, Container> next_prime(const internal::bigint<Value, Container>& n);
+
+    namespace internal {
+        // the odd primes below this limit are used for the trial division and the sieve
+        constexpr std::uint32_t small_prime_limit{1 << 15};
+
+        // the number of odd candidates sieved at once by next_prime
+        constexpr std::size_t prime_sieve_size{4096};
+
+        // the odd primes below small_prime_limit, grouped so that the product of each group fits into 32 bits
+        struct small_prime_table {
+            std::vector<std::uint32_t> primes;
+            std::vector<std::uint32_t> products;
+            std::vector<std::size_t> group_ends; // the group i consists of primes[group_ends[i - 1], group_ends[i])
+
+            small_prime_table()
+            {
+                std::vector<bool> composite(small_prime_limit, false);
+                for (std::uint32_t i{3}; i < small_prime_limit; i += 2) {
+                    if (composite[i])
+                        continue;
+                    primes.push_back(i);
+                    for (auto j{i * i}; j < small_prime_limit; j += 2 * i)
+                        composite[j] = true;
+                }
+
+                std::uint64_t product{1};
+                for (std::size_t i{0}; i < primes.size(); ++i) {
+                    if (product * primes[i] > 0xffffffff) {
+                        products.push_back(static_cast<std::uint32_t>(product));
+                        group_ends.push_back(i);
+                        product = 1;
+                    }
+                    product *= primes[i];
+                }
+                products.push_back(static_cast<std::uint32_t>(product));
+                group_ends.push_back(primes.size());
+            }
+        };
+
+        inline const small_prime_table& small_primes()
+        {
+            static const small_prime_table table;
+            return table;
+        }
+
+        // returns n mod p for all small primes p, one division of n per group of primes
+        template <typename Value, class Container>
+        std::vector<std::uint32_t> small_prime_residues(const bigint<Value, Container>& n)
+        {
+            const auto& table{small_primes()};
+            std::vector<std::uint32_t> ret(table.primes.size());
+
+            std::size_t i{0};
+            for (std::size_t group{0}; group < table.products.size(); ++group) {
+                const auto r{algorithms::mod_small(n.data().cbegin(), n.data().cend(), table.products[group])};
+                for (; i < table.group_ends[group]; ++i)
+                    ret[i] = r % table.primes[i];
+            }
+            return ret;
+        }
+
+        // returns the Jacobi symbol (a / n) for odd n
+        inline int jacobi(std::uint64_t a, std::uint64_t n) noexcept
+        {
+            int ret{1};
+            a %= n;
+            while (a != 0) {
+                for (; a % 2 == 0; a /= 2) {
+                    if (n % 8 == 3 || n % 8 == 5)
+                        ret = -ret;
+                }
+                std::swap(a, n);
+                if (a % 4 == 3 && n % 4 == 3)
+                    ret = -ret;
+                a %= n;
+            }
+            return n == 1 ? ret : 0;
+        }
+
+        // returns the Jacobi symbol (d / n) for odd n > |d|
+        template <typename Value, class Container> int jacobi(std::int64_t d, const bigint<Value, Container>& n)
+        {
+            const auto n_low{static_cast<std::uint32_t>(n.data().front() % 8)};
+            int ret{1};
+            auto a{static_cast<std::uint64_t>(d < 0 ? -d : d)};
+            // (-1 / n) = -1 if n == 3 mod 4
+            if (d < 0 && n_low % 4 == 3)
+                ret = -ret;
+            // (2 / n) = -1 if n == 3, 5 mod 8
+            for (; a % 2 == 0; a /= 2) {
+                if (n_low == 3 || n_low == 5)
+                    ret = -ret;
+            }
+            // quadratic reciprocity: (a / n) = (n / a) unless a == n == 3 mod 4
+            if (a % 4 == 3 && n_low % 4 == 3)
+                ret = -ret;
+            const auto r{algorithms::mod_small(n.data().cbegin(), n.data().cend(), static_cast<std::uint32_t>(a))};
+            return ret * jacobi(r, a);
+        }
+
+        // the strong probable prime test to base a, n is odd and n - 1 = d * 2^s
+        template <typename Value, class Container>
+        bool miller_rabin(const bigint<Value, Container>& n, const bigint<Value, Container>& n_min_one,
+                          const bigint<Value, Container>& d, std::size_t s, const bigint<Value, Container>& a)
+        {
+            auto x{a.powmod(d, n)};
+            if (x == bigint<Value, Container>(1) || x == n_min_one)
+                return true;
+
+            for (std::size_t i{1}; i < s; ++i) {
+                x *= x;
+                x %= n;
+                if (x == n_min_one)
+                    return true;
+                if (x == bigint<Value, Container>(1))
+                    return false;
+            }
+            return false;
+        }
+
+        // the strong Lucas probable prime test with the parameters of Selfridge's method A, n is odd, greater than
+        // the small primes and has no small factor
+        template <typename Value, class Container> bool strong_lucas(const bigint<Value, Container>& n)
+        {
+            using bigint = bigint<Value, Container>;
+
+            // the sequence of D does not reach a Jacobi symbol of -1 if n is a square
+            if (sqrtrem(n).second.is_zero())
+                return false;
+
+            // D is the first element of 5, -7, 9, -11, ... with (D / n) == -1, P = 1 and Q = (1 - D) / 4
+            std::int64_t d{5};
+            while (true) {
+                const auto j{jacobi(d, n)};
+                if (j == -1)
+                    break;
+                if (j == 0)
+                    return false; // gcd(|D|, n) > 1 and |D| < n
+                d = d > 0 ? -d - 2 : -d + 2;
+            }
+
+            const auto reduce = [&n](bigint x) {
+                x %= n;
+                if (x.is_negative())
+                    x += n;
+                return x;
+            };
+            // x / 2 mod n
+            const auto half = [&n](bigint x) {
+                if (x.test_bit(0))
+                    x += n;
+                return x >> 1;
+            };
+
+            const bigint big_d(d);
+            const auto q{reduce(bigint((1 - d) / 4))};
+
+            // n + 1 = k * 2^s with k odd
+            auto k{n + bigint(1)};
+            std::size_t s{0};
+            for (; !k.test_bit(s); ++s)
+                ;
+            k >>= s;
+
+            // U_1 = 1, V_1 = P = 1, the bits of k are processed from the most significant one using the doubling
+            // formulas U_2m = U_m * V_m, V_2m = V_m^2 - 2 * Q^m and U_m+1 = (U_m + V_m) / 2, V_m+1 = (D * U_m + V_m) / 2
+            bigint u(1);
+            bigint v(1);
+            auto q_k{q};
+            for (auto i{k.bit_length() - 1}; i-- > 0;) {
+                u = reduce(u * v);
+                v = reduce(v * v - (q_k << 1));
+                q_k = reduce(q_k * q_k);
+                if (k.test_bit(i)) {
+                    auto u_next{half(reduce(u + v))};
+                    v = half(reduce(big_d * u + v));
+                    u = std::move(u_next);
+                    q_k = reduce(q_k * q);
+                }
+            }
+
+            // n is a strong Lucas probable prime if U_k == 0 or V_k*2^r == 0 for some 0 <= r < s
+            if (u.is_zero() || v.is_zero())
+                return true;
+            for (std::size_t r{1}; r < s; ++r) {
+                v = reduce(v * v - (q_k << 1));
+                if (v.is_zero())
+                    return true;
+                q_k = reduce(q_k * q_k);
+            }
+            return false;
+        }
+
+        // the Baillie-PSW test and rounds Miller-Rabin tests with random bases, n is odd, greater than the small
+        // primes and has no small factor
+        template <typename Value, class Container, class URBG>
+        bool baillie_psw(const bigint<Value, Container>& n, unsigned rounds, URBG& engine)
+        {
+            using bigint = bigint<Value, Container>;
+
+            const auto n_min_one{n - bigint(1)};
+            std::size_t s{1};
+            for (; !n_min_one.test_bit(s); ++s)
+                ;
+            const auto d{n_min_one >> s};
+
+            if (!miller_rabin(n, n_min_one, d, s, bigint(2)))
+                return false;
+
+            for (unsigned i{0}; i < rounds; ++i) {
+                // the base is uniformly distributed in [2, n - 2]
+                if (!miller_rabin(n, n_min_one, d, s, random_below(n - bigint(3), engine) + bigint(2)))
+                    return false;
+            }
+
+            return strong_lucas(n);
+        }
+    } // namespace internal
+
+    template <typename Value, class Container, class URBG>
+    bool is_probable_prime(const internal::bigint<Value, Container>& n, unsigned rounds, URBG& engine)
+    {
+        using bigint = internal::bigint<Value, Container>;
+        const auto& table{internal::small_primes()};
+
+        if (n < bigint(2))
+            return false;
+        if (!n.test_bit(0))
+            return n == bigint(2);
+
+        const auto residues{internal::small_prime_residues(n)};
+        for (std::size_t i{0}; i < residues.size(); ++i) {
+            if (residues[i] == 0)
+                return n == bigint(table.primes[i]);
+        }
+
+        // n has no factor below small_prime_limit
+        if (n.bit_length() <= 30)
+            return true;
+
+        return internal::baillie_psw(n, rounds, engine);
+    }
+
+    template <typename Value, class Container>
+    bool is_probable_prime(const internal::bigint<Value, Container>& n, unsigned rounds)
+    {
+        xoshiro256x4 engine;
+        return is_probable_prime(n, rounds, engine);
+    }
+
+    template <typename Value, class Container>
+    internal::bigint<Value, Container> next_prime(const internal::bigint<Value, Container>& n)
+    {
+        using bigint = internal::bigint<Value, Container>;
+        const auto& primes{internal::small_primes().primes};
+
+        if (n < bigint(2))
+            return bigint(2);
+
+        // the candidates are odd
+        auto first{n + bigint(1)};
+        if (!first.test_bit(0))
+            ++first;
+
+        // the sieve requires the candidates to be greater than the small primes
+        if (first.bit_length() <= 30) {
+            for (; !is_probable_prime(first); first += bigint(2))
+                ;
+            return first;
+        }
+
+        xoshiro256x4 engine;
+        std::vector<bool> composite(internal::prime_sieve_size);
+        while (true) {
+            // the candidate first + 2 * i is divisible by p if i == -first / 2 mod p
+            const auto residues{internal::small_prime_residues(first)};
+            std::fill(composite.begin(), composite.end(), false);
+            for (std::size_t j{0}; j < primes.size(); ++j) {
+                const std::uint64_t p{primes[j]};
+                const auto r{residues[j]};
+                for (auto i{static_cast<std::size_t>((p - r) % p * ((p + 1) / 2) % p)}; i < composite.size(); i += p)
+                    composite[i] = true;
+            }
+
+            for (std::size_t i{0}; i < composite.size(); ++i) {
+                if (composite[i])
+                    continue;
+                auto candidate{first + bigint(static_cast<std::uint64_t>(2 * i))};
+                if (internal::baillie_psw(candidate, 0, engine))
+                    return candidate;
+            }
+
+            first += bigint(static_cast<std::uint64_t>(2 * internal::prime_sieve_size));
+        }
+    }
+} // namespace xenonis
@@ -0,0 +1,255 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file random.hpp
+ *  \brief Uniformly distributed random bigints and a fast random number generator.
+ */
+#pragma once
+
+#include "bigint.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace xenonis {
+    /*!
+     *  A UniformRandomBitGenerator producing 64-bit numbers, which consists of four xoshiro256** generators (by David
+     *  Blackman and Sebastiano Vigna, see https://prng.di.unimi.it/). The generators are advanced together and their
+     *  states are stored interleaved, so that the compiler can vectorise the update. The generators start 2^128
+     *  numbers apart from each other, their outputs are returned alternately.
+     *  \details Not suitable for cryptographic purposes.
+     */
+    class xoshiro256x4 {
+      public:
+        using result_type = std::uint64_t;
+
+        //! the number of generators, every step produces this many numbers
+        static constexpr std::size_t lanes{4};
+
+        /*!
+         *  Initializes the first generator using the splitmix64 generator seeded with seed, the others are obtained
+         *  by jumping ahead 2^128 steps.
+         */
+        explicit xoshiro256x4(std::uint64_t seed = 0) noexcept
+        {
+            std::array<state, lanes> states{};
+            for (auto& word : states[0])
+                word = splitmix64(seed);
+
+            for (std::size_t lane{1}; lane < lanes; ++lane) {
+                states[lane] = states[lane - 1];
+                jump(states[lane]);
+            }
+
+            // interleave the states: m_words[i][lane] is the word i of the generator lane
+            for (std::size_t i{0}; i < 4; ++i)
+                for (std::size_t lane{0}; lane < lanes; ++lane)
+                    m_words[i][lane] = states[lane][i];
+        }
+
+        static constexpr result_type min() noexcept { return 0; }
+        static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()() noexcept
+        {
+            if (m_next == lanes) {
+                step(m_buffer.data());
+                m_next = 0;
+            }
+            return m_buffer[m_next++];
+        }
+
+        /*!
+         *  Writes the next std::distance(first, last) numbers to [first, last), the numbers are the same as the ones
+         *  returned by that many calls of operator().
+         */
+        template <class OutIter> void generate(OutIter first, OutIter last) noexcept
+        {
+            for (; first != last && m_next != lanes; ++first)
+                *first = m_buffer[m_next++];
+
+            while (first != last) {
+                step(m_buffer.data());
+                m_next = 0;
+                for (; first != last && m_next != lanes; ++first)
+                    *first = m_buffer[m_next++];
+            }
+        }
+
+      private:
+        using state = std::array<std::uint64_t, 4>;
+
+        std::array<std::array<std::uint64_t, lanes>, 4> m_words{};
+        std::array<result_type, lanes> m_buffer{};
+        std::size_t m_next{lanes};
+
+        static constexpr std::uint64_t rotl(std::uint64_t x, unsigned k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+        static constexpr std::uint64_t splitmix64(std::uint64_t& x) noexcept
+        {
+            auto z{x += 0x9e3779b97f4a7c15};
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        // advances a single generator by one step
+        static constexpr void next(state& s) noexcept
+        {
+            const auto t{s[1] << 17};
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+        }
+
+        // advances a single generator by 2^128 steps
+        static constexpr void jump(state& s) noexcept
+        {
+            constexpr state polynomial{{0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                                        0x39abdc4529b1661c}};
+            state ret{};
+            for (const auto word : polynomial) {
+                for (unsigned bit{0}; bit < 64; ++bit) {
+                    if ((word >> bit) & 1) {
+                        for (std::size_t i{0}; i < 4; ++i)
+                            ret[i] ^= s[i];
+                    }
+                    next(s);
+                }
+            }
+            s = ret;
+        }
+
+        // advances all generators, the loops over the lanes are independent and can be vectorised
+        void step(result_type* out) noexcept
+        {
+            auto& s0{m_words[0]};
+            auto& s1{m_words[1]};
+            auto& s2{m_words[2]};
+            auto& s3{m_words[3]};
+
+            for (std::size_t lane{0}; lane < lanes; ++lane)
+                out[lane] = rotl(s1[lane] * 5, 7) * 9;
+
+            for (std::size_t lane{0}; lane < lanes; ++lane) {
+                const auto t{s1[lane] << 17};
+                s2[lane] ^= s0[lane];
+                s3[lane] ^= s1[lane];
+                s1[lane] ^= s2[lane];
+                s0[lane] ^= s3[lane];
+                s2[lane] ^= t;
+                s3[lane] = rotl(s3[lane], 45);
+            }
+        }
+    };
+
+    /*!
+     *  Returns a uniformly distributed random number in [0, 2^bits).
+     *  \details The limbs are filled directly using the numbers of engine. If engine produces 64-bit numbers and
+     *  provides generate(first, last) (like xoshiro256x4), the limbs of 64 bits are written at once.
+     *  \param engine a UniformRandomBitGenerator
+     */
+    template <class Bigint = bigint, class URBG> Bigint random_bits(std::size_t bits, URBG& engine);
+
+    /*!
+     *  Returns a uniformly distributed random number in [0, bound). Throws std::domain_error if bound <= 0.
+     *  \details Uses rejection sampling of random_bits(bound.bit_length(), engine), on average less than two numbers
+     *  are generated.
+     *  \param engine a UniformRandomBitGenerator
+     */
+    template <typename Value, class Container, class URBG>
+    internal::bigint<Value, Container> random_below(const internal::bigint<Value, Container>& bound, URBG& engine);
+
+    namespace internal {
+        template <class Bigint> struct bigint_types;
+
+        template <typename Value, class Container> struct bigint_types<bigint<Value, Container>> {
+            using value_type = Value;
+            using container = Container;
+        };
+
+        template <class URBG, class = void> struct has_generate : std::false_type {};
+
+        template <class URBG>
+        struct has_generate<URBG, std::void_t<decltype(std::declval<URBG&>().generate(
+                                      std::declval<std::uint64_t*>(), std::declval<std::uint64_t*>()))>>
+            : std::true_type {};
+
+        // returns 64 uniformly distributed bits
+        template <class URBG> std::uint64_t random_word(URBG& engine)
+        {
+            if constexpr (URBG::min() == 0 && URBG::max() == std::numeric_limits<std::uint64_t>::max()) {
+                return static_cast<std::uint64_t>(engine());
+            } else if constexpr (URBG::min() == 0 && URBG::max() == std::numeric_limits<std::uint32_t>::max()) {
+                const auto low{static_cast<std::uint64_t>(engine())};
+                return (static_cast<std::uint64_t>(engine()) << 32) | low;
+            } else {
+                return std::uniform_int_distribution<std::uint64_t>()(engine);
+            }
+        }
+    } // namespace internal
+
+    template <class Bigint, class URBG> Bigint random_bits(std::size_t bits, URBG& engine)
+    {
+        using value_type = typename internal::bigint_types<Bigint>::value_type;
+        using container = typename internal::bigint_types<Bigint>::container;
+        constexpr unsigned limb_bits{std::numeric_limits<value_type>::digits};
+
+        if (bits == 0)
+            return Bigint(0);
+
+        container data((bits + limb_bits - 1) / limb_bits);
+        if constexpr (limb_bits == 64 && internal::has_generate<URBG>::value &&
+                      URBG::min() == 0 && URBG::max() == std::numeric_limits<std::uint64_t>::max()) {
+            engine.generate(data.begin(), data.end());
+        } else if constexpr (limb_bits == 64) {
+            for (auto& limb : data)
+                limb = internal::random_word(engine);
+        } else {
+            // every word of 64 bits fills several limbs
+            constexpr std::size_t limbs_per_word{64 / limb_bits};
+            std::uint64_t word{0};
+            for (std::size_t i{0}; i < data.size(); ++i) {
+                if (i % limbs_per_word == 0)
+                    word = internal::random_word(engine);
+                data[i] = static_cast<value_type>(word);
+                word >>= limb_bits;
+            }
+        }
+
+        if (bits % limb_bits != 0)
+            data.back() &= static_cast<value_type>((value_type{1} << (bits % limb_bits)) - 1);
+
+        return Bigint(std::move(data));
+    }
+
+    template <typename Value, class Container, class URBG>
+    internal::bigint<Value, Container> random_below(const internal::bigint<Value, Container>& bound, URBG& engine)
+    {
+        using bigint = internal::bigint<Value, Container>;
+
+        if (bound.is_negative() || bound.is_zero())
+            throw std::domain_error("Bound not positive!");
+
+        const auto bits{bound.bit_length()};
+        while (true) {
+            auto ret{random_bits<bigint>(bits, engine)};
+            if (ret < bound)
+                return ret;
+        }
+    }
+} // namespace xenonis
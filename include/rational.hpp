@@ -0,0 +1,345 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file rational.hpp
+ *  \brief Exact rational numbers built on bigint.
+ */
+#pragma once
+
+#include "bigint.hpp"
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace xenonis {
+    /*!
+     *  A rational number n / d, the denominator d is always positive.
+     *  \details If Lazy is false, the fraction is canonical (gcd(n, d) == 1) after every operation. Like GMP's mpq
+     *  functions, the operations keep the gcds small: a / b + c / d calculates g = gcd(b, d) first, so only
+     *  gcd(a * (d / g) + c * (b / g), g) has to be removed from the sum, and a / b * c / d cancels gcd(a, d) and
+     *  gcd(c, b) before multiplying. Integers (d == 1) need no gcd at all.
+     *  If Lazy is true, the operations calculate no gcds, the numbers grow until they are canonicalised. This happens
+     *  in canonicalize(), in the comparisons and in the output functions (numerator(), denominator(), to_string()),
+     *  so the value of a lazy rational is never observed in a non-canonical form. Since the comparisons and the
+     *  output functions canonicalise const objects, a lazy rational must not be read by several threads at once.
+     */
+    template <class Bigint = bigint, bool Lazy = false> class basic_rational {
+      public:
+        basic_rational() : m_num(0), m_den(1) {}
+
+        basic_rational(Bigint num) : m_num(std::move(num)), m_den(1) {}
+
+        /*!
+         *  Constructs num / den. Throws std::domain_error if den is zero.
+         */
+        basic_rational(Bigint num, Bigint den) : m_num(std::move(num)), m_den(std::move(den))
+        {
+            if (m_den.is_zero())
+                throw std::domain_error("Division by zero!");
+            normalize_sign();
+            if constexpr (!Lazy)
+                reduce();
+        }
+
+        /*!
+         *  Constructs the number from a hex-string "n/d" or "n".
+         */
+        explicit basic_rational(std::string_view hex_str)
+        {
+            const auto slash{hex_str.find('/')};
+            if (slash == std::string_view::npos)
+                *this = basic_rational(Bigint(hex_str));
+            else
+                *this = basic_rational(Bigint(hex_str.substr(0, slash)), Bigint(hex_str.substr(slash + 1)));
+        }
+
+        /*!
+         *  Converts between the eager and the lazy mode, the lazy number is canonicalised first.
+         */
+        template <bool OtherLazy>
+        explicit basic_rational(const basic_rational<Bigint, OtherLazy>& other)
+            : m_num(other.numerator()), m_den(other.denominator())
+        {
+        }
+
+        /*!
+         *  Removes gcd(n, d) from the fraction, only required in the lazy mode.
+         */
+        const basic_rational& canonicalize() const
+        {
+            if constexpr (Lazy)
+                reduce();
+            return *this;
+        }
+
+        const Bigint& numerator() const { return canonicalize().m_num; }
+        const Bigint& denominator() const { return canonicalize().m_den; }
+
+        bool is_zero() const noexcept { return m_num.is_zero(); }
+        bool is_negative() const noexcept { return m_num.is_negative(); }
+        bool is_integer() const { return is_one(canonicalize().m_den); }
+
+        basic_rational operator-() const
+        {
+            auto tmp{*this};
+            tmp.m_num = -tmp.m_num;
+            return tmp;
+        }
+
+        basic_rational& operator+=(const basic_rational& other) { return add_assign(other, false); }
+        basic_rational& operator-=(const basic_rational& other) { return add_assign(other, true); }
+
+        basic_rational& operator*=(const basic_rational& other)
+        {
+            if (&other == this) {
+                m_num *= m_num;
+                m_den *= m_den;
+                return *this;
+            }
+
+            if constexpr (Lazy) {
+                m_num *= other.m_num;
+                m_den *= other.m_den;
+            } else {
+                mul_assign(other.m_num, other.m_den);
+            }
+            return *this;
+        }
+
+        /*!
+         *  Throws std::domain_error if other is zero.
+         */
+        basic_rational& operator/=(const basic_rational& other)
+        {
+            if (other.is_zero())
+                throw std::domain_error("Division by zero!");
+
+            if (&other == this) {
+                *this = basic_rational(1);
+                return *this;
+            }
+
+            // a / b / (c / d) = a / b * (d / c), the sign of c is moved to the numerator
+            if constexpr (Lazy) {
+                m_num *= other.m_den;
+                m_den *= other.m_num;
+                normalize_sign();
+            } else {
+                mul_assign(other.m_den, other.m_num);
+            }
+            return *this;
+        }
+
+#define RATIONAL_ARITHMETIC_OPERATOR_IMPL(op)                                                                          \
+    basic_rational operator op(const basic_rational& other) const                                                      \
+    {                                                                                                                  \
+        auto tmp{*this};                                                                                               \
+        tmp op## = other;                                                                                              \
+        return tmp;                                                                                                    \
+    }
+
+        RATIONAL_ARITHMETIC_OPERATOR_IMPL(+)
+        RATIONAL_ARITHMETIC_OPERATOR_IMPL(-)
+        RATIONAL_ARITHMETIC_OPERATOR_IMPL(*)
+        RATIONAL_ARITHMETIC_OPERATOR_IMPL(/)
+
+#undef RATIONAL_ARITHMETIC_OPERATOR_IMPL
+
+        bool operator==(const basic_rational& other) const
+        {
+            canonicalize();
+            other.canonicalize();
+            return m_num == other.m_num && m_den == other.m_den;
+        }
+
+        bool operator!=(const basic_rational& other) const { return !(*this == other); }
+
+        bool operator<(const basic_rational& other) const
+        {
+            canonicalize();
+            other.canonicalize();
+            if (m_num.is_negative() != other.m_num.is_negative())
+                return m_num.is_negative();
+            if (m_den == other.m_den)
+                return m_num < other.m_num;
+            // the denominators are positive
+            return m_num * other.m_den < other.m_num * m_den;
+        }
+
+        bool operator>(const basic_rational& other) const { return other < *this; }
+        bool operator<=(const basic_rational& other) const { return !(other < *this); }
+        bool operator>=(const basic_rational& other) const { return !(*this < other); }
+
+        /*!
+         *  \returns "n/d" in hex or "n" for integers
+         */
+        std::string to_string(bool lower_case = true) const
+        {
+            canonicalize();
+            if (is_one(m_den))
+                return m_num.to_string(lower_case);
+            return m_num.to_string(lower_case) + '/' + m_den.to_string(lower_case);
+        }
+
+      private:
+        // mutable: the lazy mode canonicalises const objects, the value does not change
+        mutable Bigint m_num;
+        mutable Bigint m_den;
+
+        static bool is_one(const Bigint& n) noexcept
+        {
+            return !n.is_negative() && n.data().size() == 1 && n.data().front() == 1;
+        }
+
+        void normalize_sign()
+        {
+            if (m_den.is_negative()) {
+                m_num = -m_num;
+                m_den = -m_den;
+            }
+        }
+
+        void reduce() const
+        {
+            if (is_one(m_den))
+                return;
+            if (m_num.is_zero()) {
+                m_den = Bigint(1);
+                return;
+            }
+
+            const auto g{gcd(m_num, m_den)};
+            if (!is_one(g)) {
+                m_num /= g;
+                m_den /= g;
+            }
+        }
+
+        basic_rational& add_assign(const basic_rational& other, bool subtract)
+        {
+            if (&other == this) {
+                const auto copy{other};
+                return add_assign(copy, subtract);
+            }
+
+            const auto& c{other.m_num};
+            const auto& d{other.m_den};
+
+            // a / b + c / d with a single gcd, the result is canonical if both operands are
+            const auto add_product = [&](Bigint& n, const Bigint& x, const Bigint& y) -> Bigint& {
+                return subtract ? n.submul(x, y) : n.addmul(x, y);
+            };
+
+            if (is_one(d)) { // a / b + c = (a + c * b) / b
+                if (is_one(m_den)) {
+                    if (subtract)
+                        m_num -= c;
+                    else
+                        m_num += c;
+                } else {
+                    add_product(m_num, c, m_den);
+                }
+                return *this;
+            }
+
+            if (is_one(m_den)) { // a + c / d = (a * d + c) / d
+                m_num *= d;
+                if (subtract)
+                    m_num -= c;
+                else
+                    m_num += c;
+                m_den = d;
+                return *this;
+            }
+
+            if constexpr (Lazy) {
+                if (m_den == d) {
+                    if (subtract)
+                        m_num -= c;
+                    else
+                        m_num += c;
+                } else {
+                    m_num *= d;
+                    add_product(m_num, c, m_den);
+                    m_den *= d;
+                }
+            } else {
+                const auto g{gcd(m_den, d)};
+                if (is_one(g)) {
+                    m_num *= d;
+                    add_product(m_num, c, m_den);
+                    m_den *= d;
+                    return *this;
+                }
+
+                // t = a * (d / g) + c * (b / g), the result is t / gcd(t, g) / ((b / g) * (d / gcd(t, g)))
+                m_den /= g;
+                m_num *= d / g;
+                add_product(m_num, c, m_den);
+                if (m_num.is_zero()) {
+                    m_den = Bigint(1);
+                    return *this;
+                }
+
+                const auto h{gcd(m_num, g)};
+                if (is_one(h)) {
+                    m_den *= d;
+                } else {
+                    m_num /= h;
+                    m_den *= d / h;
+                }
+            }
+            return *this;
+        }
+
+        // multiplies the canonical fraction with c / d, c / d has to be canonical apart from the sign, which is moved to
+        // the numerator
+        void mul_assign(const Bigint& c, const Bigint& d)
+        {
+            if (m_num.is_zero())
+                return;
+            if (c.is_zero()) {
+                m_num = Bigint(0);
+                m_den = Bigint(1);
+                return;
+            }
+
+            // a / b * c / d = (a / gcd(a, d)) * (c / gcd(c, b)) / ((b / gcd(c, b)) * (d / gcd(a, d)))
+            const auto cancel = [](Bigint& x, Bigint& y) {
+                if (is_one(x) || is_one(y))
+                    return;
+                const auto g{gcd(x, y)};
+                if (!is_one(g)) {
+                    x /= g;
+                    y /= g;
+                }
+            };
+
+            auto c_reduced{c};
+            auto d_reduced{d};
+            cancel(m_num, d_reduced);
+            cancel(c_reduced, m_den);
+
+            m_num *= c_reduced;
+            m_den *= d_reduced;
+            normalize_sign();
+        }
+    };
+
+    using rational = basic_rational<bigint>;
+    using lazy_rational = basic_rational<bigint, true>;
+
+    template <class Bigint, bool Lazy>
+    std::ostream& operator<<(std::ostream& out, const basic_rational<Bigint, Lazy>& r)
+    {
+        return out << r.to_string();
+    }
+} // namespace xenonis
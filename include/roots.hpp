@@ -0,0 +1,142 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file roots.hpp
+ *  \brief Integer square roots and k-th roots of bigints.
+ */
+#pragma once
+
+#include "bigint.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace xenonis {
+    /*!
+     *  Calculates the integer square root s = floor(sqrt(n)) and the remainder r = n - s^2.
+     *  \details Uses a Newton iteration which doubles the number of correct bits in every step, so the cost is
+     *  dominated by the division of the last step, which divides about 3n / 4 by n / 4 limbs for n limbs. The division
+     *  is the schoolbook division (Knuth's algorithm D), so the complexity is O(n^2), not that of a multiplication;
+     *  the steps before cost about a third of the last one. Throws std::domain_error if n < 0.
+     *  \returns the pair (s, r)
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR std::pair<internal::bigint<Value, Container>, internal::bigint<Value, Container>>
+    sqrtrem(const internal::bigint<Value, Container>& n);
+
+    /*!
+     *  Calculates the integer k-th root s = floor(n^(1/k)) (rounded towards zero for negative n) and the remainder
+     *  r = n - s^k. Throws std::domain_error if k == 0 or if n < 0 and k is even.
+     *  \details Uses the Newton iteration s' = ((k - 1) * s + n / s^(k - 1)) / k starting above the root. Every step
+     *  divides n by s^(k - 1) using the schoolbook division, which is O(n^2) for n limbs.
+     *  \returns the pair (s, r)
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR std::pair<internal::bigint<Value, Container>, internal::bigint<Value, Container>>
+    rootrem(const internal::bigint<Value, Container>& n, unsigned k);
+
+    /*!
+     *  \returns floor(sqrt(n)), see sqrtrem
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR internal::bigint<Value, Container> isqrt(const internal::bigint<Value, Container>& n)
+    {
+        return sqrtrem(n).first;
+    }
+
+    /*!
+     *  \returns floor(n^(1/k)), see rootrem
+     */
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR internal::bigint<Value, Container> iroot(const internal::bigint<Value, Container>& n, unsigned k)
+    {
+        return rootrem(n, k).first;
+    }
+
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR std::pair<internal::bigint<Value, Container>, internal::bigint<Value, Container>>
+    sqrtrem(const internal::bigint<Value, Container>& n)
+    {
+        using bigint = internal::bigint<Value, Container>;
+
+        if (n.is_negative())
+            throw std::domain_error("Square root of a negative number!");
+
+        if (n.is_zero())
+            return std::make_pair(bigint(0), bigint(0));
+
+        // the precision of the approximation a is doubled in every step, the invariant is
+        // (a - 1)^2 < (n >> 2 * (c - d)) < (a + 1)^2, see the implementation of math.isqrt of CPython
+        const std::size_t c{(n.bit_length() - 1) / 2};
+        std::size_t c_bits{0};
+        for (auto tmp{c}; tmp != 0; tmp >>= 1)
+            ++c_bits;
+
+        bigint a(1);
+        std::size_t d{0};
+        for (auto s{c_bits}; s-- > 0;) {
+            const auto e{d};
+            d = c >> s;
+            a = (a << (d - e - 1)) + (n >> (2 * c - e - d + 1)) / a;
+        }
+
+        // a is at most one too large
+        auto r{n - a * a};
+        if (r.is_negative()) {
+            --a;
+            r += a;
+            r += a;
+            ++r;
+        }
+
+        return std::make_pair(std::move(a), std::move(r));
+    }
+
+    template <typename Value, class Container>
+    XENONIS_CONSTEXPR std::pair<internal::bigint<Value, Container>, internal::bigint<Value, Container>>
+    rootrem(const internal::bigint<Value, Container>& n, unsigned k)
+    {
+        using bigint = internal::bigint<Value, Container>;
+
+        if (k == 0)
+            throw std::domain_error("Zeroth root!");
+
+        if (k == 1)
+            return std::make_pair(n, bigint(0));
+
+        if (n.is_negative()) {
+            if (k % 2 == 0)
+                throw std::domain_error("Even root of a negative number!");
+
+            auto ret{rootrem(-n, k)};
+            return std::make_pair(-ret.first, -ret.second);
+        }
+
+        if (k == 2)
+            return sqrtrem(n);
+
+        if (n.is_zero())
+            return std::make_pair(bigint(0), bigint(0));
+
+        // 2^ceil(bits / k) >= n^(1 / k), starting above the root the iteration decreases monotonically until it
+        // reaches floor(n^(1 / k))
+        const bigint k_big(static_cast<std::uint32_t>(k));
+        const bigint k_min_one(static_cast<std::uint32_t>(k - 1));
+        auto s{bigint(1) << ((n.bit_length() + k - 1) / k)};
+        while (true) {
+            auto next{(s * k_min_one + n / s.pow(k - 1)) / k_big};
+            if (next >= s)
+                break;
+            s = std::move(next);
+        }
+
+        auto r{n - s.pow(k)};
+        return std::make_pair(std::move(s), std::move(r));
+    }
+} // namespace xenonis
@@ -0,0 +1,221 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file stats.hpp
+ *  Optional instrumentation of the allocations and the kernels. If XENONIS_ENABLE_STATS is defined (cmake option of
+ *  the same name), every thread counts the allocations of the limbs, the calls of the kernels per size and the special
+ *  cases taken by the algorithms. Otherwise the hooks compile to nothing and the counters stay zero.
+ */
+#pragma once
+
+#include "bigint_config.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xenonis::stats {
+    //! true if the counters are updated
+#if defined(XENONIS_ENABLE_STATS)
+    constexpr bool enabled{true};
+#else
+    constexpr bool enabled{false};
+#endif
+
+    //! the instrumented kernels
+    enum class kernel : std::size_t {
+        add,
+        sub,
+        sub_from,
+        addmul_1,
+        submul_1,
+        naive_mul,
+        naive_mullo,
+        naive_mulhi,
+        karatsuba_mul,
+        mullo,
+        mulhi,
+        naive_sqr,
+        karatsuba_sqr,
+        divmod,
+        count
+    };
+
+    //! the instrumented special cases of the algorithms
+    enum class event : std::size_t {
+        reallocation,        //!< the limbs were moved to a larger buffer
+        remove_zeros_shrink, //!< remove_zeros removed at least one limb
+        karatsuba_zero,      //!< an operand of karatsuba_mul was zero
+        karatsuba_a_h_zero,  //!< the high half of a was zero
+        karatsuba_a_l_zero,  //!< the low half of a was zero
+        karatsuba_b_h_zero,  //!< the high half of b was zero
+        karatsuba_b_l_zero,  //!< the low half of b was zero
+        count
+    };
+
+    //! the calls of a kernel are counted per bucket, bucket i counts the sizes [2^i, 2^(i+1)) (0 is in bucket 0)
+    constexpr std::size_t bucket_count{24};
+
+    //! returns the bucket of size, the last bucket counts all larger sizes
+    constexpr std::size_t bucket(std::size_t size) noexcept
+    {
+        std::size_t i{0};
+        for (; size > 1 && i < bucket_count - 1; size >>= 1)
+            ++i;
+        return i;
+    }
+
+    constexpr const char* name(kernel k) noexcept
+    {
+        constexpr std::array<const char*, static_cast<std::size_t>(kernel::count)> names{
+            "add",         "sub",           "sub_from", "addmul_1", "submul_1",  "naive_mul",     "naive_mullo",
+            "naive_mulhi", "karatsuba_mul", "mullo",    "mulhi",    "naive_sqr", "karatsuba_sqr", "divmod"};
+        return names[static_cast<std::size_t>(k)];
+    }
+
+    constexpr const char* name(event e) noexcept
+    {
+        constexpr std::array<const char*, static_cast<std::size_t>(event::count)> names{
+            "reallocation",       "remove_zeros_shrink", "karatsuba_zero",    "karatsuba_a_h_zero",
+            "karatsuba_a_l_zero", "karatsuba_b_h_zero",  "karatsuba_b_l_zero"};
+        return names[static_cast<std::size_t>(e)];
+    }
+
+    /*!
+     *  The counters of a thread.
+     */
+    struct counters {
+        std::uint64_t allocations{0};
+        std::uint64_t allocated_bytes{0};
+        std::array<std::array<std::uint64_t, bucket_count>, static_cast<std::size_t>(kernel::count)> kernel_calls{};
+        std::array<std::uint64_t, static_cast<std::size_t>(event::count)> events{};
+
+        //! returns the number of calls of k summed over all sizes
+        std::uint64_t calls(kernel k) const noexcept
+        {
+            std::uint64_t ret{0};
+            for (auto n : kernel_calls[static_cast<std::size_t>(k)])
+                ret += n;
+            return ret;
+        }
+
+        std::uint64_t count(event e) const noexcept { return events[static_cast<std::size_t>(e)]; }
+    };
+
+    namespace internal {
+        inline counters& local() noexcept
+        {
+            thread_local counters c;
+            return c;
+        }
+
+        inline void count_allocation(std::size_t bytes) noexcept
+        {
+            auto& c{local()};
+            ++c.allocations;
+            c.allocated_bytes += bytes;
+        }
+
+        inline void count_kernel(kernel k, std::size_t size) noexcept
+        {
+            ++local().kernel_calls[static_cast<std::size_t>(k)][bucket(size)];
+        }
+
+        inline void count_event(event e) noexcept { ++local().events[static_cast<std::size_t>(e)]; }
+    } // namespace internal
+
+    //! returns a copy of the counters of the calling thread
+    inline counters snapshot() noexcept { return internal::local(); }
+
+    //! sets the counters of the calling thread to zero
+    inline void reset() noexcept { internal::local() = counters{}; }
+
+    /*!
+     *  Returns the counters as text, one line per counter, kernels and events which were never counted are omitted.
+     *  The buckets are written as <smallest size>: <calls>.
+     */
+    inline std::string to_string(const counters& c)
+    {
+        std::string ret{"allocations: " + std::to_string(c.allocations) + '\n' +
+                        "allocated bytes: " + std::to_string(c.allocated_bytes) + '\n'};
+
+        for (std::size_t k{0}; k < static_cast<std::size_t>(kernel::count); ++k) {
+            const auto total{c.calls(static_cast<kernel>(k))};
+            if (total == 0)
+                continue;
+
+            ret += std::string(name(static_cast<kernel>(k))) + ": " + std::to_string(total) + " calls (";
+            bool first{true};
+            for (std::size_t i{0}; i < bucket_count; ++i) {
+                if (c.kernel_calls[k][i] == 0)
+                    continue;
+                ret += (first ? "" : ", ") + std::to_string(i == 0 ? 0 : std::size_t{1} << i) + ": " +
+                       std::to_string(c.kernel_calls[k][i]);
+                first = false;
+            }
+            ret += ")\n";
+        }
+
+        for (std::size_t e{0}; e < static_cast<std::size_t>(event::count); ++e) {
+            if (c.events[e] != 0)
+                ret += std::string(name(static_cast<event>(e))) + ": " + std::to_string(c.events[e]) + '\n';
+        }
+
+        return ret;
+    }
+
+    /*!
+     *  Returns the counters as JSON object, the calls of every kernel are an array of bucket_count numbers.
+     */
+    inline std::string to_json(const counters& c)
+    {
+        std::string ret{"{\"allocations\": " + std::to_string(c.allocations) +
+                        ", \"allocated_bytes\": " + std::to_string(c.allocated_bytes) + ", \"kernels\": {"};
+
+        for (std::size_t k{0}; k < static_cast<std::size_t>(kernel::count); ++k) {
+            ret += (k == 0 ? "\"" : ", \"") + std::string(name(static_cast<kernel>(k))) + "\": [";
+            for (std::size_t i{0}; i < bucket_count; ++i)
+                ret += (i == 0 ? "" : ", ") + std::to_string(c.kernel_calls[k][i]);
+            ret += ']';
+        }
+
+        ret += "}, \"events\": {";
+        for (std::size_t e{0}; e < static_cast<std::size_t>(event::count); ++e)
+            ret += (e == 0 ? "\"" : ", \"") + std::string(name(static_cast<event>(e))) + "\": " +
+                   std::to_string(c.events[e]);
+        ret += "}}";
+
+        return ret;
+    }
+} // namespace xenonis::stats
+
+// the hooks are not evaluated during constant evaluation, the arguments are not evaluated if the stats are disabled
+#if defined(XENONIS_ENABLE_STATS)
+    #define XENONIS_STATS_ALLOCATION(bytes)                                                                            \
+        do {                                                                                                           \
+            if (!XENONIS_IS_CONSTANT_EVALUATED())                                                                      \
+                ::xenonis::stats::internal::count_allocation(bytes);                                                   \
+        } while (false)
+    #define XENONIS_STATS_KERNEL(name, size)                                                                           \
+        do {                                                                                                           \
+            if (!XENONIS_IS_CONSTANT_EVALUATED())                                                                      \
+                ::xenonis::stats::internal::count_kernel(::xenonis::stats::kernel::name,                               \
+                                                         static_cast<std::size_t>(size));                              \
+        } while (false)
+    #define XENONIS_STATS_EVENT(name)                                                                                  \
+        do {                                                                                                           \
+            if (!XENONIS_IS_CONSTANT_EVALUATED())                                                                      \
+                ::xenonis::stats::internal::count_event(::xenonis::stats::event::name);                                \
+        } while (false)
+#else
+    #define XENONIS_STATS_ALLOCATION(bytes) static_cast<void>(0)
+    #define XENONIS_STATS_KERNEL(name, size) static_cast<void>(0)
+    #define XENONIS_STATS_EVENT(name) static_cast<void>(0)
+#endif
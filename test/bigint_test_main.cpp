@@ -7,10 +7,25 @@
 //******************************************************************************
 
 #include <algorithm>
+#include <async.hpp>
+#include <batch.hpp>
+#include <bigfloat.hpp>
 #include <bigint.hpp>
+#include <cmath>
+#include <combinatorics.hpp>
+#include <cstdio>
+#include <fixed_integer.hpp>
+#include <functional>
 #include <gmpxx.h>
 #include <gtest/gtest.h>
+#include <multimod.hpp>
+#include <prime.hpp>
 #include <random>
+#include <random.hpp>
+#include <rational.hpp>
+#include <roots.hpp>
+#include <stats.hpp>
+#include <unordered_set>
 
 #define BIGINT_BOOL_OPERATOR_TEST_CASE(name_, op)                                                                      \
     TYPED_TEST(bool_bigint_test, name_)                                                                                \
@@ -182,6 +197,11 @@
         }                                                                                                              \
     }
 
+// wrappers, because and, or and xor are alternative tokens and cannot be used as test names
+static void mpz_bit_and(mpz_ptr c, mpz_srcptr a, mpz_srcptr b) { mpz_and(c, a, b); }
+static void mpz_bit_or(mpz_ptr c, mpz_srcptr a, mpz_srcptr b) { mpz_ior(c, a, b); }
+static void mpz_bit_xor(mpz_ptr c, mpz_srcptr a, mpz_srcptr b) { mpz_xor(c, a, b); }
+
 template <class bigint_type> class arithmetic_bigint_test : public ::testing::Test {
   public:
     const std::array<std::uint64_t, 3> bases{{10, 16}};
@@ -243,15 +263,1368 @@ TYPED_TEST(util_bigint_test, to_string)
     }
 }
 
+TYPED_TEST(util_bigint_test, to_decimal_string)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    for (const auto& base : this->bases) {
+        for (const auto& exp : this->exponents) {
+            for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+                mpz_class a;
+                mpz_ui_pow_ui(a.get_mpz_t(), base, exp);
+                a *= static_cast<unsigned long>(ran_dist(ran_engine));
+                if (i % 2 == 0)
+                    a = -a;
+
+                // the chunks of digits of the narrow limbs are shorter
+                ASSERT_EQ(TypeParam(a.get_str(16)).to_decimal_string(), a.get_str(10));
+                ASSERT_EQ(xenonis::bigint32(a.get_str(16)).to_decimal_string(), a.get_str(10));
+                ASSERT_EQ(xenonis::bigint8(a.get_str(16)).to_decimal_string(), a.get_str(10));
+            }
+        }
+    }
+
+    ASSERT_EQ(TypeParam(0).to_decimal_string(), "0");
+    ASSERT_EQ(TypeParam("8ac7230489e80000").to_decimal_string(), "10000000000000000000");
+    ASSERT_EQ(TypeParam("-de0b6b3a7640000").to_decimal_string(), "-1000000000000000000");
+}
+
 BIGINT_BOOL_OPERATOR_TEST_CASE(less, <)
 BIGINT_BOOL_OPERATOR_TEST_CASE(greater, >)
 BIGINT_BOOL_OPERATOR_TEST_CASE(less_equal, <=)
 BIGINT_BOOL_OPERATOR_TEST_CASE(greater_equal, >=)
 BIGINT_BOOL_OPERATOR_TEST_CASE(equal, ==)
 
+TYPED_TEST(bool_bigint_test, compare)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const auto sgn = [](int cmp) { return (cmp > 0) - (cmp < 0); };
+    const auto check = [&](const mpz_class& x, const mpz_class& y) {
+        const TypeParam a(x.get_str(16));
+        const TypeParam b(y.get_str(16));
+        const auto expected{sgn(cmp(x, y))};
+        ASSERT_EQ(expected, a.compare(b)) << "a: " << a << "\nb: " << b;
+        ASSERT_EQ(expected < 0, a < b);
+        ASSERT_EQ(expected > 0, a > b);
+        ASSERT_EQ(expected <= 0, a <= b);
+        ASSERT_EQ(expected >= 0, a >= b);
+        ASSERT_EQ(expected == 0, a == b);
+        ASSERT_EQ(expected != 0, a != b);
+    };
+
+    // the operands share long prefixes, so the differing limb is found deep inside the scan
+    for (std::size_t i{0}; i < 100 * this->ran_count; ++i) {
+        const auto limbs{1 + ran_dist(ran_engine) % 70};
+        std::vector<std::uint64_t> a_limbs(limbs);
+        for (auto& limb : a_limbs)
+            limb = ran_dist(ran_engine);
+        a_limbs.back() |= 1;
+        auto b_limbs{a_limbs};
+        if (i % 4 != 0) {
+            const auto pos{ran_dist(ran_engine) % limbs};
+            b_limbs[pos] ^= std::uint64_t{1} << (ran_dist(ran_engine) % 64);
+            if (b_limbs.back() == 0)
+                b_limbs.back() = 1;
+        }
+        if (i % 8 == 1)
+            b_limbs.push_back(1);
+
+        const auto to_mpz = [](const std::vector<std::uint64_t>& n) {
+            mpz_class ret{0};
+            for (auto limb{n.crbegin()}; limb != n.crend(); ++limb)
+                ret = (ret << 64) + static_cast<unsigned long>(*limb);
+            return ret;
+        };
+        mpz_class x{to_mpz(a_limbs)};
+        mpz_class y{to_mpz(b_limbs)};
+        if (i % 3 == 1)
+            x = -x;
+        if (i % 5 == 2)
+            y = -y;
+        check(x, y);
+        check(-x, -y);
+    }
+
+    // machine integers, compared without converting them to a bigint
+    const std::array<std::int64_t, 9> signed_values{{0, 1, -1, 42, -42, std::numeric_limits<std::int64_t>::max(),
+                                                     std::numeric_limits<std::int64_t>::min(),
+                                                     std::numeric_limits<std::int64_t>::min() + 1, 1ll << 32}};
+    const std::array<std::string, 9> numbers{{"0", "1", "-1", "2a", "-2a", "7fffffffffffffff", "-8000000000000000",
+                                              "ffffffffffffffff", "-10000000000000000"}};
+    for (const auto& str : numbers) {
+        const TypeParam a(str);
+        const mpz_class x(str, 16);
+        for (const auto n : signed_values) {
+            const auto expected{sgn(cmp(x, static_cast<long>(n)))};
+            ASSERT_EQ(expected, a.compare(n)) << "a: " << a << "\nn: " << n;
+            if (n == static_cast<std::int32_t>(n)) {
+                ASSERT_EQ(expected, a.compare(static_cast<std::int32_t>(n)));
+            }
+            ASSERT_EQ(expected < 0, a < n);
+            ASSERT_EQ(expected > 0, a > n);
+            ASSERT_EQ(expected == 0, a == n);
+            ASSERT_EQ(expected != 0, n != a);
+            ASSERT_EQ(expected < 0, n > a);
+            ASSERT_EQ(expected >= 0, n <= a);
+        }
+        const auto u_expected{sgn(cmp(x, std::numeric_limits<unsigned long>::max()))};
+        ASSERT_EQ(u_expected, a.compare(std::numeric_limits<std::uint64_t>::max()));
+        ASSERT_EQ(u_expected > 0, std::numeric_limits<std::uint64_t>::max() < a);
+        ASSERT_EQ(sgn(cmp(x, 200)), a.compare(static_cast<std::uint8_t>(200)));
+        ASSERT_EQ(sgn(cmp(x, -100)), a.compare(static_cast<std::int8_t>(-100)));
+    }
+    ASSERT_EQ(TypeParam(), 0);
+    ASSERT_EQ(TypeParam(), TypeParam(0));
+    ASSERT_LT(TypeParam(-1), TypeParam());
+}
+
 BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(add, +)
 BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(sub, -)
 BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(mul, *)
+BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(bit_and, &)
+BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(bit_or, |)
+BIGINT_ARITHMETIC_OPERATOR_TEST_CASE(bit_xor, ^)
+
+TYPED_TEST(arithmetic_bigint_test, div)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    for (const auto& base_a : this->bases) {
+        for (const auto& exp_a : this->exponents) {
+            for (const auto& base_b : this->bases) {
+                for (const auto& exp_b : this->exponents) {
+                    for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+                        mpz_class a, b;
+                        mpz_ui_pow_ui(a.get_mpz_t(), base_a, exp_a);
+                        mpz_ui_pow_ui(b.get_mpz_t(), base_b, exp_b);
+                        a *= static_cast<unsigned long>(ran_dist(ran_engine));
+                        b *= static_cast<unsigned long>(ran_dist(ran_engine) >> (i % 64));
+
+                        for (const bool signed_a : {false, true}) {
+                            for (const bool signed_b : {false, true}) {
+                                TypeParam b_a((signed_a ? "-" : "") + a.get_str(16));
+                                TypeParam b_b((signed_b ? "-" : "") + b.get_str(16));
+
+                                if (b == 0) {
+                                    ASSERT_THROW(b_a / b_b, std::domain_error);
+                                    continue;
+                                }
+
+                                mpz_class mp_a{signed_a ? mpz_class(-a) : a};
+                                mpz_class mp_b{signed_b ? mpz_class(-b) : b};
+                                mpz_class q, r;
+                                mpz_tdiv_qr(q.get_mpz_t(), r.get_mpz_t(), mp_a.get_mpz_t(), mp_b.get_mpz_t());
+
+                                ASSERT_EQ((b_a / b_b).to_string(), q.get_str(16)) << "b_a: " << b_a << '\n'
+                                                                                  << "b_b: " << b_b << '\n';
+                                ASSERT_EQ((b_a % b_b).to_string(), r.get_str(16)) << "b_a: " << b_a << '\n'
+                                                                                  << "b_b: " << b_b << '\n';
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(util_bigint_test, accumulate)
+{
+    gmp_randclass ran_gen(gmp_randinit_default);
+    ran_gen.seed(std::random_device()());
+
+    TypeParam acc;
+    mpz_class mp_acc;
+    for (std::size_t i{0}; i < 2000; ++i) {
+        mpz_class x{ran_gen.get_z_bits(ran_gen.get_z_range(1024))};
+        if (i % 3 == 0)
+            x = -x;
+        TypeParam b_x((x < 0 ? "-" : "") + mpz_class(abs(x)).get_str(16));
+
+        if (i % 2 == 0) {
+            acc += b_x;
+            mp_acc += x;
+        } else {
+            acc -= b_x;
+            mp_acc -= x;
+        }
+        ASSERT_EQ(acc.to_string(), mp_acc.get_str(16)) << "x: " << x.get_str(16);
+    }
+
+    auto b{acc};
+    b += b;
+    ASSERT_EQ(b.to_string(), mpz_class(2 * mp_acc).get_str(16));
+    b -= b;
+    ASSERT_EQ(b.to_string(), "0");
+    ASSERT_FALSE(b.is_negative());
+}
+
+TYPED_TEST(util_bigint_test, increment)
+{
+    // the postfix operators return the old value and modify the number, also across 0 and limb borders
+    for (const auto& str : {"-2", "-1", "0", "1", "ff", "-100", "ffffffffffffffffffffffffffffffff",
+                            "-100000000000000000000000000000000"}) {
+        const TypeParam n(str);
+        auto a{n};
+        ASSERT_EQ(a++, n) << str;
+        ASSERT_EQ(a, n + 1) << str;
+        ASSERT_EQ(a--, n + 1) << str;
+        ASSERT_EQ(a, n) << str;
+        ASSERT_EQ(a--, n) << str;
+        ASSERT_EQ(a, n - 1) << str;
+        ASSERT_EQ(++a, n) << str;
+        ASSERT_EQ(--a, n - 1) << str;
+    }
+}
+
+TYPED_TEST(util_bigint_test, addmul)
+{
+    gmp_randclass ran_gen(gmp_randinit_default);
+    ran_gen.seed(std::random_device()());
+    const auto to_bigint = [](const mpz_class& n) {
+        return TypeParam((n < 0 ? "-" : "") + mpz_class(abs(n)).get_str(16));
+    };
+    const auto random = [&](std::size_t max_bits) {
+        mpz_class n{ran_gen.get_z_bits(ran_gen.get_z_range(max_bits))};
+        return ran_gen.get_z_bits(1) == 0 ? n : mpz_class(-n);
+    };
+
+    for (const std::size_t bits : {64, 200, 2000, 70000, 140000}) {
+        TypeParam acc;
+        mpz_class mp_acc;
+        for (std::size_t i{0}; i < 20; ++i) {
+            const auto a{random(bits)}, b{random(bits / 2)};
+            if (i % 5 == 0) { // the accumulator may be larger or smaller than the product
+                mp_acc = random(2 * bits);
+                acc = to_bigint(mp_acc);
+            }
+
+            if (i % 2 == 0) {
+                acc.addmul(to_bigint(a), to_bigint(b));
+                mp_acc += a * b;
+            } else {
+                acc.submul(to_bigint(a), to_bigint(b));
+                mp_acc -= a * b;
+            }
+            ASSERT_EQ(acc.to_string(), mp_acc.get_str(16)) << "a: " << a.get_str(16) << "\nb: " << b.get_str(16);
+        }
+
+        acc.submul(acc, TypeParam(1));
+        ASSERT_EQ(acc.to_string(), "0");
+        ASSERT_FALSE(acc.is_negative());
+        acc = to_bigint(mp_acc);
+        acc.addmul(acc, acc);
+        ASSERT_EQ(acc.to_string(), mpz_class(mp_acc + mp_acc * mp_acc).get_str(16));
+    }
+}
+
+TYPED_TEST(util_bigint_test, shift)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const std::array<std::size_t, 8> counts{{0, 1, 7, 63, 64, 65, 200, 5000}};
+    for (const auto& base : this->bases) {
+        for (const auto& exp : this->exponents) {
+            for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+                auto ran{ran_dist(ran_engine)};
+                for (const auto count : counts) {
+                    for (const bool sign : {false, true}) {
+                        mpz_class a;
+                        mpz_ui_pow_ui(a.get_mpz_t(), base, exp);
+                        a *= static_cast<unsigned long>(ran);
+                        if (sign)
+                            a = -a;
+                        TypeParam b_a((sign ? "-" : "") + mpz_class(abs(a)).get_str(16));
+
+                        mpz_class l, r;
+                        mpz_mul_2exp(l.get_mpz_t(), a.get_mpz_t(), count);
+                        mpz_fdiv_q_2exp(r.get_mpz_t(), a.get_mpz_t(), count);
+
+                        ASSERT_EQ((b_a << count).to_string(), l.get_str(16)) << "a: " << a.get_str(16) << '\n'
+                                                                             << "count: " << count << '\n';
+                        ASSERT_EQ((b_a >> count).to_string(), r.get_str(16)) << "a: " << a.get_str(16) << '\n'
+                                                                             << "count: " << count << '\n';
+                    }
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(util_bigint_test, bits)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    for (const auto& base : this->bases) {
+        for (const auto& exp : this->exponents) {
+            for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+                auto ran{ran_dist(ran_engine)};
+                for (const bool sign : {false, true}) {
+                    mpz_class a;
+                    mpz_ui_pow_ui(a.get_mpz_t(), base, exp);
+                    a *= static_cast<unsigned long>(ran);
+                    if (sign)
+                        a = -a;
+                    TypeParam b_a((sign ? "-" : "") + mpz_class(abs(a)).get_str(16));
+
+                    ASSERT_EQ((~b_a).to_string(), mpz_class(~a).get_str(16));
+                    ASSERT_EQ(b_a.bit_length(), a == 0 ? 0 : mpz_sizeinbase(a.get_mpz_t(), 2));
+                    ASSERT_EQ(b_a.popcount(), mpz_popcount(mpz_class(abs(a)).get_mpz_t()));
+                    for (std::size_t bit{0}; bit < b_a.bit_length() + 70; bit += 3)
+                        ASSERT_EQ(b_a.test_bit(bit), mpz_tstbit(a.get_mpz_t(), bit) == 1) << "bit: " << bit << '\n';
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(util_bigint_test, roots)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    for (const auto& base : this->bases) {
+        for (const auto& exp : this->exponents) {
+            for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+                auto ran{ran_dist(ran_engine)};
+                mpz_class a;
+                mpz_ui_pow_ui(a.get_mpz_t(), base, exp);
+                a *= static_cast<unsigned long>(ran);
+                TypeParam b_a(a.get_str(16));
+
+                for (const unsigned k : {2u, 3u, 5u, 16u}) {
+                    for (const bool sign : {false, true}) {
+                        if (sign && k % 2 == 0)
+                            continue;
+                        mpz_class n{sign ? mpz_class(-a) : a};
+                        mpz_class s, r;
+                        mpz_rootrem(s.get_mpz_t(), r.get_mpz_t(), n.get_mpz_t(), k);
+
+                        auto b_res{xenonis::rootrem(sign ? -b_a : b_a, k)};
+                        ASSERT_EQ(b_res.first.to_string(), s.get_str(16)) << "n: " << n.get_str(16) << "\nk: " << k;
+                        ASSERT_EQ(b_res.second.to_string(), r.get_str(16)) << "n: " << n.get_str(16) << "\nk: " << k;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(util_bigint_test, product)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::int64_t> ran_dist(std::numeric_limits<std::int32_t>::min(),
+                                                         std::numeric_limits<std::int32_t>::max());
+    for (const std::size_t size : {0, 1, 2, 3, 100, 1000, 10000}) {
+        std::vector<std::int64_t> values(size);
+        mpz_class mp_product{1};
+        for (auto& e : values) {
+            e = ran_dist(ran_engine);
+            mp_product *= static_cast<long>(e);
+        }
+
+        ASSERT_EQ(xenonis::product<TypeParam>(values.cbegin(), values.cend()).to_string(), mp_product.get_str(16))
+            << "size: " << size;
+        ASSERT_EQ(xenonis::product<TypeParam>(values.cbegin(), values.cend(), 4).to_string(), mp_product.get_str(16))
+            << "size: " << size;
+
+        std::vector<TypeParam> b_values;
+        for (const auto e : values)
+            b_values.emplace_back(e);
+        ASSERT_EQ(xenonis::product<TypeParam>(b_values.cbegin(), b_values.cend()).to_string(), mp_product.get_str(16))
+            << "size: " << size;
+    }
+}
+
+TYPED_TEST(util_bigint_test, factorial)
+{
+    for (const unsigned long n :
+         {0ul, 1ul, 2ul, 3ul, 4ul, 5ul, 10ul, 20ul, 21ul, 100ul, 127ul, 1000ul, 5000ul, 20000ul}) {
+        mpz_class f;
+        mpz_fac_ui(f.get_mpz_t(), n);
+        ASSERT_EQ(xenonis::factorial<TypeParam>(n).to_string(), f.get_str(16)) << "n: " << n;
+        ASSERT_EQ(xenonis::factorial<TypeParam>(n, 4).to_string(), f.get_str(16)) << "n: " << n;
+
+        for (const unsigned long k : {0ul, 1ul, 2ul, 7ul, n / 3, n / 2, n - 1, n, n + 1}) {
+            mpz_class b;
+            mpz_bin_uiui(b.get_mpz_t(), n, k);
+            ASSERT_EQ(xenonis::binomial<TypeParam>(n, k).to_string(), b.get_str(16)) << "n: " << n << "\nk: " << k;
+        }
+    }
+}
+
+TYPED_TEST(util_bigint_test, powmod)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const auto ran_num = [&](std::size_t limbs) {
+        mpz_class ret{0};
+        for (std::size_t i{0}; i < limbs; ++i)
+            ret = (ret << 64) + static_cast<unsigned long>(ran_dist(ran_engine));
+        return ret;
+    };
+
+    for (std::size_t i{0}; i < this->ran_count; ++i) {
+        auto a{ran_num(1 + ran_dist(ran_engine) % 40)};
+        if (i % 2 == 0)
+            a = -a;
+        const auto e{i % 100 == 0 ? mpz_class(0) : ran_num(1 + ran_dist(ran_engine) % 8)};
+        auto m{ran_num(1 + ran_dist(ran_engine) % 40)};
+        if (i % 4 != 0)
+            m |= 1;
+        if (m == 0)
+            continue;
+
+        mpz_class r;
+        mpz_powm(r.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), m.get_mpz_t());
+        ASSERT_EQ(TypeParam(a.get_str(16)).powmod(TypeParam(e.get_str(16)), TypeParam(m.get_str(16))).to_string(),
+                  r.get_str(16))
+            << "a: " << a.get_str(16) << "\ne: " << e.get_str(16) << "\nm: " << m.get_str(16);
+    }
+
+    ASSERT_THROW(TypeParam(2).powmod(TypeParam(2), TypeParam(0)), std::domain_error);
+    ASSERT_THROW(TypeParam(2).powmod(TypeParam(-2), TypeParam(3)), std::domain_error);
+}
+
+TYPED_TEST(util_bigint_test, pow)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const auto ran_num = [&](std::size_t limbs) {
+        mpz_class ret{0};
+        for (std::size_t i{0}; i < limbs; ++i)
+            ret = (ret << 64) + static_cast<unsigned long>(ran_dist(ran_engine));
+        return ret;
+    };
+
+    for (std::size_t i{0}; i < this->ran_count; ++i) {
+        auto a{ran_num(1 + ran_dist(ran_engine) % 8)};
+        if (i % 3 == 0)
+            a <<= static_cast<mp_bitcnt_t>(ran_dist(ran_engine) % 200);
+        if (i % 5 == 0)
+            a = mpz_class(1) << static_cast<mp_bitcnt_t>(ran_dist(ran_engine) % 200);
+        if (i % 2 == 0)
+            a = -a;
+        const auto e{static_cast<unsigned long>(ran_dist(ran_engine) % 200)};
+
+        mpz_class r;
+        mpz_pow_ui(r.get_mpz_t(), a.get_mpz_t(), e);
+        ASSERT_EQ(xenonis::pow(TypeParam(a.get_str(16)), e).to_string(), r.get_str(16))
+            << "a: " << a.get_str(16) << "\ne: " << e;
+
+        // squaring
+        auto b{TypeParam(a.get_str(16))};
+        b *= b;
+        ASSERT_EQ(b.to_string(), mpz_class(a * a).get_str(16)) << "a: " << a.get_str(16);
+    }
+
+    // squaring above the Karatsuba threshold
+    for (const std::size_t limbs : {50u, 100u, 333u, 1000u}) {
+        const auto a{ran_num(limbs)};
+        auto b{TypeParam(a.get_str(16))};
+        b *= b;
+        ASSERT_EQ(b.to_string(), mpz_class(a * a).get_str(16)) << "limbs: " << limbs;
+    }
+
+    mpz_class r;
+    mpz_ui_pow_ui(r.get_mpz_t(), 10, 10000);
+    ASSERT_EQ(TypeParam(10).pow(10000).to_string(), r.get_str(16));
+    ASSERT_EQ(TypeParam(0).pow(0), TypeParam(1));
+    ASSERT_EQ(TypeParam(0).pow(5), TypeParam(0));
+    ASSERT_EQ(TypeParam(-1).pow(3), TypeParam(-1));
+    ASSERT_EQ(TypeParam(-1).pow(4), TypeParam(1));
+}
+
+TYPED_TEST(util_bigint_test, gcd)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const auto ran_num = [&](std::size_t limbs) {
+        mpz_class ret{0};
+        for (std::size_t i{0}; i < limbs; ++i)
+            ret = (ret << 64) + static_cast<unsigned long>(ran_dist(ran_engine));
+        return ret;
+    };
+
+    for (std::size_t i{0}; i < this->ran_count; ++i) {
+        auto a{ran_num(ran_dist(ran_engine) % 40)};
+        auto b{ran_num(ran_dist(ran_engine) % 40)};
+        // common factors, the Lehmer steps have to cancel a large part of the numbers
+        if (i % 3 == 0) {
+            const auto g{ran_num(1 + ran_dist(ran_engine) % 20)};
+            a *= g;
+            b *= g;
+        }
+        if (i % 2 == 0)
+            a = -a;
+        if (i % 5 == 0)
+            b = -b;
+
+        mpz_class r;
+        mpz_gcd(r.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+        ASSERT_EQ(xenonis::gcd(TypeParam(a.get_str(16)), TypeParam(b.get_str(16))).to_string(), r.get_str(16))
+            << "a: " << a.get_str(16) << "\nb: " << b.get_str(16);
+    }
+
+    // consecutive Fibonacci numbers, every quotient is 1
+    mpz_class f_a, f_b;
+    mpz_fib2_ui(f_a.get_mpz_t(), f_b.get_mpz_t(), 5000);
+    ASSERT_EQ(xenonis::gcd(TypeParam(f_a.get_str(16)), TypeParam(f_b.get_str(16))), TypeParam(1));
+
+    ASSERT_EQ(xenonis::gcd(TypeParam(0), TypeParam(0)), TypeParam(0));
+    ASSERT_EQ(xenonis::gcd(TypeParam(0), TypeParam(-12)), TypeParam(12));
+    ASSERT_EQ(xenonis::gcd(TypeParam(-12), TypeParam(18)), TypeParam(6));
+}
+
+TYPED_TEST(util_bigint_test, prime)
+{
+    for (unsigned long n{0}; n < 10000; ++n)
+        ASSERT_EQ(xenonis::is_probable_prime(TypeParam(static_cast<std::uint64_t>(n))),
+                  mpz_probab_prime_p(mpz_class(n).get_mpz_t(), 25) != 0)
+            << "n: " << n;
+
+    // strong pseudoprimes to base 2, Carmichael numbers and the square of a prime
+    for (const char* n : {"3215031751", "2152302898747", "3474749660383", "341550071728321", "3825123056546413051",
+                          "318665857834031151167461", "3317044064679887385961981", "9746347772161",
+                          "1000000000000000006000000000000000009"})
+        ASSERT_FALSE(xenonis::is_probable_prime(TypeParam(mpz_class(n).get_str(16)))) << "n: " << n;
+
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    for (std::size_t i{0}; i < this->ran_count / 10; ++i) {
+        mpz_class n{0};
+        for (auto limbs{1 + ran_dist(ran_engine) % 8}; limbs-- > 0;)
+            n = (n << 64) + static_cast<unsigned long>(ran_dist(ran_engine));
+
+        mpz_class p;
+        mpz_nextprime(p.get_mpz_t(), n.get_mpz_t());
+        const auto b_p{xenonis::next_prime(TypeParam(n.get_str(16)))};
+        ASSERT_EQ(b_p.to_string(), p.get_str(16)) << "n: " << n.get_str(16);
+        ASSERT_TRUE(xenonis::is_probable_prime(b_p, 4)) << "p: " << p.get_str(16);
+        ASSERT_EQ(xenonis::is_probable_prime(TypeParam(n.get_str(16))), mpz_probab_prime_p(n.get_mpz_t(), 25) != 0)
+            << "n: " << n.get_str(16);
+    }
+}
+
+TYPED_TEST(util_bigint_test, random)
+{
+    xenonis::xoshiro256x4 engine(this->ran_count);
+    std::mt19937 engine32(static_cast<std::mt19937::result_type>(this->ran_count));
+
+    EXPECT_TRUE(xenonis::random_bits<TypeParam>(0, engine).is_zero());
+    for (const std::size_t bits : {1, 7, 8, 31, 64, 65, 200}) {
+        std::size_t max_bits{0};
+        for (std::size_t i{0}; i < 64; ++i) {
+            const auto n{xenonis::random_bits<TypeParam>(bits, engine)};
+            const auto n32{xenonis::random_bits<TypeParam>(bits, engine32)};
+            ASSERT_FALSE(n.is_negative());
+            ASSERT_LE(n.bit_length(), bits);
+            ASSERT_LE(n32.bit_length(), bits);
+            max_bits = std::max({max_bits, n.bit_length(), n32.bit_length()});
+        }
+        EXPECT_EQ(max_bits, bits);
+    }
+
+    const TypeParam bound(10);
+    std::array<std::size_t, 10> hits{};
+    for (std::size_t i{0}; i < this->ran_count; ++i) {
+        const auto n{xenonis::random_below(bound, engine)};
+        ASSERT_FALSE(n.is_negative());
+        ASSERT_LT(n, bound);
+        ++hits[std::stoul(n.to_string())];
+    }
+    for (const auto hit : hits)
+        EXPECT_GT(hit, 0u);
+
+    const TypeParam large("123456789abcdef0123456789abcdef");
+    for (std::size_t i{0}; i < this->ran_count / 10; ++i)
+        ASSERT_LT(xenonis::random_below(large, engine), large);
+
+    EXPECT_THROW(xenonis::random_below(TypeParam(0), engine), std::domain_error);
+    EXPECT_THROW(xenonis::random_below(TypeParam(-5), engine), std::domain_error);
+}
+
+TEST(random_test, xoshiro256x4)
+{
+    // the reference implementation of xoshiro256**, seeded like the first generator
+    std::uint64_t seed{42};
+    std::array<std::uint64_t, 4> s;
+    for (auto& word : s) {
+        auto z{seed += 0x9e3779b97f4a7c15};
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        word = z ^ (z >> 31);
+    }
+    const auto rotl = [](std::uint64_t x, unsigned k) { return (x << k) | (x >> (64 - k)); };
+
+    xenonis::xoshiro256x4 engine(42), other(42);
+    std::vector<std::uint64_t> generated(1001);
+    other();
+    other.generate(generated.begin() + 1, generated.end());
+    for (std::size_t i{0}; i < 1000; ++i) {
+        const auto n{engine()};
+        if (i % xenonis::xoshiro256x4::lanes == 0) {
+            ASSERT_EQ(n, rotl(s[1] * 5, 7) * 9) << "i: " << i;
+            const auto t{s[1] << 17};
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+        }
+        if (i > 0) {
+            ASSERT_EQ(n, generated[i]) << "i: " << i;
+        }
+    }
+}
+
+TEST(batch_test, arithmetic)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist;
+
+    for (const std::size_t limbs : {1, 4, 8}) {
+        // 19 numbers: two lane groups and a tail
+        constexpr std::size_t count{19};
+        mpz_class modulus{1};
+        modulus <<= static_cast<mp_bitcnt_t>(limbs * 64);
+
+        xenonis::batch<std::uint64_t> a(count, limbs), b(count, limbs);
+        std::vector<mpz_class> mp_a(count), mp_b(count);
+        for (std::size_t j{0}; j < count; ++j) {
+            for (std::size_t i{0}; i < limbs; ++i) {
+                a.limb(j, i) = ran_dist(ran_engine);
+                b.limb(j, i) = j % 5 == 0 ? a.limb(j, i) : ran_dist(ran_engine);
+            }
+            if (j % 7 == 0) // equal in the lower limbs only
+                b.limb(j, limbs - 1) = a.limb(j, limbs - 1) + 1;
+            mp_a[j] = mpz_class(a.get(j).to_string(), 16);
+            mp_b[j] = mpz_class(b.get(j).to_string(), 16);
+        }
+
+        const auto sum{a + b}, diff{a - b}, prod{a * b};
+        const auto results{compare(a, b)};
+        for (std::size_t j{0}; j < count; ++j) {
+            const mpz_class mp_sum{mp_a[j] + mp_b[j]};
+            const mpz_class mp_diff{(mp_a[j] - mp_b[j] + modulus) % modulus};
+            const mpz_class mp_prod{(mp_a[j] * mp_b[j]) % modulus};
+            ASSERT_EQ(sum.get(j).to_string(), mpz_class(mp_sum % modulus).get_str(16)) << "number: " << j;
+            ASSERT_EQ(sum.carries()[j], mp_sum >= modulus) << "number: " << j;
+            ASSERT_EQ(diff.get(j).to_string(), mp_diff.get_str(16)) << "number: " << j;
+            ASSERT_EQ(diff.carries()[j], mp_a[j] < mp_b[j]) << "number: " << j;
+            ASSERT_EQ(prod.get(j).to_string(), mp_prod.get_str(16)) << "number: " << j;
+            const int expected{cmp(mp_a[j], mp_b[j]) > 0 ? 1 : (cmp(mp_a[j], mp_b[j]) < 0 ? -1 : 0)};
+            ASSERT_EQ(results[j], expected) << "number: " << j;
+        }
+
+        xenonis::batch<std::uint64_t> c(count, limbs);
+        c.set(0, xenonis::bigint64(-1));
+        c.set(1, xenonis::bigint64("123456789abcdef0123456789abcdef0123456789abcdef"));
+        ASSERT_EQ(c.get(0).to_string(), mpz_class(modulus - 1).get_str(16));
+        ASSERT_EQ(c.get(1).to_string(),
+                  mpz_class(mpz_class("123456789abcdef0123456789abcdef0123456789abcdef", 16) % modulus).get_str(16));
+    }
+
+    ASSERT_THROW(xenonis::batch<std::uint64_t>(2, 2) + xenonis::batch<std::uint64_t>(2, 3), std::invalid_argument);
+}
+
+// the fixed-width integers are usable in constant expressions
+static_assert((xenonis::uint128(1) << 100) >> 100 == 1);
+static_assert(xenonis::uint256(0) - 1 == ~xenonis::uint256(0));
+static_assert(xenonis::int128(-3) * xenonis::int128(5) == -15);
+static_assert(xenonis::int256(-7) / 2 == -3 && xenonis::int256(-7) % 2 == -1);
+static_assert(xenonis::int128(-1) < 0 && xenonis::uint128(-1) > 0);
+
+#if defined(XENONIS_CONSTEXPR_BIGINT)
+// with C++20 the bigints are usable in constant expressions as long as they do not escape the evaluation
+static_assert([] {
+    const xenonis::bigint64 a("123456789abcdef0123456789abcdef");
+    const xenonis::bigint64 b("-fedcba9876543210fedcba9876543210fedcba98");
+    return (a * b - 1) / a == b && (a * b - 1) % a == -1 && -(a * b) / b == -a;
+}());
+static_assert(xenonis::bigint32(std::uint64_t{1} << 63) * 2 - 1 == xenonis::bigint32(~std::uint64_t{0}));
+static_assert(((xenonis::bigint64(1) << 200) >> 199) == 2);
+static_assert(xenonis::isqrt(xenonis::bigint64("1000000000000000000000000000000000000")).to_string() ==
+              "1000000000000000000");
+static_assert(xenonis::uint256(xenonis::bigint64(-1)) == ~xenonis::uint256(0));
+static_assert([] {
+    xenonis::bigint64 a(0);
+    return a-- == 0 && a == -1 && a++ == -1 && a++ == 0 && a == 1;
+}());
+#endif
+
+template <class Fixed> void fixed_integer_test(bool is_signed, std::size_t bits)
+{
+    gmp_randclass ran_gen(gmp_randinit_default);
+    ran_gen.seed(std::random_device()());
+
+    mpz_class modulus{1};
+    modulus <<= static_cast<mp_bitcnt_t>(bits);
+    const auto wrap = [&](const mpz_class& n) {
+        mpz_class ret{n % modulus};
+        if (ret < 0)
+            ret += modulus;
+        if (is_signed && ret >= modulus / 2)
+            ret -= modulus;
+        return ret.get_str(16);
+    };
+    const auto to_string = [](const Fixed& n) { return static_cast<xenonis::bigint64>(n).to_string(); };
+
+    for (std::size_t i{0}; i < 1000; ++i) {
+        // up to 16 more bits than fit, so that the conversion has to wrap
+        auto a_str{mpz_class(ran_gen.get_z_bits(ran_gen.get_z_range(bits + 16))).get_str(16)};
+        auto b_str{mpz_class(ran_gen.get_z_bits(ran_gen.get_z_range(bits + 16))).get_str(16)};
+        if (i % 3 == 0)
+            a_str = '-' + a_str;
+        if (i % 5 == 0)
+            b_str = '-' + b_str;
+
+        const xenonis::bigint64 b_a(a_str), b_b(b_str);
+        const Fixed a(b_a), b(b_b);
+        const mpz_class mp_a(wrap(mpz_class(a_str, 16)), 16), mp_b(wrap(mpz_class(b_str, 16)), 16);
+
+        ASSERT_EQ(to_string(a), mp_a.get_str(16)) << "a: " << a_str;
+        ASSERT_EQ(a.to_string(), mp_a.get_str(16)) << "a: " << a_str;
+        ASSERT_EQ(to_string(a + b), wrap(mp_a + mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(a - b), wrap(mp_a - mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(a * b), wrap(mp_a * mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(a & b), wrap(mp_a & mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(a | b), wrap(mp_a | mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(a ^ b), wrap(mp_a ^ mp_b)) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(to_string(-a), wrap(-mp_a)) << "a: " << a_str;
+        ASSERT_EQ(a < b, mp_a < mp_b) << "a: " << a_str << "\nb: " << b_str;
+        ASSERT_EQ(a == b, mp_a == mp_b) << "a: " << a_str << "\nb: " << b_str;
+        if (!b.is_zero()) {
+            mpz_class q, r;
+            mpz_tdiv_qr(q.get_mpz_t(), r.get_mpz_t(), mp_a.get_mpz_t(), mp_b.get_mpz_t());
+            ASSERT_EQ(to_string(a / b), wrap(q)) << "a: " << a_str << "\nb: " << b_str;
+            ASSERT_EQ(to_string(a % b), wrap(r)) << "a: " << a_str << "\nb: " << b_str;
+        } else {
+            ASSERT_THROW(a / b, std::domain_error);
+        }
+
+        const std::size_t shift{i % (bits + 10)};
+        const auto mp_shift{static_cast<mp_bitcnt_t>(shift)};
+        ASSERT_EQ(to_string(a << shift), wrap(mp_a << mp_shift)) << "a: " << a_str << "\nshift: " << shift;
+        if (is_signed) {
+            mpz_class mp_c;
+            mpz_fdiv_q_2exp(mp_c.get_mpz_t(), mp_a.get_mpz_t(), mp_shift);
+            ASSERT_EQ(to_string(a >> shift), wrap(mp_c)) << "a: " << a_str << "\nshift: " << shift;
+        } else {
+            ASSERT_EQ(to_string(a >> shift), wrap(mp_a >> mp_shift)) << "a: " << a_str << "\nshift: " << shift;
+        }
+    }
+}
+
+TEST(multimod_test, arithmetic)
+{
+    xenonis::xoshiro256x4 engine(5);
+
+    for (const std::size_t count : {1, 2, 5, 32}) {
+        const xenonis::multimod_basis<xenonis::bigint64> basis(count);
+        ASSERT_EQ(basis.size(), count);
+        mpz_class modulus{1};
+        for (const auto m : basis.moduli()) {
+            ASSERT_LT(m, std::uint64_t{1} << 63);
+            ASSERT_NE(mpz_probab_prime_p(mpz_class(std::to_string(m)).get_mpz_t(), 25), 0) << "m: " << m;
+            modulus *= mpz_class(std::to_string(m));
+        }
+        ASSERT_EQ(basis.product().to_string(), modulus.get_str(16));
+
+        for (std::size_t i{0}; i < 100; ++i) {
+            // up to twice the size of the product of the moduli
+            auto a{xenonis::random_bits<xenonis::bigint64>(engine() % (count * 126 + 1), engine)};
+            const auto b{xenonis::random_bits<xenonis::bigint64>(engine() % (count * 63 + 1), engine)};
+            if (i % 3 == 0)
+                a = -a;
+            const mpz_class mp_a(a.to_string(), 16), mp_b(b.to_string(), 16);
+
+            const xenonis::multimod<xenonis::bigint64> x(a, basis), y(b, basis);
+            const auto z{-(x * y + x - y)};
+            mpz_class expected{-(mp_a * mp_b + mp_a - mp_b) % modulus};
+            if (expected < 0)
+                expected += modulus;
+            ASSERT_EQ(z.to_bigint().to_string(), expected.get_str(16)) << "a: " << a << " b: " << b;
+            if (expected > modulus / 2)
+                expected -= modulus;
+            ASSERT_EQ(z.to_signed_bigint().to_string(), expected.get_str(16)) << "a: " << a << " b: " << b;
+
+            const auto residues{basis.residues(a)};
+            mpz_class mp_a_mod{mp_a % modulus};
+            if (mp_a_mod < 0)
+                mp_a_mod += modulus;
+            ASSERT_EQ(basis.reconstruct(residues).to_string(), mp_a_mod.get_str(16));
+            for (std::size_t j{0}; j < count; ++j)
+                ASSERT_EQ(x.residue(j), residues[j]);
+            ASSERT_TRUE(x - x == xenonis::multimod<xenonis::bigint64>(xenonis::bigint64(0), basis));
+        }
+    }
+
+    ASSERT_THROW(xenonis::multimod_basis<xenonis::bigint64>({3, 5, 9}), std::invalid_argument);
+    ASSERT_THROW(xenonis::multimod_basis<xenonis::bigint64>({3, 8}), std::invalid_argument);
+    ASSERT_THROW(xenonis::multimod_basis<xenonis::bigint64>({3, std::uint64_t{1} << 63 | 1}), std::invalid_argument);
+    const xenonis::multimod_basis<xenonis::bigint64> small({3, 5, 7}), other({3, 5, 7});
+    ASSERT_THROW(xenonis::multimod<xenonis::bigint64>(xenonis::bigint64(1), small) *
+                     xenonis::multimod<xenonis::bigint64>(xenonis::bigint64(1), other),
+                 std::invalid_argument);
+}
+
+template <class Rational> void rational_test()
+{
+    xenonis::xoshiro256x4 engine(9);
+    const auto ran_rational = [&] {
+        auto num{xenonis::random_bits<xenonis::bigint>(engine() % 300, engine)};
+        auto den{xenonis::random_bits<xenonis::bigint>(1 + engine() % 300, engine)};
+        if (den.is_zero())
+            den = xenonis::bigint(1);
+        if (engine() % 2 == 0)
+            num = -num;
+        // integers and shared factors take the fast paths
+        switch (engine() % 4) {
+        case 0:
+            den = xenonis::bigint(1);
+            break;
+        case 1:
+            num *= xenonis::bigint(6);
+            den *= xenonis::bigint(10);
+            break;
+        default:
+            break;
+        }
+        return Rational(num, den);
+    };
+    const auto to_mpq = [](const Rational& r) {
+        return mpq_class(mpz_class(r.numerator().to_string(), 16), mpz_class(r.denominator().to_string(), 16));
+    };
+    const auto check = [&](const Rational& r, const mpq_class& expected) {
+        // the denominator is positive and the fraction is canonical
+        ASSERT_EQ(r.to_string(), expected.get_str(16));
+        ASSERT_EQ(r.numerator().to_string(), expected.get_num().get_str(16));
+        ASSERT_EQ(r.denominator().to_string(), expected.get_den().get_str(16));
+    };
+
+    for (std::size_t i{0}; i < 200; ++i) {
+        const auto a{ran_rational()};
+        const auto b{ran_rational()};
+        const auto mp_a{to_mpq(a)};
+        const auto mp_b{to_mpq(b)};
+
+        check(a + b, mp_a + mp_b);
+        check(a - b, mp_a - mp_b);
+        check(a * b, mp_a * mp_b);
+        if (!b.is_zero())
+            check(a / b, mp_a / mp_b);
+        check(-a, -mp_a);
+
+        // chains, the lazy numbers are canonicalised at the end only
+        auto c{a};
+        mpq_class mp_c{mp_a};
+        for (std::size_t j{0}; j < 5; ++j) {
+            c += b;
+            c *= a;
+            c -= a;
+            mp_c += mp_b;
+            mp_c *= mp_a;
+            mp_c -= mp_a;
+        }
+        check(c, mp_c);
+
+        auto d{a};
+        d += d;
+        check(d, mp_a + mp_a);
+        d -= d;
+        check(d, 0);
+        d = a;
+        d *= d;
+        check(d, mp_a * mp_a);
+        if (!a.is_zero()) {
+            d /= d;
+            check(d, 1);
+        }
+
+        ASSERT_EQ(a == b, mp_a == mp_b);
+        ASSERT_EQ(a != b, mp_a != mp_b);
+        ASSERT_EQ(a < b, mp_a < mp_b);
+        ASSERT_EQ(a > b, mp_a > mp_b);
+        ASSERT_EQ(a <= b, mp_a <= mp_b);
+        ASSERT_EQ(a >= b, mp_a >= mp_b);
+        ASSERT_EQ(a.is_integer(), mp_a.get_den() == 1);
+        ASSERT_TRUE(b.is_zero() || a * b / b == a);
+    }
+
+    check(Rational("-c/8"), mpq_class(-3, 2));
+    check(Rational("6/-4"), mpq_class(-3, 2));
+    check(Rational("ff"), mpq_class(255));
+    check(Rational("0/5"), mpq_class(0));
+    ASSERT_EQ(Rational(xenonis::bigint(2), xenonis::bigint(4)), Rational(xenonis::bigint(1), xenonis::bigint(2)));
+    ASSERT_THROW(Rational(xenonis::bigint(1), xenonis::bigint(0)), std::domain_error);
+    ASSERT_THROW(Rational("1/0"), std::domain_error);
+    ASSERT_THROW(Rational(xenonis::bigint(1)) / Rational(xenonis::bigint(0)), std::domain_error);
+}
+
+TEST(rational_test, arithmetic)
+{
+    rational_test<xenonis::rational>();
+    rational_test<xenonis::lazy_rational>();
+
+    xenonis::lazy_rational lazy;
+    for (unsigned i{1}; i <= 20; ++i)
+        lazy += xenonis::lazy_rational(xenonis::bigint(1), xenonis::bigint(i));
+    const xenonis::rational eager(lazy);
+    ASSERT_EQ(eager.to_string(), mpq_class("55835135/15519504", 10).get_str(16));
+    ASSERT_TRUE(xenonis::lazy_rational(eager) == lazy);
+}
+
+// rounds num / den * 2^exp (num, den > 0) to p bits, ties to even. A set inexact flag means that the exact value is
+// slightly larger. Returns the mantissa without trailing zeros and the exponent.
+static std::pair<mpz_class, std::int64_t> bigfloat_reference(mpz_class num, mpz_class den, std::int64_t exp,
+                                                             std::size_t p, bool inexact = false)
+{
+    const auto bits = [](const mpz_class& n) { return static_cast<std::int64_t>(mpz_sizeinbase(n.get_mpz_t(), 2)); };
+    const auto shift{static_cast<std::int64_t>(p) + 2 + bits(den) - bits(num)};
+    if (shift > 0) {
+        num <<= static_cast<mp_bitcnt_t>(shift);
+        exp -= shift;
+    }
+    mpz_class q, r;
+    mpz_fdiv_qr(q.get_mpz_t(), r.get_mpz_t(), num.get_mpz_t(), den.get_mpz_t());
+
+    const auto s{static_cast<mp_bitcnt_t>(bits(q) - static_cast<std::int64_t>(p))};
+    const bool half{mpz_tstbit(q.get_mpz_t(), s - 1) != 0};
+    const bool sticky{inexact || r != 0 || mpz_scan1(q.get_mpz_t(), 0) < s - 1};
+    q >>= s;
+    exp += static_cast<std::int64_t>(s);
+    if (half && (sticky || mpz_odd_p(q.get_mpz_t())))
+        ++q;
+    while (mpz_even_p(q.get_mpz_t())) {
+        q >>= 1;
+        ++exp;
+    }
+    return std::make_pair(q, exp);
+}
+
+TEST(bigfloat_test, arithmetic)
+{
+    xenonis::xoshiro256x4 engine(11);
+    const auto to_mpq = [](const xenonis::bigfloat& x) {
+        mpq_class ret{mpz_class(x.mantissa().to_string(), 16)};
+        if (x.exponent() >= 0)
+            ret *= mpq_class(mpz_class(1) << static_cast<mp_bitcnt_t>(x.exponent()));
+        else
+            ret /= mpq_class(mpz_class(1) << static_cast<mp_bitcnt_t>(-x.exponent()));
+        return ret;
+    };
+    const auto check = [](const xenonis::bigfloat& x, const mpq_class& exact, std::size_t p) {
+        ASSERT_EQ(x.precision(), p);
+        if (exact == 0) {
+            ASSERT_TRUE(x.is_zero());
+            return;
+        }
+        const auto [mantissa, exp] = bigfloat_reference(abs(exact.get_num()), exact.get_den(), 0, p);
+        ASSERT_EQ(x.mantissa().to_string(), mpz_class(exact < 0 ? -mantissa : mantissa).get_str(16));
+        ASSERT_EQ(x.exponent(), exp);
+    };
+
+    const std::array<std::size_t, 8> precisions{{1, 2, 53, 64, 100, 333, 2000, 5000}};
+    for (std::size_t i{0}; i < 2000; ++i) {
+        const auto p_a{precisions[engine() % precisions.size()]};
+        const auto p_b{i % 2 == 0 ? p_a : precisions[engine() % precisions.size()]};
+        const auto p{std::max(p_a, p_b)};
+        const auto ran_bigfloat = [&](std::size_t precision) {
+            auto mantissa{xenonis::random_bits<xenonis::bigint>(engine() % (2 * precision + 2), engine)};
+            if (engine() % 2 == 0)
+                mantissa = -mantissa;
+            // large differences of the exponents take the sticky bit path of the addition
+            const auto exp{static_cast<std::int64_t>(engine() % (i % 5 == 0 ? 20000 : 400)) - 200};
+            return xenonis::bigfloat(mantissa, exp, precision);
+        };
+        const auto a{ran_bigfloat(p_a)};
+        const auto b{ran_bigfloat(p_b)};
+        const auto mp_a{to_mpq(a)};
+        const auto mp_b{to_mpq(b)};
+
+        check(a + b, mp_a + mp_b, p);
+        check(a - b, mp_a - mp_b, p);
+        check(a * b, mp_a * mp_b, p);
+        if (!b.is_zero())
+            check(a / b, mp_a / mp_b, p);
+
+        ASSERT_EQ(a == b, mp_a == mp_b);
+        ASSERT_EQ(a < b, mp_a < mp_b);
+        ASSERT_EQ(a > b, mp_a > mp_b);
+        ASSERT_EQ(a <= b, mp_a <= mp_b);
+        ASSERT_EQ(a >= b, mp_a >= mp_b);
+
+        // sqrt(m * 2^e) = sqrt(m * 2^(e + 2k)) * 2^-k, the root of the integer is truncated
+        if (!a.is_zero() && !a.is_negative()) {
+            const auto root{sqrt(a)};
+            mpz_class t(a.mantissa().to_string(), 16);
+            const auto k{static_cast<std::int64_t>(2 * p_a + 4) + std::abs(a.exponent())};
+            t <<= static_cast<mp_bitcnt_t>(a.exponent() + 2 * k);
+            mpz_class s, r;
+            mpz_sqrtrem(s.get_mpz_t(), r.get_mpz_t(), t.get_mpz_t());
+            const auto [mantissa, exp] = bigfloat_reference(s, 1, -k, p_a, r != 0);
+            ASSERT_EQ(root.mantissa().to_string(), mantissa.get_str(16));
+            ASSERT_EQ(root.exponent(), exp);
+        }
+    }
+
+    // the bits below the rounding bit of the short product are zeros, it has to fall back to the full product
+    for (const std::size_t p : {2000u, 5000u}) {
+        const xenonis::bigfloat a((xenonis::bigint(1) << p) - xenonis::bigint(1), 0, p);
+        const xenonis::bigfloat b((xenonis::bigint(1) << p) + xenonis::bigint(1), -1, p + 1);
+        check(a * a, to_mpq(a) * to_mpq(a), p);
+        check(a * b, to_mpq(a) * to_mpq(b), p + 1);
+    }
+
+    // the conversions of doubles and the decimal output match the C library
+    std::uniform_real_distribution<double> ran_dist(-1, 1);
+    std::default_random_engine ran_engine(3);
+    for (std::size_t i{0}; i < 1000; ++i) {
+        const auto d{std::ldexp(ran_dist(ran_engine), static_cast<int>(ran_engine() % 200) - 100)};
+        const xenonis::bigfloat x(d);
+        ASSERT_EQ(x.to_double(), d);
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.16e", d);
+        ASSERT_EQ(x.to_string(), buffer);
+        std::snprintf(buffer, sizeof(buffer), "%.4e", d);
+        ASSERT_EQ(x.to_string(5), buffer);
+        ASSERT_EQ(xenonis::bigfloat(d, 200).to_double(), d);
+    }
+
+    ASSERT_EQ(xenonis::bigfloat(2.0, 200).to_string(), "2." + std::string(61, '0') + "e+00");
+    ASSERT_EQ(sqrt(xenonis::bigfloat(2.0, 200)).to_string(20), "1.4142135623730950488e+00");
+    ASSERT_EQ((xenonis::bigfloat(1.0, 100) / xenonis::bigfloat(3.0)).to_string(10), "3.333333333e-01");
+    ASSERT_EQ(xenonis::bigfloat(0.0).to_string(), "0");
+    ASSERT_THROW(xenonis::bigfloat(1.0) / xenonis::bigfloat(), std::domain_error);
+    ASSERT_THROW(sqrt(xenonis::bigfloat(-1.0)), std::domain_error);
+    ASSERT_THROW(xenonis::bigfloat(std::numeric_limits<double>::infinity()), std::domain_error);
+    ASSERT_THROW(xenonis::bigfloat(1.0, 0), std::invalid_argument);
+}
+
+TEST(fixed_integer_test, arithmetic)
+{
+    fixed_integer_test<xenonis::uint128>(false, 128);
+    fixed_integer_test<xenonis::uint256>(false, 256);
+    fixed_integer_test<xenonis::uint1024>(false, 1024);
+    fixed_integer_test<xenonis::int128>(true, 128);
+    fixed_integer_test<xenonis::int512>(true, 512);
+
+    ASSERT_EQ(xenonis::int256(xenonis::int128(-5)), -5);
+    ASSERT_EQ(xenonis::uint256(xenonis::uint128(-5)).to_string(), "fffffffffffffffffffffffffffffffb");
+    ASSERT_EQ(xenonis::int128(-5).to_string(), "-5");
+}
+
+TEST(karatsuba_test, sparse_operands)
+{
+    using container = xenonis::internal::bigint_data<std::uint64_t>;
+    using iter = const std::uint64_t*;
+
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    // the operands have zero low or high halves (the latter are not normalized), zero runs or only ones, so every
+    // shortcut of the recursion is used
+    const auto ran_limbs = [&](std::size_t limbs) {
+        container ret(limbs, 0);
+        const auto pattern{ran_dist(ran_engine) % 5};
+        for (std::size_t i{0}; i < limbs; ++i) {
+            if ((pattern == 0 && i < limbs / 2) || (pattern == 1 && i >= limbs / 2) ||
+                (pattern == 2 && ran_dist(ran_engine) % 2 == 0))
+                continue;
+            ret[i] = pattern == 3 ? std::numeric_limits<std::uint64_t>::max() : ran_dist(ran_engine);
+        }
+        return ret;
+    };
+
+    const auto check = [&](auto threshold) {
+        constexpr std::size_t t{decltype(threshold)::value};
+        for (std::size_t i{0}; i < 1000; ++i) {
+            const auto a{ran_limbs(1 + ran_dist(ran_engine) % 40)};
+            const auto b{ran_limbs(1 + ran_dist(ran_engine) % (i % 2 == 0 ? 40 : 8))};
+            container expected(a.size() + b.size(), 0);
+            xenonis::algorithms::naive_mul(a.cbegin(), a.cend(), b.cbegin(), b.cend(), expected.begin());
+
+            const auto product{xenonis::algorithms::internal::karatsuba_mul_unnormalized<container, iter, t>(
+                a.cbegin(), a.cend(), b.cbegin(), b.cend())};
+            ASSERT_EQ(product.size(), a.size() + b.size());
+            ASSERT_TRUE(std::equal(product.cbegin(), product.cend(), expected.cbegin()));
+
+            xenonis::algorithms::remove_zeros(expected);
+            const auto normalized{
+                xenonis::algorithms::karatsuba_mul<container, iter, t>(a.cbegin(), a.cend(), b.cbegin(), b.cend())};
+            ASSERT_EQ(normalized.size(), expected.size());
+            ASSERT_TRUE(std::equal(normalized.cbegin(), normalized.cend(), expected.cbegin()));
+        }
+    };
+
+    // small thresholds, so the recursion is used
+    check(std::integral_constant<std::size_t, 2>{});
+    check(std::integral_constant<std::size_t, 3>{});
+    check(std::integral_constant<std::size_t, 4>{});
+}
+
+TEST(short_product_test, mullo_mulhi)
+{
+    using container = xenonis::internal::bigint_data<std::uint64_t>;
+    using iter = const std::uint64_t*;
+
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    // every third pair of operands consists of ones only, which maximizes the carries
+    const auto ran_limbs = [&](std::size_t limbs, bool ones) {
+        container ret(limbs);
+        for (auto& limb : ret)
+            limb = ones ? std::numeric_limits<std::uint64_t>::max() : ran_dist(ran_engine);
+        ret.back() |= 1;
+        return ret;
+    };
+    const auto to_mpz = [](const container& a) {
+        mpz_class ret{0};
+        for (auto it{a.crbegin()}; it != a.crend(); ++it)
+            ret = (ret << 64) + static_cast<unsigned long>(*it);
+        return ret;
+    };
+
+    // small thresholds, so the recursion is used
+    for (std::size_t i{0}; i < 300; ++i) {
+        const auto a{ran_limbs(1 + ran_dist(ran_engine) % 70, i % 3 == 0)};
+        const auto b{ran_limbs(1 + ran_dist(ran_engine) % 70, i % 3 == 0)};
+        const auto n{1 + ran_dist(ran_engine) % (a.size() + b.size() + 2)};
+        const mpz_class product{to_mpz(a) * to_mpz(b)};
+
+        const auto lo{xenonis::algorithms::mullo<container, iter, 4>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n)};
+        ASSERT_EQ(to_mpz(lo), product % (mpz_class(1) << (64 * n)))
+            << "a: " << to_mpz(a).get_str(16) << "\nb: " << to_mpz(b).get_str(16) << "\nn: " << n;
+
+        const auto shift{a.size() + b.size() > n ? 64 * (a.size() + b.size() - n) : 0};
+        const mpz_class exact{product >> shift};
+        const auto check_mulhi = [&](const container& hi) {
+            const mpz_class error{exact - to_mpz(hi)};
+            ASSERT_GE(error, 0);
+            ASSERT_LE(error, 2 * n + 2);
+            ASSERT_LE(hi.size(), n);
+        };
+        check_mulhi(xenonis::algorithms::mulhi<container, iter, 4>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n));
+        check_mulhi(xenonis::algorithms::mulhi<container, iter, 8>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n));
+        check_mulhi(xenonis::algorithms::mulhi<container>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n));
+    }
+}
+
+TEST(short_product_test, sparse_operands)
+{
+    using container = xenonis::internal::bigint_data<std::uint64_t>;
+    using iter = const std::uint64_t*;
+
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    // the low or the high half of an operand is zero, so the Karatsuba recursion takes its shortcuts
+    const auto ran_limbs = [&](std::size_t limbs, bool low_zero) {
+        container ret(limbs, 0);
+        for (std::size_t i{low_zero ? limbs / 2 : 0}; i < (low_zero ? limbs : limbs / 2); ++i)
+            ret[i] = ran_dist(ran_engine);
+        ret.back() |= 1;
+        return ret;
+    };
+    const auto to_mpz = [](const container& a) {
+        mpz_class ret{0};
+        for (auto it{a.crbegin()}; it != a.crend(); ++it)
+            ret = (ret << 64) + static_cast<unsigned long>(*it);
+        return ret;
+    };
+
+    const auto check = [&](auto threshold) {
+        constexpr std::size_t t{decltype(threshold)::value};
+        for (std::size_t i{0}; i < 500; ++i) {
+            const auto a{ran_limbs(2 + ran_dist(ran_engine) % 60, i % 2 == 0)};
+            const auto b{ran_limbs(2 + ran_dist(ran_engine) % 60, i % 4 < 2)};
+            const auto n{1 + ran_dist(ran_engine) % (a.size() + b.size())};
+            const mpz_class product{to_mpz(a) * to_mpz(b)};
+
+            const auto lo{xenonis::algorithms::mullo<container, iter, t>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n)};
+            ASSERT_EQ(to_mpz(lo), product % (mpz_class(1) << (64 * n)));
+
+            const mpz_class exact{product >> (64 * (a.size() + b.size() - n))};
+            const auto hi{xenonis::algorithms::mulhi<container, iter, t>(a.cbegin(), a.cend(), b.cbegin(), b.cend(), n)};
+            const mpz_class error{exact - to_mpz(hi)};
+            ASSERT_GE(error, 0) << "a: " << to_mpz(a).get_str(16) << "\nb: " << to_mpz(b).get_str(16) << "\nn: " << n;
+            ASSERT_LE(error, 2 * n + 2) << "a: " << to_mpz(a).get_str(16) << "\nb: " << to_mpz(b).get_str(16)
+                                        << "\nn: " << n;
+        }
+    };
+
+    check(std::integral_constant<std::size_t, 2>{});
+    check(std::integral_constant<std::size_t, 4>{});
+    check(std::integral_constant<std::size_t, 8>{});
+}
+
+TEST(short_product_test, montgomery)
+{
+    // moduli above the Karatsuba threshold use the short product reduction
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+    const auto ran_num = [&](std::size_t limbs) {
+        mpz_class ret{0};
+        for (std::size_t i{0}; i < limbs; ++i)
+            ret = (ret << 64) + static_cast<unsigned long>(ran_dist(ran_engine));
+        return ret;
+    };
+
+    for (const std::size_t limbs : {xenonis::algorithms::karatsuba_threshold + 1,
+                                    xenonis::algorithms::karatsuba_threshold + 77}) {
+        const mpz_class m{ran_num(limbs) | 1};
+        const auto a{ran_num(limbs + 3)};
+        const mpz_class e{0x1f3};
+
+        mpz_class r;
+        mpz_powm(r.get_mpz_t(), a.get_mpz_t(), e.get_mpz_t(), m.get_mpz_t());
+        ASSERT_EQ(xenonis::bigint64(a.get_str(16))
+                      .powmod(xenonis::bigint64(e.get_str(16)), xenonis::bigint64(m.get_str(16)))
+                      .to_string(),
+                  r.get_str(16));
+    }
+}
+
+TEST(async_test, mul)
+{
+    xenonis::xoshiro256x4 engine(5);
+    const auto a{xenonis::random_bits<xenonis::bigint64>(64 * 2 * xenonis::algorithms::karatsuba_threshold, engine)};
+    const auto b{-xenonis::random_bits<xenonis::bigint64>(64 * 3 * xenonis::algorithms::karatsuba_threshold, engine)};
+    const auto product{a * b};
+
+    ASSERT_EQ(xenonis::async_mul(a, b).get(), product);
+    ASSERT_EQ(xenonis::async_mul(a, xenonis::bigint64(0)).get(), xenonis::bigint64(0));
+
+    auto token{std::make_shared<xenonis::cancellation_token>()};
+    auto result{xenonis::async_mul(a, b, token)};
+    ASSERT_EQ(result.get(), product);
+    token->cancel();
+    ASSERT_THROW(xenonis::async_mul(a, b, token).get(), xenonis::operation_cancelled);
+
+    // an executor which runs the tasks later
+    std::vector<std::function<void()>> tasks;
+    const auto executor = [&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); };
+    auto other_token{std::make_shared<xenonis::cancellation_token>()};
+    auto queued{xenonis::async_mul(a, b, nullptr, executor)};
+    auto cancelled{xenonis::async_mul(a, b, other_token, executor)};
+    other_token->cancel();
+    ASSERT_EQ(tasks.size(), 2u);
+    for (const auto& task : tasks)
+        task();
+    ASSERT_EQ(queued.get(), product);
+    ASSERT_THROW(cancelled.get(), xenonis::operation_cancelled);
+
+    // the poll of karatsuba_mul is called on every level of the recursion and may abort it
+    using container = xenonis::internal::bigint_data<std::uint64_t>;
+    using iter = const std::uint64_t*;
+    const auto& a_data{a.data()};
+    const auto& b_data{b.data()};
+    std::size_t polls{0};
+    const auto count = [&polls](std::size_t) { ++polls; };
+    ASSERT_EQ(xenonis::bigint64(xenonis::algorithms::karatsuba_mul<container, iter, 16>(
+                  a_data.cbegin(), a_data.cend(), b_data.cbegin(), b_data.cend(), count),
+                  true),
+              product);
+    ASSERT_GT(polls, 100u);
+
+    std::size_t remaining{polls / 2};
+    const auto abort = [&remaining](std::size_t) {
+        if (--remaining == 0)
+            throw xenonis::operation_cancelled();
+    };
+    ASSERT_THROW((xenonis::algorithms::karatsuba_mul<container, iter, 16>(a_data.cbegin(), a_data.cend(),
+                                                                          b_data.cbegin(), b_data.cend(), abort)),
+                 xenonis::operation_cancelled);
+}
+
+TEST(hash_test, limb_widths)
+{
+    std::random_device ran_device;
+    std::default_random_engine ran_engine(ran_device());
+    std::uniform_int_distribution<std::uint64_t> ran_dist(0, std::numeric_limits<std::uint64_t>::max());
+
+    std::unordered_set<std::size_t> hashes;
+    std::unordered_set<xenonis::bigint64> numbers;
+    const std::size_t count{10000};
+    for (std::size_t i{0}; i < count; ++i) {
+        // 1 to 100 hex digits, so the tails of all lane and word boundaries are covered
+        std::string str{i % 2 == 0 ? "-" : ""};
+        str += "123456789abcdef"[ran_dist(ran_engine) % 15];
+        const auto digits{ran_dist(ran_engine) % 100};
+        for (std::size_t j{0}; j < digits; ++j)
+            str += "0123456789abcdef"[ran_dist(ran_engine) % 16];
+
+        const xenonis::bigint64 n(str);
+        const auto h{std::hash<xenonis::bigint64>{}(n)};
+        ASSERT_EQ(h, std::hash<xenonis::bigint32>{}(xenonis::bigint32(str))) << str;
+        ASSERT_EQ(h, std::hash<xenonis::bigint16>{}(xenonis::bigint16(str))) << str;
+        ASSERT_EQ(h, std::hash<xenonis::bigint8>{}(xenonis::bigint8(str))) << str;
+        ASSERT_EQ(h, (n + 1 - 1).hash()) << str;
+        hashes.insert(h);
+        numbers.insert(n);
+    }
+    // distinct numbers, which collide with a probability of about count^2 / 2^65
+    ASSERT_EQ(hashes.size(), numbers.size());
+    for (const auto& n : numbers)
+        ASSERT_EQ(numbers.count(xenonis::bigint64(n.to_string())), 1u);
+
+    ASSERT_EQ(xenonis::bigint64().hash(), xenonis::bigint64(0).hash());
+    ASSERT_EQ(xenonis::bigint8(0).hash(), xenonis::bigint64(0).hash());
+    ASSERT_NE(xenonis::bigint64(1).hash(), xenonis::bigint64(-1).hash());
+    ASSERT_NE(xenonis::bigint64(0).hash(), xenonis::bigint64("10000000000000000").hash());
+    ASSERT_NE(xenonis::bigint64(1).hash(), xenonis::bigint64("10000000000000000").hash());
+}
+
+TEST(stats_test, counters)
+{
+    xenonis::stats::reset();
+    const auto a{xenonis::bigint64(1) << (64 * 4096)};
+    const auto b{(a - 1) * (a + 1)};
+    const auto c{xenonis::stats::snapshot()};
+    ASSERT_EQ(b, a * a - 1);
+
+    const auto json{xenonis::stats::to_json(c)};
+    ASSERT_EQ(json.front(), '{');
+    ASSERT_EQ(json.back(), '}');
+
+    if constexpr (xenonis::stats::enabled) {
+        ASSERT_GT(c.allocations, 0u);
+        ASSERT_GE(c.allocated_bytes, c.allocations * sizeof(std::uint64_t));
+        // 4097 limbs, the Karatsuba algorithm is used
+        ASSERT_EQ(c.kernel_calls[static_cast<std::size_t>(xenonis::stats::kernel::karatsuba_mul)][12], 1u);
+        ASSERT_GT(c.calls(xenonis::stats::kernel::naive_mul), 0u);
+        ASSERT_GT(c.calls(xenonis::stats::kernel::sub) + c.calls(xenonis::stats::kernel::sub_from), 0u);
+        ASSERT_NE(xenonis::stats::to_string(c).find("karatsuba_mul: "), std::string::npos);
+
+        xenonis::stats::reset();
+        auto d{b};
+        d *= d;
+        ASSERT_GT(xenonis::stats::snapshot().calls(xenonis::stats::kernel::karatsuba_sqr), 0u);
+        ASSERT_GT(xenonis::stats::snapshot().calls(xenonis::stats::kernel::naive_sqr), 0u);
+    } else {
+        ASSERT_EQ(c.allocations, 0u);
+        ASSERT_EQ(xenonis::stats::to_string(c), "allocations: 0\nallocated bytes: 0\n");
+    }
+
+    xenonis::stats::reset();
+    ASSERT_EQ(xenonis::stats::snapshot().allocations, 0u);
+}
 
 BIGINT_UTIL_UI_CONSTRUCTOR_TEST_CASE(construct_u64, std::uint64_t)
 BIGINT_UTIL_UI_CONSTRUCTOR_TEST_CASE(construct_u32, std::uint32_t)
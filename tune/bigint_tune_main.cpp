@@ -0,0 +1,171 @@
+//******************************************************************************
+//* Copyright 2018-2020 Fabian Haas                                            *
+//*                                                                            *
+//* This Source Code Form is subject to the terms of the Mozilla Public        *
+//* License, v. 2.0. If a copy of the MPL was not distributed with this        *
+//* file, You can obtain one at https://mozilla.org/MPL/2.0/.                  *
+//******************************************************************************
+
+/*!
+ *  \file bigint_tune_main.cpp
+ *  Measures the thresholds between the multiplication algorithms on the host and writes them as bigint_tuning.hpp,
+ *  which is included by bigint_config.hpp. Usage: bigint_tune [output file], the header is written to stdout if no
+ *  file is given. The measurements are printed to stderr.
+ */
+
+#include <algorithms/arithmetic.hpp>
+#include <bigint.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+    // the limbs of xenonis::bigint
+#ifdef XENONIS_USE_UINT128
+    using value_type = std::uint64_t;
+#else
+    using value_type = std::uint32_t;
+#endif
+    using container = xenonis::internal::bigint_data<value_type>;
+    using iterator = const value_type*;
+    using mul_function = container (*)(iterator, iterator, iterator, iterator);
+
+    // no threshold is searched beyond this number of limbs
+    constexpr std::size_t max_size{4096};
+
+    volatile value_type sink;
+
+    /*!
+     *  Returns the time of one call of mul in nanoseconds, the minimum of several runs of at least 5 ms each.
+     */
+    double measure(mul_function mul, const std::vector<value_type>& a, const std::vector<value_type>& b)
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr int runs{9};
+        constexpr std::chrono::microseconds min_run_time{5000};
+
+        const auto run = [&](std::size_t calls) {
+            const auto start{clock::now()};
+            for (std::size_t i{0}; i < calls; ++i)
+                sink = mul(a.data(), a.data() + a.size(), b.data(), b.data() + b.size()).front();
+            return clock::now() - start;
+        };
+
+        std::size_t calls{1};
+        while (run(calls) < min_run_time)
+            calls *= 2;
+
+        auto best{std::numeric_limits<double>::max()};
+        for (int i{0}; i < runs; ++i) {
+            const std::chrono::duration<double, std::nano> time{run(calls)};
+            best = std::min(best, time.count() / static_cast<double>(calls));
+        }
+
+        return best;
+    }
+
+    /*!
+     *  Returns the largest size for which slow(size) is faster than fast(size), the size at which fast wins for the
+     *  first time is confirmed by the following two measured sizes to ignore noise.
+     *  \param slow returns the function which is asymptotically slower, e.g. naive_mul.
+     *  \param fast returns the function which is asymptotically faster using slow for the smaller products.
+     */
+    std::size_t find_threshold(const char* name, std::size_t first_size,
+                               const std::function<mul_function(std::size_t)>& slow,
+                               const std::function<mul_function(std::size_t)>& fast)
+    {
+        constexpr int confirmations{3};
+        std::mt19937_64 engine(42);
+        std::uniform_int_distribution<value_type> dist(1, std::numeric_limits<value_type>::max());
+
+        std::cerr << name << ":\n";
+        std::size_t threshold{max_size};
+        std::size_t previous_size{first_size - 1};
+        int wins{0};
+        for (std::size_t size{first_size}; size <= max_size; size += std::max<std::size_t>(1, size / 16)) {
+            std::vector<value_type> a(size);
+            std::vector<value_type> b(size);
+            std::generate(a.begin(), a.end(), [&] { return dist(engine); });
+            std::generate(b.begin(), b.end(), [&] { return dist(engine); });
+
+            const auto slow_time{measure(slow(size), a, b)};
+            const auto fast_time{measure(fast(size), a, b)};
+            std::cerr << "  " << size << " limbs: " << slow_time << " ns vs " << fast_time << " ns\n";
+
+            if (fast_time < slow_time) {
+                if (wins == 0)
+                    threshold = previous_size;
+                if (++wins == confirmations)
+                    return threshold;
+            } else {
+                wins = 0;
+                threshold = max_size;
+            }
+            previous_size = size;
+        }
+
+        return threshold;
+    }
+
+    template <std::size_t... Thresholds> constexpr auto make_karatsuba_table()
+    {
+        return std::array<std::pair<std::size_t, mul_function>, sizeof...(Thresholds)>{
+            {{Thresholds, &xenonis::algorithms::karatsuba_mul<container, iterator, Thresholds>}...}};
+    }
+
+    // karatsuba_mul instantiated with thresholds growing by at most 1.5, so that every size can be split once
+    constexpr auto karatsuba_table{make_karatsuba_table<4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512,
+                                                        768, 1024, 1536, 2048, 3072, 4096>()};
+
+    /*!
+     *  Returns karatsuba_mul which splits operands of the given size exactly once and multiplies the halves (and
+     *  their sums) using naive_mul.
+     */
+    mul_function karatsuba_one_level(std::size_t size)
+    {
+        const auto half{(size + 1) / 2 + 1}; // the sums of the halves may have one limb more
+        const auto it{std::find_if(karatsuba_table.begin(), karatsuba_table.end(),
+                                   [&](const auto& entry) { return entry.first >= half; })};
+        return it->second;
+    }
+
+    mul_function naive(std::size_t) { return &xenonis::algorithms::naive_mul<container, iterator>; }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // the smallest size which can be split once with the thresholds of karatsuba_table
+    constexpr std::size_t karatsuba_first_size{10};
+    const auto karatsuba_threshold{find_threshold("naive_mul vs karatsuba_mul", karatsuba_first_size, naive,
+                                                  karatsuba_one_level)};
+
+    if (karatsuba_threshold == max_size)
+        std::cerr << "warning: karatsuba_mul is not faster than naive_mul up to " << max_size << " limbs\n";
+
+    std::ofstream file;
+    if (argc > 1) {
+        file.open(argv[1]);
+        if (!file) {
+            std::cerr << "error: cannot open " << argv[1] << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out{argc > 1 ? file : std::cout};
+
+    out << "// generated by bigint_tune, the thresholds are specific to the host and the configuration (limb size,\n"
+           "// inline assembly), run bigint_tune again instead of editing them\n"
+           "#pragma once\n\n"
+        << "#define XENONIS_KARATSUBA_THRESHOLD " << karatsuba_threshold << '\n';
+
+    return 0;
+}